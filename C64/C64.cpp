@@ -51,6 +51,7 @@ void
 	pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
 	pthread_setcanceltype(PTHREAD_CANCEL_DEFERRED, NULL);
 	pthread_cleanup_push(threadCleanup, thisC64);
+    c64->placement.apply();
 	
 	// Prepare to run...
 	c64->cpu.clearErrorState();
@@ -61,8 +62,15 @@ void
 		if (!c64->executeOneLine())
 			break;		
 
-		if (c64->getRasterline() == 0 && c64->getFrame() % 8 == 0)
-			pthread_testcancel(); // Check if thread was requested to terminate
+        // Stop if a watched text has shown up on the screen
+        if (c64->screenText.stopRequested())
+            break;
+
+		if (c64->getRasterline() == 0) {
+            c64->placement.applyIfPending();
+            if (c64->getFrame() % 8 == 0)
+                pthread_testcancel(); // Check if thread was requested to terminate
+        }
 	}
 	
 	pthread_cleanup_pop(1);
@@ -96,6 +104,7 @@ C64::C64()
         &iec,
         &expansionport,
         &floppy,
+        &virtualDrive,
         &datasette,
         &mouse1350,
         &mouse1351,
@@ -103,6 +112,8 @@ C64::C64()
         &keyboard,
         &port1,
         &port2,
+        &reverseDebugger,
+        &screenText,
         NULL };
     
     registerSubComponents(subcomponents, sizeof(subcomponents));
@@ -123,12 +134,21 @@ C64::C64()
         { &rasterline,      sizeof(rasterline),         CLEAR_ON_RESET },
         { &rasterlineCycle, sizeof(rasterlineCycle),    CLEAR_ON_RESET },
         { &ultimax,         sizeof(ultimax),            CLEAR_ON_RESET },
+        { &turboInstruction, sizeof(turboInstruction),  CLEAR_ON_RESET },
+        { &turboDelay,      sizeof(turboDelay),         CLEAR_ON_RESET },
         { NULL,             0,                          0 }};
     
     registerSnapshotItems(items, sizeof(items));
 
     // Setup references
     cpu.mem = &mem;
+    
+    // Idle loop detection is off by default. A parked CPU only skips its own micro
+    // operations while all other components are still emulated cycle by cycle. It can be
+    // switched on per CPU (the drive CPU leaves its loop when the SO pin modifies the V
+    // flag, see VC1541::byteReady()).
+    cpu.setIdleLoopDetection(false);
+    floppy.cpu.setIdleLoopDetection(false);
     floppy.cpu.mem = &c64->floppy.mem;
     floppy.mem.iec = &c64->iec;
     floppy.mem.floppy = &c64->floppy;
@@ -151,6 +171,16 @@ C64::C64()
     }
     autoSaveSnapshots = true;
     autoSaveInterval = 3;
+    instantBoot = false;
+    
+    // Raster time accounting is switched on by the user
+    rasterTiming = false;
+    memset(&currentTiming, 0, sizeof(currentTiming));
+    memset(&frameTiming, 0, sizeof(frameTiming));
+    memset(timingCheckpoint, 0, sizeof(timingCheckpoint));
+    
+    // Turbo mode is switched on by the user
+    turboMultiplier = 1;
 
     reset();
 }
@@ -170,6 +200,7 @@ C64::reset()
 
     // Reset all sub components
     VirtualComponent::reset();
+    selectExecutionLoop();
     
     // Make CPU ready to go
     cpu.initPC();
@@ -183,6 +214,7 @@ C64::reset()
     
 	rasterlineCycle = 1;
     nanoTargetTime = 0UL;
+    turboCycles = turboCyclesAtFrameStart = turboCyclesInFrame = 0;
     ping();
 	// resume();
 }
@@ -315,7 +347,7 @@ void
 C64::powerUp()
 {
     suspend();
-    reset();
+    if (!instantBoot || !bootToReady()) reset();
     resume();
     run();
 }
@@ -349,7 +381,8 @@ C64::threadCleanup()
 bool
 C64::isRunnable()
 {
-    return mem.basicRomIsLoaded() && mem.charRomIsLoaded() && mem.kernalRomIsLoaded() && floppy.mem.romIsLoaded();
+    return mem.basicRomIsLoaded() && mem.charRomIsLoaded() && mem.kernalRomIsLoaded() &&
+    (floppy.mem.romIsLoaded() || virtualDrive.isActive());
 }
 
 bool
@@ -385,6 +418,10 @@ C64::step()
     cpu.clearErrorState();
     floppy.cpu.clearErrorState();
     
+    // Don't let the CPU park in an idle loop while single-stepping
+    bool idleLoopDetection = cpu.getIdleLoopDetection();
+    cpu.setIdleLoopDetection(false);
+    
     // Execute next command
     do {
         executeOneCycle();
@@ -393,6 +430,8 @@ C64::step()
     // We are now at cycle 0 of the next command
     // Execute one more cycle (and stop in cycle 1)
     executeOneCycle();
+    
+    cpu.setIdleLoopDetection(idleLoopDetection);
 }
 
 // From Wolfgang Lorenz: Clock.txt
@@ -408,14 +447,16 @@ C64::step()
 #define EXECUTE \
 if (cycle >= wakeUpCycleCIA1) cia1.executeOneCycle(); else idleCounterCIA1++; \
 if (cycle >= wakeUpCycleCIA2) cia2.executeOneCycle(); else idleCounterCIA2++; \
-if (!cpu.executeOneCycle()) result = false; \
-if (!floppy.executeOneCycle()) result = false; \
-datasette.execute(); \
+if (dma && expansionport.dmaIsActive()) expansionport.executeDMA(); \
+else if (!(turboMultiplier > 1 ? executeTurboCycles() : cpu.executeOneCycle())) result = false; \
+if (drive && !floppy.executeOneCycle()) result = false; \
+if (vdrive && cycle >= virtualDrive.wakeUpCycle) virtualDrive.execute(); \
+if (tape) datasette.execute(); \
 cycle++; \
 rasterlineCycle++;
 
-bool
-C64::executeOneCycle()
+template <bool drive, bool vdrive, bool tape, bool dma> bool
+C64::_executeOneCycle()
 {
     bool result = true; // Don't break execution
     
@@ -561,17 +602,77 @@ C64::executeOneCycle()
     return result;
 }
 
-bool
-C64::executeOneLine()
+template <bool drive, bool vdrive, bool tape, bool dma> bool
+C64::_executeOneLine()
 {
     uint8_t lastCycle = vic.getCyclesPerRasterline();
     for (unsigned i = rasterlineCycle; i <= lastCycle; i++) {
-        if (!executeOneCycle())
+        if (!_executeOneCycle<drive, vdrive, tape, dma>())
             return false;
     }
     return true;
 }
 
+void
+C64::selectExecutionLoop()
+{
+    // The real drive is switched off while the virtual drive is on the bus
+    bool vdrive = virtualDrive.isActive();
+    bool drive = !vdrive && iec.driveIsConnected();
+    bool tape = datasette.hasTape();
+    bool dma = expansionport.hasDMA();
+    
+    if (drive) {
+        selectExecutionLoop<true, false>(tape, dma);
+    } else if (vdrive) {
+        selectExecutionLoop<false, true>(tape, dma);
+    } else {
+        selectExecutionLoop<false, false>(tape, dma);
+    }
+}
+
+template <bool drive, bool vdrive> void
+C64::selectExecutionLoop(bool tape, bool dma)
+{
+    if (tape) {
+        cycleFunc = dma ? &C64::_executeOneCycle<drive, vdrive, true, true> : &C64::_executeOneCycle<drive, vdrive, true, false>;
+        lineFunc = dma ? &C64::_executeOneLine<drive, vdrive, true, true> : &C64::_executeOneLine<drive, vdrive, true, false>;
+    } else {
+        cycleFunc = dma ? &C64::_executeOneCycle<drive, vdrive, false, true> : &C64::_executeOneCycle<drive, vdrive, false, false>;
+        lineFunc = dma ? &C64::_executeOneLine<drive, vdrive, false, true> : &C64::_executeOneLine<drive, vdrive, false, false>;
+    }
+}
+
+bool
+C64::executeTurboCycles()
+{
+    // Decide whether the next instruction runs at turbo speed when its opcode is fetched
+    if (cpu.atBeginningOfNewCommand()) turboInstruction = cpu.canAccelerate();
+    if (!cpu.executeOneCycle()) return false;
+    
+    // After using the bus, wait until the interrupt lines have settled
+    if (!turboInstruction) {
+        turboDelay = TURBO_SETTLE_CYCLES;
+        return true;
+    }
+    if (turboDelay) {
+        turboDelay--;
+        return true;
+    }
+    
+    // Execute additional cycles until the CPU needs the bus
+    for (unsigned i = 1; i < turboMultiplier && turboInstruction; i++) {
+        
+        // VIC and the expansion port are served at normal speed
+        if (!cpu.getRDY() || expansionport.dmaIsActive()) break;
+        
+        if (cpu.atBeginningOfNewCommand() && !(turboInstruction = cpu.canAccelerate())) break;
+        if (!cpu.executeOneCycle()) return false;
+        turboCycles++;
+    }
+    return true;
+}
+
 void
 C64::beginOfRasterline()
 {
@@ -586,6 +687,7 @@ void
 C64::endOfRasterline()
 {
     vic.endRasterline();
+    if (rasterTiming) recordRasterlineTiming();
     rasterlineCycle = 1;
     rasterline++;
     
@@ -593,11 +695,19 @@ C64::endOfRasterline()
         rasterline = 0;
         endOfFrame();
     }
+    
+    // Record the history for the reverse debugger
+    if (cycle >= reverseDebugger.nextCheckpoint) {
+        reverseDebugger.takeCheckpoint();
+    }
 }
 
 void
 C64::endOfFrame()
 {
+    if (rasterTiming) recordFrameTiming();
+    turboCyclesInFrame = turboCycles - turboCyclesAtFrameStart;
+    turboCyclesAtFrameStart = turboCycles;
     frame++;
     vic.endFrame();
     
@@ -615,6 +725,15 @@ C64::endOfFrame()
     // Update mouse coordinates
     if (mousePort != 0) mouse->execute();
     
+    // Check if the emulating thread stays where it has been placed
+    if (placement.isSampling()) placement.sample();
+    
+    // Provide a consistent copy of the RAM to RAM searches
+    if (mem.isCapturing()) mem.captureRam(frame);
+    
+    // Check if a watched text has shown up on the screen
+    if (screenText.isWatching()) screenText.checkWatch();
+    
     // Take a snapshot once in a while
     if (autoSaveSnapshots && frame % (vic.getFramesPerSecond() * autoSaveInterval) == 0) {
         takeAutoSnapshot();
@@ -626,6 +745,428 @@ C64::endOfFrame()
     }
 }
 
+//
+//! @functiongroup Accounting raster time
+//
+
+void
+C64::setRasterTiming(bool enable)
+{
+    if (enable == rasterTiming)
+        return;
+    
+    suspend();
+    
+    if (enable) {
+        uint64_t elapsed[4];
+        memset(&currentTiming, 0, sizeof(currentTiming));
+        memset(&frameTiming, 0, sizeof(frameTiming));
+        takeTimingCheckpoint(elapsed);
+    }
+    rasterTiming = enable;
+    
+    resume();
+}
+
+void
+C64::takeTimingCheckpoint(uint64_t elapsed[4])
+{
+    uint64_t counter[4] = {
+        vic.getBadLineCycles(),
+        vic.getSpriteDmaCycles(),
+        cpu.getInterruptCycles(),
+        cpu.getIdleLoopCycles()
+    };
+    
+    for (unsigned i = 0; i < 4; i++) {
+        // Counters may run backwards when a snapshot is restored inside a handler
+        elapsed[i] = counter[i] > timingCheckpoint[i] ? counter[i] - timingCheckpoint[i] : 0;
+        timingCheckpoint[i] = counter[i];
+    }
+}
+
+void
+C64::recordRasterlineTiming()
+{
+    uint64_t elapsed[4];
+    takeTimingCheckpoint(elapsed);
+    
+    for (unsigned i = 0; i < 4; i++) {
+        if (elapsed[i] > 0xFF) elapsed[i] = 0xFF;
+    }
+    
+    if (rasterline < PAL_HEIGHT) {
+        RasterlineTiming &line = currentTiming.line[rasterline];
+        line.badLineCycles = (uint8_t)elapsed[0];
+        line.spriteDmaCycles = (uint8_t)elapsed[1];
+        line.interruptCycles = (uint8_t)elapsed[2];
+        line.idleLoopCycles = (uint8_t)elapsed[3];
+        currentTiming.rasterlines = rasterline + 1;
+    }
+    
+    currentTiming.cycles += vic.getCyclesPerRasterline();
+    currentTiming.badLineCycles += (uint32_t)elapsed[0];
+    currentTiming.spriteDmaCycles += (uint32_t)elapsed[1];
+    currentTiming.interruptCycles += (uint32_t)elapsed[2];
+    currentTiming.idleLoopCycles += (uint32_t)elapsed[3];
+}
+
+void
+C64::recordFrameTiming()
+{
+    currentTiming.frame = frame;
+    frameTiming = currentTiming;
+    memset(&currentTiming, 0, sizeof(currentTiming));
+}
+
+unsigned
+C64::getCpuLoad()
+{
+    const FrameTiming &t = frameTiming;
+    uint32_t unused = t.badLineCycles + t.spriteDmaCycles + t.idleLoopCycles;
+    
+    if (t.cycles == 0 || unused >= t.cycles)
+        return 0;
+    
+    return (unsigned)(100 * (uint64_t)(t.cycles - unused) / t.cycles);
+}
+
+void
+C64::dumpFrameTiming(bool verbose)
+{
+    const FrameTiming &t = frameTiming;
+    
+    msg("Frame %llu: %u%% CPU busy (%u cycles, %u bad line, %u sprite DMA, %u IRQ/NMI, %u idle)\n",
+        t.frame, getCpuLoad(), t.cycles,
+        t.badLineCycles, t.spriteDmaCycles, t.interruptCycles, t.idleLoopCycles);
+    
+    if (!verbose)
+        return;
+    
+    msg("Line  Bad  Spr  Irq  Idle\n");
+    for (unsigned i = 0; i < t.rasterlines; i++) {
+        const RasterlineTiming &l = t.line[i];
+        if (l.badLineCycles || l.spriteDmaCycles || l.interruptCycles || l.idleLoopCycles) {
+            msg("%4u %4u %4u %4u %5u\n", i,
+                l.badLineCycles, l.spriteDmaCycles, l.interruptCycles, l.idleLoopCycles);
+        }
+    }
+}
+
+
+//
+//! @functiongroup Accelerating the CPU
+//
+
+void
+C64::setTurboMultiplier(unsigned value)
+{
+    if (value < 1 || value > MAX_TURBO_MULTIPLIER) {
+        warn("Turbo multiplier %d is not supported\n", value);
+        return;
+    }
+    
+    suspend();
+    turboMultiplier = value;
+    turboInstruction = false;
+    turboDelay = 0;
+    turboCyclesInFrame = 0;
+    turboCyclesAtFrameStart = turboCycles;
+    resume();
+}
+
+double
+C64::getEffectiveMHz()
+{
+    double frequency = isPAL() ? CLOCK_FREQUENCY_PAL : CLOCK_FREQUENCY_NTSC;
+    double cycles = vic.getCyclesPerFrame();
+    
+    return frequency * (cycles + turboCyclesInFrame) / cycles / 1000000.0;
+}
+
+
+//
+//! @functiongroup Booting instantly
+//
+
+//! @brief    A cached post-boot state
+typedef struct {
+    uint64_t key;
+    uint8_t *state;
+    size_t size;
+    uint64_t lastUse;
+} BootCacheEntry;
+
+//! @brief    Number of cached post-boot states
+static const unsigned bootCacheCapacity = 4;
+
+//! @brief    Post-boot states shared by all instances
+static BootCacheEntry bootCache[bootCacheCapacity];
+static uint64_t bootCacheClock = 0;
+static pthread_mutex_t bootCacheLock = PTHREAD_MUTEX_INITIALIZER;
+
+uint64_t
+C64::bootCacheKey()
+{
+    uint8_t colors[sizeof(mem.colorRam)];
+    memcpy(colors, mem.colorRam, sizeof(colors));
+    memset(mem.colorRam, 0, sizeof(mem.colorRam));
+    
+    size_t size = stateSize();
+    uint8_t *buffer = (uint8_t *)malloc(size);
+    uint8_t *ptr = buffer;
+    saveToBuffer(&ptr);
+    memcpy(mem.colorRam, colors, sizeof(colors));
+    
+    // FNV-1a
+    uint64_t key = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; i++)
+        key = (key ^ buffer[i]) * 0x100000001b3ULL;
+    free(buffer);
+    
+    // The virtual drive is not part of snapshots, but keeps the VC1541 from running
+    if (virtualDrive.isActive())
+        key = (key ^ 0xFF) * 0x100000001b3ULL;
+    
+    return key;
+}
+
+uint16_t
+C64::readyLoopAddress()
+{
+    // LDA $C6, STA $CC, STA $0292, BEQ *-9
+    const uint8_t loop[] = { 0xA5, 0xC6, 0x85, 0xCC, 0x8D, 0x92, 0x02, 0xF0, 0xF7 };
+    
+    for (unsigned addr = 0xE000; addr <= 0x10000 - sizeof(loop); addr++) {
+        if (memcmp(&mem.rom[addr], loop, sizeof(loop)) == 0)
+            return (uint16_t)addr;
+    }
+    return 0;
+}
+
+bool
+C64::bootToReady()
+{
+    uint16_t loop = readyLoopAddress();
+    
+    reset();
+    if (loop == 0) {
+        warn("Kernal ROM lacks the keyboard input loop. Can't boot instantly.\n");
+        return false;
+    }
+    
+    bool cacheable = !expansionport.getCartridgeAttached();
+    uint64_t key = cacheable ? bootCacheKey() : 0;
+    
+    // Restore a cached state if possible
+    if (cacheable) {
+        
+        pthread_mutex_lock(&bootCacheLock);
+        for (unsigned i = 0; i < bootCacheCapacity; i++) {
+            if (bootCache[i].state != NULL && bootCache[i].key == key) {
+                
+                uint8_t *ptr = bootCache[i].state;
+                loadFromBuffer(&ptr);
+                bootCache[i].lastUse = ++bootCacheClock;
+                pthread_mutex_unlock(&bootCacheLock);
+                
+                debug(2, "Restored cached post-boot state %llx\n", key);
+                keyboard.releaseAll();
+                ping();
+                return true;
+            }
+        }
+        pthread_mutex_unlock(&bootCacheLock);
+    }
+    
+    // Emulate the boot sequence at maximum speed
+    bool warpAfterReset = warp;
+    uint64_t limit = frame + 10 * vic.getFramesPerSecond();
+    
+    warp = true;
+    while (cpu.getPC() < loop || cpu.getPC() > loop + 8) {
+        
+        if (!executeOneLine() || frame >= limit) {
+            warn("Ready prompt hasn't been reached.\n");
+            warp = warpAfterReset;
+            return false;
+        }
+    }
+    warp = warpAfterReset;
+    debug(2, "Ready prompt reached in frame %lld\n", frame);
+    
+    if (!cacheable)
+        return true;
+    
+    // Store the state in the least recently used slot
+    pthread_mutex_lock(&bootCacheLock);
+    unsigned victim = 0;
+    for (unsigned i = 1; i < bootCacheCapacity; i++) {
+        if (bootCache[i].lastUse < bootCache[victim].lastUse)
+            victim = i;
+    }
+    BootCacheEntry *entry = &bootCache[victim];
+    entry->key = key;
+    entry->size = stateSize();
+    entry->state = (uint8_t *)realloc(entry->state, entry->size);
+    entry->lastUse = ++bootCacheClock;
+    uint8_t *ptr = entry->state;
+    saveToBuffer(&ptr);
+    pthread_mutex_unlock(&bootCacheLock);
+    
+    return true;
+}
+
+void
+C64::flushBootCache()
+{
+    pthread_mutex_lock(&bootCacheLock);
+    for (unsigned i = 0; i < bootCacheCapacity; i++) {
+        free(bootCache[i].state);
+        memset(&bootCache[i], 0, sizeof(BootCacheEntry));
+    }
+    pthread_mutex_unlock(&bootCacheLock);
+}
+
+bool
+C64::runUntilText(const char *text, unsigned maxFrames)
+{
+    // Check if the text is already visible
+    screenText.update();
+    if (screenText.find(text))
+        return true;
+    
+    screenText.watch(text);
+    if (!screenText.isWatching())
+        return false;
+    
+    bool warpBefore = warp;
+    uint64_t limit = frame + maxFrames;
+    
+    warp = true;
+    while (!screenText.textFound() && frame < limit) {
+        if (!executeOneLine())
+            break;
+    }
+    warp = warpBefore;
+    
+    bool result = screenText.textFound();
+    screenText.watch(NULL);
+    return result;
+}
+
+
+//
+//! @functiongroup Travelling back in time
+//
+
+bool
+C64::stepBack()
+{
+    return travelBack(false);
+}
+
+bool
+C64::continueBack()
+{
+    return travelBack(true);
+}
+
+bool
+C64::travelBack(bool breakpoints)
+{
+    if (reverseDebugger.numCheckpoints() == 0 || cycle == 0)
+        return false;
+    
+    // Keep the present in case the recorded history doesn't reach back far enough
+    uint8_t *present = (uint8_t *)malloc(stateSize());
+    uint8_t *ptr = present;
+    saveToBuffer(&ptr);
+    
+    // Re-execute without parking in idle loops, halting at breakpoints, or sleeping
+    uint8_t *tags = (uint8_t *)malloc(65536);
+    bool idleLoopDetection = cpu.getIdleLoopDetection();
+    bool warpBefore = warp;
+    bool autoSaveBefore = autoSaveSnapshots;
+    cpu.setIdleLoopDetection(false);
+    cpu.suspendBreakpoints(tags);
+    autoSaveSnapshots = false;
+    
+    // The current instruction has been fetched in the previous cycle (see step())
+    uint64_t executed = 0;
+    uint64_t fetch = lastFetchBefore(cycle - 1, breakpoints, tags, &executed);
+    
+    if (fetch != UINT64_MAX) {
+        replayUntilFetch(fetch, &executed);
+        cpu.clearErrorState();
+        floppy.cpu.clearErrorState();
+    } else {
+        ptr = present;
+        loadFromBuffer(&ptr);
+    }
+    
+    cpu.resumeBreakpoints(tags);
+    cpu.setIdleLoopDetection(idleLoopDetection);
+    autoSaveSnapshots = autoSaveBefore;
+    warp = warpBefore;
+    reverseDebugger.endReplay(executed);
+    
+    free(tags);
+    free(present);
+    return fetch != UINT64_MAX;
+}
+
+uint64_t
+C64::lastFetchBefore(uint64_t limit, bool breakpoints, const uint8_t *tags, uint64_t *executed)
+{
+    for (int nr = reverseDebugger.checkpointBefore(limit); nr >= 0; nr--) {
+        
+        reverseDebugger.restore(nr);
+        warp = true;
+        
+        uint64_t found = UINT64_MAX;
+        while (cycle < limit) {
+            
+            // A fetch is complete if the CPU has left the fetch state (it stays there if
+            // RDY is low). Interrupts are entered in the fetch cycle, too.
+            bool fetching = cpu.atBeginningOfNewCommand();
+            uint16_t pc = cpu.getPC();
+            executeOneCycle();
+            (*executed)++;
+            
+            if (fetching && !cpu.atBeginningOfNewCommand()) {
+                if (!breakpoints ||
+                    ((tags[pc] & HARD_BREAKPOINT) && cpu.getPC_at_cycle_0() == pc)) {
+                    found = cycle - 1;
+                }
+            }
+        }
+        if (found != UINT64_MAX)
+            return found;
+        
+        // Continue with the interval before this checkpoint
+        limit = reverseDebugger.checkpointCycle(nr);
+    }
+    return UINT64_MAX;
+}
+
+void
+C64::replayUntilFetch(uint64_t fetch, uint64_t *executed)
+{
+    int nr = reverseDebugger.checkpointBefore(fetch + 1);
+    assert(nr >= 0);
+    
+    reverseDebugger.restore(nr);
+    warp = true;
+    
+    // Stop in the cycle after the fetch, just like step() does
+    while (cycle <= fetch) {
+        executeOneCycle();
+        (*executed)++;
+    }
+}
+
+
 //
 //! @functiongroup Managing the execution thread
 //
@@ -775,6 +1316,13 @@ C64::loadRom(const char *filename)
 //! @functiongroup Loading and saving snapshots
 //
 
+void
+C64::loadFromBuffer(uint8_t **buffer)
+{
+    VirtualComponent::loadFromBuffer(buffer);
+    selectExecutionLoop();
+}
+
 void C64::loadFromSnapshotUnsafe(Snapshot *snapshot)
 {    
     uint8_t *ptr;
@@ -902,6 +1450,57 @@ C64::takeAutoSnapshot()
     // Save state
     saveToSnapshotUnsafe(autoSavedSnapshots[0]);
     putMessage(MSG_SNAPSHOT_TAKEN);
+    
+    // Keep a copy on disk
+    if (rewindHistory.isOpen()) {
+        rewindHistory.append(autoSavedSnapshots[0]->getData(),
+                             autoSavedSnapshots[0]->getDataSize(), frame, cycle);
+    }
+}
+
+bool
+C64::openRewindHistory(const char *path)
+{
+    bool result;
+    
+    suspend();
+    result = rewindHistory.open(path, frame);
+    resume();
+    
+    return result;
+}
+
+void
+C64::closeRewindHistory()
+{
+    suspend();
+    rewindHistory.close();
+    resume();
+}
+
+bool
+C64::restoreFromRewindHistory(uint64_t position)
+{
+    int nr;
+    
+    suspend();
+    
+    if ((nr = rewindHistory.entryAt(position)) < 0) {
+        resume();
+        return false;
+    }
+    
+    uint8_t *buffer = (uint8_t *)malloc(rewindHistory.getSize(nr));
+    uint8_t *ptr = buffer;
+    rewindHistory.getData(nr, buffer);
+    loadFromBuffer(&ptr);
+    free(buffer);
+    rewindHistory.didRestore(nr, frame);
+    keyboard.releaseAll(); // Avoid constantly pressed keys
+    ping();
+    
+    resume();
+    return true;
 }
 
 void
@@ -1043,6 +1642,15 @@ C64::attachCartridgeAndReset(CRTContainer *container)
     return true;
 }
 
+bool
+C64::attachReu(unsigned kb)
+{
+    suspend();
+    bool result = expansionport.attachReu(kb);
+    resume();
+    return result;
+}
+
 void
 C64::detachCartridgeAndReset()
 {
@@ -40,7 +40,7 @@
 // Snapshot version number of this release
 #define V_MAJOR 1
 #define V_MINOR 11
-#define V_SUBMINOR 0
+#define V_SUBMINOR 1
 
 // Disables assert checking in relase version
 // #define NDEBUG
@@ -82,10 +82,16 @@
 
 // Cartridges
 #include "CustomCartridges.h"
+#include "REU.h"
 
 // Peripherals
 #include "VC1541.h"
+#include "VirtualDrive.h"
 #include "Datasette.h"
+#include "ReverseDebugger.h"
+#include "ScreenText.h"
+#include "ThreadPlacement.h"
+#include "RewindHistory.h"
 #include "Mouse1350.h"
 #include "Mouse1351.h"
 #include "NeosMouse.h"
@@ -205,7 +211,7 @@ public:
     C64Memory mem;
     
     //! @brief    The C64s virtual CPU
-    CPU cpu;
+    C64CPU cpu;
     
     //! @brief    The C64s processor port
     ProcessorPort processorPort;
@@ -252,6 +258,9 @@ public:
     //! @brief    Commodore VC1541 floppy drive
     VC1541 floppy;
 
+    //! @brief    High-level replacement for the VC1541 on the IEC bus
+    VirtualDrive virtualDrive;
+
     //! @brief    Commodore 1530 (C2N) Datasette
     Datasette datasette;
 
@@ -263,6 +272,15 @@ public:
 
     //! @brief    Neos Mouse
     NeosMouse neosMouse;
+
+    //! @brief    Checkpoint recorder for stepping backwards in the debugger
+    ReverseDebugger reverseDebugger;
+
+    //! @brief    Decoder for the text screen
+    ScreenText screenText;
+    
+    //! @brief    Placement policy and scheduling statistics of the execution thread
+    ThreadPlacement placement;
     
     //
     // Mouse
@@ -323,6 +341,91 @@ private:
     //! Indicates that we should run as fast as possible at least during disk operations
     bool warpLoad;
     
+    //! Indicates if powerUp() starts from a cached post-boot state
+    bool instantBoot;
+    
+    
+    //
+    // Execution loops
+    //
+    
+    /*! @brief    Execution functions matching the connected peripherals
+     *  @details  Each combination of peripherals that needs to be emulated in every cycle has its
+     *            own instance of the cycle and rasterline functions. Peripherals that are not
+     *            connected are left out at compile time. The functions are selected by
+     *            selectExecutionLoop().
+     */
+    bool (C64::*cycleFunc)();
+    bool (C64::*lineFunc)();
+    
+    
+    //
+    // Turbo mode
+    //
+    
+    /*! @brief    Number of CPU cycles executed per system cycle (1 = turbo mode off)
+     *  @details  The additional cycles are only spent on instructions that don't access the
+     *            system bus, i.e., instructions that access RAM and ROM only. All other
+     *            instructions, interrupts, and VIC DMA are executed at normal speed.
+     */
+    unsigned turboMultiplier;
+    
+    //! @brief    Indicates that the currently executed instruction runs at turbo speed
+    bool turboInstruction;
+    
+    /*! @brief    Number of system cycles to wait before the CPU speeds up again
+     *  @details  Interrupt lines are sampled with a delay. E.g., a CIA releases its interrupt
+     *            line in the cycle after the interrupt register has been read. Hence, the CPU
+     *            stays at normal speed for a few cycles after it has used the bus. Otherwise, an
+     *            accelerated interrupt handler would return before the interrupt is cleared.
+     */
+    uint8_t turboDelay;
+    
+    //! @brief    Initial value of turboDelay
+    static const uint8_t TURBO_SETTLE_CYCLES = 2;
+    
+    //! @brief    Total number of CPU cycles executed in addition to the system cycles
+    uint64_t turboCycles;
+    
+    //! @brief    Value of turboCycles at the beginning of the current frame
+    uint64_t turboCyclesAtFrameStart;
+    
+    //! @brief    Additional CPU cycles executed in the most recently completed frame
+    uint64_t turboCyclesInFrame;
+    
+    /*! @brief    Executes the CPU for one system cycle in turbo mode
+     *  @return   false, if the CPU was halted, e.g., by reaching a breakpoint
+     */
+    bool executeTurboCycles();
+    
+    
+    //
+    // Raster time accounting
+    //
+    
+    //! @brief    Indicates if raster time is accounted per rasterline
+    bool rasterTiming;
+    
+    //! @brief    Accounting of the frame that is currently drawn
+    FrameTiming currentTiming;
+    
+    //! @brief    Accounting of the most recently completed frame
+    FrameTiming frameTiming;
+    
+    /*! @brief    Values of the accumulating counters at the end of the previous rasterline
+     *  @details  Bad line cycles, sprite DMA cycles, interrupt cycles, idle loop cycles
+     */
+    uint64_t timingCheckpoint[4];
+    
+    //! @brief    Updates the checkpoint and returns the cycles elapsed since the last update
+    void takeTimingCheckpoint(uint64_t elapsed[4]);
+    
+    //! @brief    Records the counters of the rasterline that has just been completed
+    void recordRasterlineTiming();
+    
+    //! @brief    Completes the accounting of the current frame
+    void recordFrameTiming();
+    
     
     //
     // Message queue
@@ -372,6 +475,11 @@ private:
     //! @brief    Storage for user-taken snapshots
     Snapshot *userSavedSnapshots[MAX_USER_SAVED_SNAPSHOTS];
     
+public:
+    
+    //! @brief    On-disk history of auto-taken snapshots (optional)
+    RewindHistory rewindHistory;
+    
     
 public:
     
@@ -384,6 +492,11 @@ public:
     //! @brief    Resets the virtual C64 and all of its sub components.
     void reset();
      
+    /*! @brief    Method from VirtualComponent
+     *  @details  Selects the execution loop matching the peripherals of the loaded state.
+     */
+    void loadFromBuffer(uint8_t **buffer);
+    
     //! @brief    Dumps current configuration into message queue
     void ping();
 
@@ -508,12 +621,33 @@ public:
     void step(); 
     
     //! @brief    Executes until the end of the rasterline
-    bool executeOneLine();
+    bool executeOneLine() { return (this->*lineFunc)(); }
+    
+    /*! @brief    Selects the execution loop matching the connected peripherals
+     *  @details  Needs to be called whenever the floppy drive, the virtual drive, a tape, or a
+     *            cartridge with DMA capabilities is attached or detached. The caller has to
+     *            suspend the emulator thread which reads the function pointers in every cycle.
+     */
+    void selectExecutionLoop();
     
 private:
     
+    //! @brief    Selects the execution loop for the specified drive configuration
+    template <bool drive, bool vdrive> void selectExecutionLoop(bool tape, bool dma);
+    
     //! @brief    Executes virtual C64 for one cycle
-    bool executeOneCycle();
+    bool executeOneCycle() { return (this->*cycleFunc)(); }
+    
+    /*! @brief    Executes virtual C64 for one cycle with the specified peripherals
+     *  @param    drive     Emulate the VC1541 floppy drive
+     *  @param    vdrive    Emulate the virtual drive
+     *  @param    tape      Emulate the datasette
+     *  @param    dma       Let the expansion port take over the bus
+     */
+    template <bool drive, bool vdrive, bool tape, bool dma> bool _executeOneCycle();
+    
+    //! @brief    Executes until the end of the rasterline with the specified peripherals
+    template <bool drive, bool vdrive, bool tape, bool dma> bool _executeOneLine();
     
     //! @brief    Invoked before executing the first cycle of rasterline
     void beginOfRasterline();
@@ -582,6 +716,149 @@ public:
     uint8_t getRasterlineCycle() { return rasterlineCycle; }
 
     
+    //
+    //! @functiongroup Accounting raster time
+    //
+    
+    //! @brief    Returns true if raster time is accounted
+    bool getRasterTiming() { return rasterTiming; }
+    
+    /*! @brief    Enables or disables raster time accounting
+     *  @details  If disabled, the emulator does not spend any time on accounting.
+     */
+    void setRasterTiming(bool enable);
+    
+    /*! @brief    Returns the accounting of the most recently completed frame
+     *  @details  All values are 0 if no frame has been completed since accounting has been
+     *            enabled.
+     */
+    FrameTiming getFrameTiming() { return frameTiming; }
+    
+    /*! @brief    Returns the percentage of cycles in which the CPU was executing code
+     *  @details  Refers to the most recently completed frame. Stolen cycles and cycles spent
+     *            in parked idle loops are not counted as busy.
+     */
+    unsigned getCpuLoad();
+    
+    //! @brief    Prints the accounting of the most recently completed frame
+    void dumpFrameTiming(bool verbose = false);
+
+    
+    //
+    //! @functiongroup Accelerating the CPU
+    //
+    
+    //! @brief    Maximum number of CPU cycles per system cycle
+    static const unsigned MAX_TURBO_MULTIPLIER = 20;
+    
+    //! @brief    Returns the number of CPU cycles per system cycle (1 = turbo mode off)
+    unsigned getTurboMultiplier() { return turboMultiplier; }
+    
+    /*! @brief    Sets the number of CPU cycles per system cycle
+     *  @details  Values greater than 1 accelerate all code that runs in RAM and ROM without
+     *            touching the I/O space. VIC, CIA, SID, and the drive keep their speed. Hence,
+     *            video and audio are not affected. Timing sensitive code will break.
+     */
+    void setTurboMultiplier(unsigned value);
+    
+    //! @brief    Returns the total number of CPU cycles executed at turbo speed
+    uint64_t getTurboCycles() { return turboCycles; }
+    
+    /*! @brief    Returns the effective clock frequency of the CPU in MHz
+     *  @details  Refers to the most recently completed frame.
+     */
+    double getEffectiveMHz();
+
+    
+    //
+    //! @functiongroup Booting instantly
+    //
+    
+    //! @brief    Returns true if powerUp() starts from a cached post-boot state
+    bool getInstantBoot() { return instantBoot; }
+    
+    //! @brief    Enables or disables instant booting in powerUp()
+    void setInstantBoot(bool enable) { instantBoot = enable; }
+    
+    /*! @brief    Resets the virtual C64 and emulates it until BASIC waits for input
+     *  @details  The reached state is cached per ROM set and configuration. If the ROMs and the
+     *            configuration match a cached state, the state is restored via the snapshot
+     *            loader instead of emulating the boot sequence. Machines with an attached
+     *            cartridge are always booted the long way. Must be called while the execution
+     *            thread is halted.
+     *  @return   false if the ready prompt has not been reached within ten emulated seconds
+     */
+    bool bootToReady();
+    
+    //! @brief    Removes all cached post-boot states
+    static void flushBootCache();
+    
+    /*! @brief    Emulates the virtual C64 until a text shows up on the screen
+     *  @details  The screen is checked at the end of each frame. The emulation runs at maximum
+     *            speed. Must be called while the execution thread is halted.
+     *  @param    text       UTF-8 string that has to fit into a single row
+     *  @param    maxFrames  Number of frames to give up after
+     *  @return   true if the text has been found
+     */
+    bool runUntilText(const char *text, unsigned maxFrames);
+    
+private:
+    
+    /*! @brief    Computes the cache key of the freshly reset machine
+     *  @details  The key is a hash over the snapshot of the machine which covers the ROMs and
+     *            all configuration items. The color RAM is excluded, because it is initialized
+     *            with random values.
+     */
+    uint64_t bootCacheKey();
+    
+    /*! @brief    Searches the Kernal ROM for the loop waiting for keyboard input
+     *  @return   Start address of the loop or 0 if it has not been found
+     */
+    uint16_t readyLoopAddress();
+    
+public:
+    
+    
+    //
+    //! @functiongroup Travelling back in time
+    //
+    
+    /*! @brief    Reverts the most recently executed CPU instruction
+     *  @details  This method implements the "step back" action of the debugger. The emulator
+     *            restores a checkpoint and re-executes up to the previous instruction. Like
+     *            step(), it stops in the cycle following the opcode fetch. Must be called while
+     *            the execution thread is halted.
+     *  @return   false if no recorded checkpoint reaches back far enough
+     */
+    bool stepBack();
+    
+    /*! @brief    Travels back to the most recent instruction carrying a hard breakpoint
+     *  @details  This method implements the "continue backwards" action of the debugger.
+     *            Must be called while the execution thread is halted.
+     *  @return   false if no such instruction has been executed since the oldest checkpoint
+     */
+    bool continueBack();
+    
+private:
+    
+    /*! @brief    Searches the recorded history for the latest fetch completed before a cycle
+     *  @details  The checkpoints are replayed from the newest to the oldest one until an
+     *            instruction is found. If breakpoints is true, only instructions carrying a hard
+     *            breakpoint are considered.
+     *  @return   Cycle of the fetch or UINT64_MAX if none has been found
+     */
+    uint64_t lastFetchBefore(uint64_t limit, bool breakpoints, const uint8_t *tags,
+                             uint64_t *executed);
+    
+    //! @brief    Restores the newest checkpoint before a fetch and executes the fetch cycle
+    void replayUntilFetch(uint64_t fetch, uint64_t *executed);
+    
+    //! @brief    Common implementation of stepBack() and continueBack()
+    bool travelBack(bool breakpoints);
+    
+public:
+
+    
     //
     //! @functiongroup Operation modes
     //
@@ -664,11 +941,27 @@ public:
     /*! @brief    Takes a snapshot and inserts it into the auto-save storage
      *  @details  The new snapshot is inserted at position 0 and all others are moved
      *            one position up. If the buffer is full, the oldest snapshot is deleted.
+     *            If a rewind history is open, the snapshot is appended to it, too.
      *  @note     This function does not halt the emulator and must therefore be
      *            called inside the execution thread, only.
      */
     void takeAutoSnapshot();
     
+    /*! @brief    Opens a rewind history file
+     *  @details  While the file is open, each auto-taken snapshot is appended to it as well.
+     *            An existing history is continued.
+     */
+    bool openRewindHistory(const char *path);
+    
+    //! @brief    Closes the rewind history file
+    void closeRewindHistory();
+    
+    /*! @brief    Restores a snapshot from the rewind history
+     *  @param    position  Emulated time in frames. The most recent snapshot taken at or
+     *                      before this position is restored.
+     */
+    bool restoreFromRewindHistory(uint64_t position);
+    
     /*! @brief    Deletes a snapshot from the auto-save storage
      *  @details  All snapshots that follow are moved one position down.
      */
@@ -722,6 +1015,12 @@ public:
     //! @brief    Attaches a cartridge to the expansion port.
     bool attachCartridgeAndReset(CRTContainer *c);
 
+    /*! @brief    Attaches a RAM Expansion Unit to the expansion port.
+     *  @details  The REU doesn't change the memory layout, so the C64 is not reset.
+     *  @param    kb    128 (1700), 256 (1764), 512 (1750), or any larger power of two up to 16384
+     */
+    bool attachReu(unsigned kb);
+
     //! @brief    Detaches a cartridge from the expansion port.
     void detachCartridgeAndReset();
 
@@ -0,0 +1,415 @@
+/*!
+ * @file        C64Env.cpp
+ * @author      Dirk W. Hoffmann, www.dirkwhoffmann.de
+ * @copyright   2018 Dirk W. Hoffmann
+ */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "C64.h"
+#include "C64Env.h"
+
+C64Env::C64Env(C64 *prototype, unsigned instances)
+{
+    assert(prototype != NULL);
+    assert(instances > 0);
+
+    setDescription("C64Env");
+    debug(2, "Creating environment with %d instances\n", instances);
+
+    this->instances = instances;
+    machine = (C64 **)calloc(instances, sizeof(C64 *));
+    resetState = NULL;
+    resetStateSize = 0;
+    resetScreen = (int *)calloc(PAL_RASTERLINES * NTSC_PIXELS, sizeof(int));
+    resetRam = (uint8_t *)calloc(65536, 1);
+    memset(resetPalette, 0, sizeof(resetPalette));
+    resetObservation = NULL;
+
+    screenMode = OBSERVE_NOTHING;
+    scale = 1;
+    screenX = 0;
+    screenY = 0;
+    screenWidth = prototype->vic.isPAL() ? PAL_PIXELS : NTSC_PIXELS;
+    screenHeight = prototype->vic.isPAL() ? PAL_RASTERLINES : NTSC_RASTERLINES;
+    observedWidth = 0;
+    observedHeight = 0;
+    ramAddr = NULL;
+    ramCount = 0;
+    observationSize = 0;
+    observation = NULL;
+
+    action = NULL;
+    frameSkip = 1;
+    steps = 0;
+
+    threads = 0;
+    worker = NULL;
+    workers = 0;
+    placeWorkers = false;
+    memset(&workerPolicy, 0, sizeof(workerPolicy));
+    workerSiblings = false;
+    placedWorkers = 0;
+    pthread_mutex_init(&lock, NULL);
+    pthread_cond_init(&startCond, NULL);
+    pthread_cond_init(&doneCond, NULL);
+    generation = 0;
+    nextInstance = 0;
+    finishedInstances = 0;
+    terminate = false;
+
+    for (unsigned i = 0; i < instances; i++) {
+        machine[i] = new C64();
+        machine[i]->autoSaveSnapshots = false;
+        machine[i]->setWarp(true);
+    }
+    updateLayout();
+    setResetState(prototype);
+    reset();
+}
+
+C64Env::~C64Env()
+{
+    debug(2, "Releasing environment\n");
+
+    stopWorkers();
+    pthread_cond_destroy(&doneCond);
+    pthread_cond_destroy(&startCond);
+    pthread_mutex_destroy(&lock);
+
+    for (unsigned i = 0; i < instances; i++)
+        delete machine[i];
+
+    free(machine);
+    free(resetState);
+    free(resetScreen);
+    free(resetRam);
+    free(resetObservation);
+    free(ramAddr);
+    free(observation);
+}
+
+void
+C64Env::updateLayout()
+{
+    if (screenMode == OBSERVE_NOTHING) {
+        observedWidth = observedHeight = 0;
+    } else {
+        observedWidth = screenWidth / scale;
+        observedHeight = screenHeight / scale;
+    }
+    observationSize = observedWidth * observedHeight + ramCount;
+
+    // Keep at least one byte to get valid pointers
+    observation = (uint8_t *)realloc(observation, MAX(instances * observationSize, 1));
+    resetObservation = (uint8_t *)realloc(resetObservation, MAX(observationSize, 1));
+    memset(observation, 0, instances * observationSize);
+    observe(resetScreen, resetRam, resetPalette, resetObservation);
+}
+
+void
+C64Env::setScreenMode(C64EnvScreenMode mode, unsigned scale)
+{
+    assert(scale > 0);
+
+    screenMode = mode;
+    this->scale = scale;
+    updateLayout();
+}
+
+void
+C64Env::setScreenArea(unsigned x, unsigned y, unsigned width, unsigned height)
+{
+    if (x + width > NTSC_PIXELS || y + height > PAL_RASTERLINES) {
+        warn("Screen area %dx%d at (%d,%d) exceeds the screen buffer\n", width, height, x, y);
+        return;
+    }
+
+    screenX = x;
+    screenY = y;
+    screenWidth = width;
+    screenHeight = height;
+    updateLayout();
+}
+
+void
+C64Env::setRamAddresses(const uint16_t *addr, unsigned count)
+{
+    ramAddr = (uint16_t *)realloc(ramAddr, MAX(count, 1) * sizeof(uint16_t));
+    if (count)
+        memcpy(ramAddr, addr, count * sizeof(uint16_t));
+    ramCount = count;
+    updateLayout();
+}
+
+void
+C64Env::setThreads(unsigned value)
+{
+    stopWorkers();
+    threads = value;
+}
+
+void
+C64Env::setWorkerPolicy(const ThreadPolicy &policy, bool siblings)
+{
+    stopWorkers();
+    placeWorkers = true;
+    workerPolicy = policy;
+    workerSiblings = siblings;
+}
+
+void
+C64Env::setResetState(C64 *c64)
+{
+    assert(c64 != NULL);
+
+    resetStateSize = c64->stateSize();
+    resetState = (uint8_t *)realloc(resetState, resetStateSize);
+    uint8_t *ptr = resetState;
+    c64->saveToBuffer(&ptr);
+
+    memcpy(resetScreen, c64->vic.screenBuffer(), PAL_RASTERLINES * NTSC_PIXELS * sizeof(int));
+    memcpy(resetRam, c64->mem.ram, 65536);
+    for (unsigned i = 0; i < 16; i++)
+        resetPalette[i] = c64->vic.getColor(i);
+    observe(resetScreen, resetRam, resetPalette, resetObservation);
+}
+
+const uint8_t *
+C64Env::reset()
+{
+    for (unsigned i = 0; i < instances; i++)
+        reset(i);
+
+    return observation;
+}
+
+const uint8_t *
+C64Env::reset(unsigned nr)
+{
+    assert(nr < instances);
+
+    uint8_t *ptr = resetState;
+    machine[nr]->loadFromBuffer(&ptr);
+    C64Pool::applyInput(machine[nr], C64Input());
+
+    uint8_t *dst = observation + nr * observationSize;
+    memcpy(dst, resetObservation, observationSize);
+    return dst;
+}
+
+void
+C64Env::observe(C64 *c64, uint8_t *dst)
+{
+    uint32_t palette[16];
+    for (unsigned i = 0; i < 16; i++)
+        palette[i] = c64->vic.getColor(i);
+
+    observe((int *)c64->vic.screenBuffer(), c64->mem.ram, palette, dst);
+}
+
+void
+C64Env::observe(const int *screen, const uint8_t *ram, const uint32_t *palette, uint8_t *dst)
+{
+    screen += screenY * NTSC_PIXELS + screenX;
+
+    switch (screenMode) {
+
+        case OBSERVE_GRAYSCALE:
+        {
+            unsigned area = scale * scale;
+
+            for (unsigned y = 0; y < observedHeight; y++) {
+                for (unsigned x = 0; x < observedWidth; x++) {
+
+                    unsigned sum = 0;
+                    for (unsigned j = 0; j < scale; j++) {
+                        const uint8_t *p = (const uint8_t *)(screen + (y * scale + j) * NTSC_PIXELS + x * scale);
+                        for (unsigned i = 0; i < scale; i++, p += 4) {
+                            // ITU-R BT.601 luminance in fixed point (RGBA byte order)
+                            sum += (77 * p[0] + 150 * p[1] + 29 * p[2]) >> 8;
+                        }
+                    }
+                    *dst++ = (uint8_t)(sum / area);
+                }
+            }
+            break;
+        }
+        case OBSERVE_PALETTE:
+        {
+            // Neighbouring pixels mostly share the same color
+            uint32_t lastRgba = palette[0];
+            uint8_t lastIndex = 0;
+
+            for (unsigned y = 0; y < observedHeight; y++) {
+                const int *line = screen + y * scale * NTSC_PIXELS;
+                for (unsigned x = 0; x < observedWidth; x++) {
+
+                    uint32_t rgba = (uint32_t)line[x * scale];
+                    if (rgba != lastRgba) {
+                        uint8_t i;
+                        for (i = 0; i < 15 && palette[i] != rgba; i++);
+                        lastRgba = rgba;
+                        lastIndex = i;
+                    }
+                    *dst++ = lastIndex;
+                }
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    for (unsigned i = 0; i < ramCount; i++)
+        *dst++ = ram[ramAddr[i]];
+}
+
+void
+C64Env::stepInstance(unsigned nr)
+{
+    assert(nr < instances);
+
+    C64Pool::applyInput(machine[nr], action[nr]);
+    C64Pool::executeFrames(machine[nr], frameSkip);
+    observe(machine[nr], observation + nr * observationSize);
+}
+
+void
+C64Env::processInstances()
+{
+    while (nextInstance < instances) {
+
+        unsigned nr = nextInstance++;
+        pthread_mutex_unlock(&lock);
+        stepInstance(nr);
+        pthread_mutex_lock(&lock);
+
+        if (++finishedInstances == instances)
+            pthread_cond_signal(&doneCond);
+    }
+}
+
+void
+C64Env::workerLoop()
+{
+    uint64_t seen = 0;
+
+    pthread_mutex_lock(&lock);
+    if (placeWorkers) {
+
+        // The calling thread takes the first processor
+        unsigned nr = ++placedWorkers;
+        pthread_mutex_unlock(&lock);
+        ThreadPolicy policy = ThreadPlacement::policyForThread(workerPolicy, nr, workerSiblings);
+        if (!ThreadPlacement::applyToCurrentThread(policy))
+            warn("Worker policy has been rejected by the operating system\n");
+        pthread_mutex_lock(&lock);
+    }
+    while (1) {
+
+        while (generation == seen && !terminate)
+            pthread_cond_wait(&startCond, &lock);
+        if (terminate)
+            break;
+
+        seen = generation;
+        processInstances();
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+static void *
+envThread(void *data)
+{
+    ((C64Env *)data)->workerLoop();
+    return NULL;
+}
+
+void
+C64Env::startWorkers()
+{
+    unsigned n = threads;
+    if (n == 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        n = cores > 0 ? (unsigned)cores : 1;
+    }
+    n = MIN(n, instances);
+
+    // The calling thread is one of them
+    workers = n - 1;
+    if (workers == 0)
+        return;
+
+    debug(2, "Starting %d worker threads\n", workers);
+    terminate = false;
+    placedWorkers = 0;
+    worker = (pthread_t *)malloc(workers * sizeof(pthread_t));
+    for (unsigned i = 0; i < workers; i++) {
+        pthread_create(&worker[i], NULL, envThread, this);
+    }
+}
+
+void
+C64Env::stopWorkers()
+{
+    if (worker == NULL)
+        return;
+
+    pthread_mutex_lock(&lock);
+    terminate = true;
+    pthread_cond_broadcast(&startCond);
+    pthread_mutex_unlock(&lock);
+
+    for (unsigned i = 0; i < workers; i++) {
+        pthread_join(worker[i], NULL);
+    }
+    free(worker);
+    worker = NULL;
+    workers = 0;
+}
+
+const uint8_t *
+C64Env::step(const C64Input *actions)
+{
+    assert(actions != NULL);
+    action = actions;
+
+    if (worker == NULL)
+        startWorkers();
+
+    if (workers == 0) {
+
+        for (unsigned i = 0; i < instances; i++)
+            stepInstance(i);
+
+    } else {
+
+        pthread_mutex_lock(&lock);
+        nextInstance = 0;
+        finishedInstances = 0;
+        generation++;
+        pthread_cond_broadcast(&startCond);
+
+        // Lend a hand and wait for the stragglers
+        processInstances();
+        while (finishedInstances < instances)
+            pthread_cond_wait(&doneCond, &lock);
+        pthread_mutex_unlock(&lock);
+    }
+
+    steps++;
+    return observation;
+}
@@ -0,0 +1,267 @@
+/*!
+ * @header      C64Env.h
+ * @author      Dirk W. Hoffmann, www.dirkwhoffmann.de
+ * @brief       Declares C64Env class
+ */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _C64ENV_INC
+#define _C64ENV_INC
+
+#include "C64Pool.h"
+#include "ThreadPlacement.h"
+
+//! @brief    Screen contents stored in an observation
+typedef enum {
+    OBSERVE_NOTHING = 0,    //! No screen contents
+    OBSERVE_GRAYSCALE,      //! Average luminance of each block of pixels
+    OBSERVE_PALETTE         //! C64 color index (0 - 15) of the upper left pixel of each block
+} C64EnvScreenMode;
+
+/*! @class    C64Env
+ *  @brief    Step / observe interface to many independent machines
+ *  @details  The environment is meant to be driven by external code (e.g., a training loop)
+ *            instead of the emulator thread. Each call to step() applies an action to every
+ *            instance, emulates a number of frames, and writes an observation of every instance
+ *            into a single contiguous buffer. An observation consists of the down-sampled
+ *            screen followed by a selectable list of RAM bytes. All instances are reset to a
+ *            stored state via the snapshot mechanism.
+ *            The instances are emulated by the calling thread and a pool of worker threads that
+ *            is kept alive between steps. Hence, a step involves a single wake up of the pool.
+ *  @note     The machines are run in warp mode without auto-snapshots.
+ */
+class C64Env : public VC64Object {
+
+private:
+
+    //! @brief    Number of instances
+    unsigned instances;
+
+    //! @brief    Emulated machines
+    C64 **machine;
+
+    //! @brief    State all instances are reset to
+    uint8_t *resetState;
+    size_t resetStateSize;
+
+    /*! @brief    Screen, RAM, and colors of the reset state
+     *  @details  The screen buffers are not part of snapshots. Hence, they are copied from
+     *            the machine that provides the reset state.
+     */
+    int *resetScreen;
+    uint8_t *resetRam;
+    uint32_t resetPalette[16];
+
+    //! @brief    Observation of the reset state
+    uint8_t *resetObservation;
+
+
+    //
+    // Observations
+    //
+
+    //! @brief    Screen contents stored in observations
+    C64EnvScreenMode screenMode;
+
+    //! @brief    Width and height of a pixel block that is reduced to a single value
+    unsigned scale;
+
+    //! @brief    Origin and size of the observed screen area in pixels
+    unsigned screenX, screenY, screenWidth, screenHeight;
+
+    //! @brief    Width and height of the down-sampled screen
+    unsigned observedWidth, observedHeight;
+
+    //! @brief    Observed RAM locations
+    uint16_t *ramAddr;
+    unsigned ramCount;
+
+    //! @brief    Size of a single observation in bytes
+    size_t observationSize;
+
+    //! @brief    Observations of all instances
+    uint8_t *observation;
+
+
+    //
+    // Stepping
+    //
+
+    //! @brief    Actions of the current step
+    const C64Input *action;
+
+    //! @brief    Number of frames emulated per step
+    unsigned frameSkip;
+
+    //! @brief    Number of performed steps
+    uint64_t steps;
+
+
+    //
+    // Worker pool
+    //
+
+    //! @brief    Requested number of threads including the calling thread (0 = one per core)
+    unsigned threads;
+
+    //! @brief    Worker threads
+    pthread_t *worker;
+    unsigned workers;
+
+    //! @brief    Indicates that the workers are placed according to workerPolicy
+    bool placeWorkers;
+
+    //! @brief    Placement policy of the worker pool
+    ThreadPolicy workerPolicy;
+
+    //! @brief    Indicates that co-operating workers are placed on SMT siblings first
+    bool workerSiblings;
+
+    //! @brief    Number of workers that have picked their placement
+    unsigned placedWorkers;
+
+    //! @brief    Protects the variables below
+    pthread_mutex_t lock;
+
+    //! @brief    Signals the start of a step to the workers
+    pthread_cond_t startCond;
+
+    //! @brief    Signals the end of a step to the calling thread
+    pthread_cond_t doneCond;
+
+    //! @brief    Incremented with each step
+    uint64_t generation;
+
+    //! @brief    Next instance to be emulated and number of emulated instances in this step
+    unsigned nextInstance;
+    unsigned finishedInstances;
+
+    //! @brief    Asks the workers to terminate
+    bool terminate;
+
+public:
+
+    //! @brief    Creates an environment whose instances start in the state of the prototype
+    C64Env(C64 *prototype, unsigned instances);
+
+    //! @brief    Destructor
+    ~C64Env();
+
+
+    //
+    //! @functiongroup Configuring the environment
+    //
+
+    /*! @brief    Selects the screen contents of observations
+     *  @details  Each block of scale x scale pixels is reduced to a single byte.
+     *            The screen area defaults to the whole drawn area.
+     */
+    void setScreenMode(C64EnvScreenMode mode, unsigned scale = 1);
+
+    //! @brief    Restricts the observed screen area (in screen buffer coordinates)
+    void setScreenArea(unsigned x, unsigned y, unsigned width, unsigned height);
+
+    //! @brief    Selects the RAM locations that are appended to each observation
+    void setRamAddresses(const uint16_t *addr, unsigned count);
+
+    //! @brief    Sets the number of frames emulated by each step
+    void setFrameSkip(unsigned value) { assert(value > 0); frameSkip = value; }
+
+    //! @brief    Sets the number of threads including the calling thread (0 = one per core)
+    void setThreads(unsigned value);
+
+    /*! @brief    Places the worker threads
+     *  @details  Each worker is pinned to a single processor of the policy's set and gets the
+     *            policy's scheduling class and priority (see ThreadPlacement::policyForThread()).
+     *            The first processor is left to the calling thread, which is not modified.
+     *  @param    siblings  Fill the SMT siblings of a core before using the next core
+     */
+    void setWorkerPolicy(const ThreadPolicy &policy, bool siblings);
+
+    //! @brief    Makes the current state of a machine the new reset state
+    void setResetState(C64 *c64);
+
+
+    //
+    //! @functiongroup Running the environment
+    //
+
+    //! @brief    Resets all instances and returns their observations
+    const uint8_t *reset();
+
+    //! @brief    Resets a single instance and returns its observation
+    const uint8_t *reset(unsigned nr);
+
+    /*! @brief    Performs a step in all instances
+     *  @param    actions   One input for each instance
+     *  @return   The observations of all instances
+     */
+    const uint8_t *step(const C64Input *actions);
+
+    //! @brief    Performs a step in a single instance (called by the worker threads)
+    void stepInstance(unsigned nr);
+
+
+    //
+    //! @functiongroup Examining the environment
+    //
+
+    //! @brief    Returns the number of instances
+    unsigned numInstances() { return instances; }
+
+    //! @brief    Returns the size of the down-sampled screen
+    unsigned getObservedWidth() { return observedWidth; }
+    unsigned getObservedHeight() { return observedHeight; }
+
+    //! @brief    Returns the size of a single observation in bytes
+    size_t getObservationSize() { return observationSize; }
+
+    //! @brief    Returns the observations of all instances
+    const uint8_t *getObservations() { return observation; }
+
+    //! @brief    Returns the observation of a single instance
+    const uint8_t *getObservation(unsigned nr) {
+        assert(nr < instances); return observation + nr * observationSize; }
+
+    //! @brief    Returns the machine of an instance
+    C64 *getMachine(unsigned nr) { assert(nr < instances); return machine[nr]; }
+
+    //! @brief    Returns the number of performed steps
+    uint64_t getSteps() { return steps; }
+
+    //! @brief    Main loop of the worker threads
+    void workerLoop();
+
+private:
+
+    //! @brief    Computes the size of observations and reallocates the buffers
+    void updateLayout();
+
+    //! @brief    Writes the observation of a machine
+    void observe(C64 *c64, uint8_t *dst);
+
+    //! @brief    Writes an observation of the specified screen buffer and RAM
+    void observe(const int *screen, const uint8_t *ram, const uint32_t *palette, uint8_t *dst);
+
+    //! @brief    Starts or stops the worker threads
+    void startWorkers();
+    void stopWorkers();
+
+    //! @brief    Emulates instances until all are done (called with the lock held)
+    void processInstances();
+};
+
+#endif
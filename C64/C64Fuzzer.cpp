@@ -0,0 +1,494 @@
+/*!
+ * @file        C64Fuzzer.cpp
+ * @author      Dirk W. Hoffmann, www.dirkwhoffmann.de
+ * @copyright   2018 Dirk W. Hoffmann
+ */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "C64.h"
+#include "C64Fuzzer.h"
+
+C64Fuzzer::C64Fuzzer(C64 *prototype)
+{
+    assert(prototype != NULL);
+
+    setDescription("C64Fuzzer");
+    debug(2, "Creating fuzzer\n");
+
+    base = NULL;
+    maxLines = DEFAULT_MAX_LINES;
+    irqLimit = DEFAULT_IRQ_LIMIT;
+    maxSteps = DEFAULT_MAX_STEPS;
+    seed = 1;
+
+    corpus = NULL;
+    corpusSize = 0;
+    corpusCapacity = 0;
+    crash = NULL;
+    crashes = 0;
+    crashCapacity = 0;
+    coverage = (uint8_t *)calloc(CPU::COVERAGE_MAP_SIZE, 1);
+    covered = 0;
+    executions = 0;
+
+    threads = 0;
+    worker = NULL;
+    workers = 0;
+    pthread_mutex_init(&lock, NULL);
+    pending = 0;
+    nextWorker = 0;
+
+    setBaseState(prototype);
+}
+
+C64Fuzzer::~C64Fuzzer()
+{
+    debug(2, "Releasing fuzzer\n");
+
+    for (unsigned i = 0; i < workers; i++) {
+        delete worker[i].c64;
+        free(worker[i].coverage);
+        free(worker[i].step);
+    }
+    for (unsigned i = 0; i < corpusSize; i++)
+        free(corpus[i].step);
+    for (unsigned i = 0; i < crashes; i++)
+        free(crash[i].input.step);
+
+    free(worker);
+    free(corpus);
+    free(crash);
+    free(coverage);
+    delete base;
+    pthread_mutex_destroy(&lock);
+}
+
+void
+C64Fuzzer::setBaseState(C64 *c64)
+{
+    assert(c64 != NULL);
+
+    delete base;
+    base = c64->takeSnapshotUnsafe();
+}
+
+void
+C64Fuzzer::setSeed(uint64_t value)
+{
+    seed = value;
+    for (unsigned i = 0; i < workers; i++)
+        worker[i].random = (seed + i + 1) * 0x9E3779B97F4A7C15ULL;
+}
+
+void
+C64Fuzzer::createWorkers(unsigned count)
+{
+    if (count <= workers)
+        return;
+
+    worker = (C64FuzzWorker *)realloc(worker, count * sizeof(C64FuzzWorker));
+    for (unsigned i = workers; i < count; i++) {
+
+        C64FuzzWorker *w = &worker[i];
+        w->c64 = new C64();
+        w->c64->autoSaveSnapshots = false;
+        w->c64->setWarp(true);
+        w->coverage = (uint8_t *)malloc(CPU::COVERAGE_MAP_SIZE);
+        w->c64->cpu.startCoverage(w->coverage);
+        w->step = NULL;
+        w->steps = 0;
+        w->capacity = 0;
+        w->random = (seed + i + 1) * 0x9E3779B97F4A7C15ULL;
+    }
+    workers = count;
+}
+
+C64FuzzResult
+C64Fuzzer::addSeed(const C64FuzzStep *step, unsigned steps)
+{
+    assert(step != NULL);
+    assert(steps > 0);
+
+    createWorkers(1);
+
+    C64FuzzWorker *w = &worker[0];
+    w->steps = 0;
+    for (unsigned i = 0; i < steps; i++)
+        insertStep(w, i, step[i]);
+
+    C64FuzzCrash info;
+    execute(w->c64, w->step, w->steps, &info);
+
+    pthread_mutex_lock(&lock);
+    evaluate(w, info, true);
+    pthread_mutex_unlock(&lock);
+
+    return info.result;
+}
+
+static void *
+fuzzThread(void *data)
+{
+    ((C64Fuzzer *)data)->workerLoop();
+    return NULL;
+}
+
+unsigned
+C64Fuzzer::fuzz(uint64_t runs)
+{
+    // Start with an input that does nothing
+    if (corpusSize == 0) {
+        C64FuzzStep idle;
+        memset(&idle, 0, sizeof(idle));
+        idle.lines = (uint16_t)MIN(maxLines, 0xFFFF);
+        addSeed(&idle, 1);
+    }
+    if (corpusSize == 0) {
+        warn("No seed input reaches the end of a run\n");
+        return 0;
+    }
+
+    unsigned n = threads;
+    if (n == 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        n = cores > 0 ? (unsigned)cores : 1;
+    }
+    n = (unsigned)MIN(n, MAX(runs, 1));
+    createWorkers(n);
+
+    unsigned oldSize = corpusSize;
+    pending = runs;
+    nextWorker = 0;
+
+    // The calling thread is one of the workers
+    pthread_t *thread = new pthread_t[n];
+    for (unsigned i = 1; i < n; i++) {
+        pthread_create(&thread[i], NULL, fuzzThread, this);
+    }
+    workerLoop();
+    for (unsigned i = 1; i < n; i++) {
+        pthread_join(thread[i], NULL);
+    }
+    delete [] thread;
+
+    return corpusSize - oldSize;
+}
+
+void
+C64Fuzzer::workerLoop()
+{
+    pthread_mutex_lock(&lock);
+    C64FuzzWorker *w = &worker[nextWorker++];
+
+    while (pending) {
+
+        pending--;
+        pick(w);
+        pthread_mutex_unlock(&lock);
+
+        C64FuzzCrash info;
+        mutate(w);
+        execute(w->c64, w->step, w->steps, &info);
+
+        pthread_mutex_lock(&lock);
+        evaluate(w, info);
+    }
+
+    pthread_mutex_unlock(&lock);
+}
+
+C64FuzzResult
+C64Fuzzer::execute(C64 *c64, const C64FuzzStep *step, unsigned steps, C64FuzzCrash *info)
+{
+    assert(c64 != NULL);
+
+    c64->cpu.clearCoverage();
+    c64->loadFromSnapshotUnsafe(base);
+
+    C64FuzzResult result = FUZZ_OK;
+    uint64_t line = 0;
+    unsigned hung = 0;
+    uint64_t irqCycles = c64->cpu.getInterruptCycles();
+
+    for (unsigned i = 0; i < steps && line < maxLines && result == FUZZ_OK; i++) {
+
+        C64Pool::applyInput(c64, step[i].input);
+
+        for (unsigned j = 0; j < step[i].lines && line < maxLines; j++) {
+
+            // Finish the line if a breakpoint has been hit. A JAM opcode only sets the error
+            // state, so it must be checked before a breakpoint stop clears the state.
+            while (!c64->executeOneLine() &&
+                   c64->cpu.getErrorState() != CPU_ILLEGAL_INSTRUCTION) {
+                c64->cpu.clearErrorState();
+                c64->floppy.cpu.clearErrorState();
+            }
+            if (c64->cpu.getErrorState() == CPU_ILLEGAL_INSTRUCTION) {
+                result = FUZZ_JAM;
+                break;
+            }
+
+            // An unacknowledged interrupt keeps the CPU inside its handlers
+            uint64_t cycles = c64->cpu.getInterruptCycles();
+            if (irqLimit && c64->cpu.getIrqLine() &&
+                2 * (cycles - irqCycles) > (uint64_t)c64->vic.getCyclesPerRasterline()) {
+                if (++hung >= irqLimit) {
+                    result = FUZZ_IRQ_HANG;
+                    break;
+                }
+            } else {
+                hung = 0;
+            }
+            irqCycles = cycles;
+            line++;
+        }
+    }
+
+    if (info) {
+        info->result = result;
+        info->pc = result == FUZZ_JAM ? c64->cpu.getErrorAddr() : c64->cpu.getPC_at_cycle_0();
+        info->irqLine = c64->cpu.getIrqLine();
+        info->line = line;
+    }
+    c64->cpu.clearErrorState();
+    c64->floppy.cpu.clearErrorState();
+    return result;
+}
+
+void
+C64Fuzzer::pick(C64FuzzWorker *w)
+{
+    assert(corpusSize > 0);
+
+    C64FuzzInput *parent = &corpus[random(w->random) % corpusSize];
+    unsigned count = parent->steps;
+
+    // Splice two inputs from time to time
+    C64FuzzInput *other = NULL;
+    uint64_t r = random(w->random);
+    if (corpusSize > 1 && (r & 7) == 0) {
+        other = &corpus[(r >> 3) % corpusSize];
+        count = (unsigned)((r >> 32) % (parent->steps + 1));
+    }
+
+    w->steps = 0;
+    for (unsigned i = 0; i < count; i++)
+        insertStep(w, w->steps, parent->step[i]);
+
+    if (other) {
+        for (unsigned i = (unsigned)((r >> 48) % other->steps); i < other->steps; i++) {
+            if (w->steps == maxSteps) break;
+            insertStep(w, w->steps, other->step[i]);
+        }
+    }
+
+    // Keep at least one step to mutate
+    if (w->steps == 0)
+        insertStep(w, 0, parent->step[0]);
+}
+
+void
+C64Fuzzer::mutate(C64FuzzWorker *w)
+{
+    assert(w->steps > 0);
+
+    uint16_t longest = (uint16_t)MIN(maxLines, 0xFFFF);
+    unsigned rounds = 1 << (random(w->random) % 4);
+
+    for (unsigned i = 0; i < rounds; i++) {
+
+        uint64_t r = random(w->random);
+        unsigned pos = (unsigned)((r >> 8) % w->steps);
+        C64FuzzStep s = w->step[pos];
+
+        switch (r % 7) {
+
+            case 0: // Flip a joystick direction or the fire button
+                s.input.joystick[(r >> 40) & 1] ^= 1 << ((r >> 41) % 5);
+                break;
+
+            case 1: // Press or release a key
+                s.input.keys ^= (uint64_t)1 << ((r >> 44) & 63);
+                break;
+
+            case 2: // Hold the input for a different number of rasterlines
+                if ((r >> 40) & 1) {
+                    s.lines = (uint16_t)(1 + (r >> 48) % longest);
+                } else {
+                    int lines = s.lines + (int)((r >> 48) % 33) - 16;
+                    s.lines = (uint16_t)MAX(1, MIN(lines, longest));
+                }
+                break;
+
+            case 3: // Insert a pause that releases all keys and directions
+                if (w->steps < maxSteps) {
+                    memset(&s.input, 0, sizeof(s.input));
+                    s.lines = (uint16_t)(1 + (r >> 48) % MIN(longest, 64));
+                    insertStep(w, pos + ((r >> 40) & 1), s);
+                }
+                continue;
+
+            case 4: // Delete a step
+                if (w->steps > 1)
+                    deleteStep(w, pos);
+                continue;
+
+            case 5: // Duplicate a step
+                if (w->steps < maxSteps)
+                    insertStep(w, pos, s);
+                continue;
+
+            case 6: // Release all keys and directions
+                memset(&s.input, 0, sizeof(s.input));
+                break;
+        }
+        w->step[pos] = s;
+    }
+}
+
+void
+C64Fuzzer::insertStep(C64FuzzWorker *w, unsigned pos, const C64FuzzStep &value)
+{
+    assert(pos <= w->steps);
+
+    if (w->steps == w->capacity) {
+        w->capacity = MAX(2 * w->capacity, 16);
+        w->step = (C64FuzzStep *)realloc(w->step, w->capacity * sizeof(C64FuzzStep));
+    }
+    memmove(w->step + pos + 1, w->step + pos, (w->steps - pos) * sizeof(C64FuzzStep));
+    w->step[pos] = value;
+    w->steps++;
+}
+
+void
+C64Fuzzer::deleteStep(C64FuzzWorker *w, unsigned pos)
+{
+    assert(pos < w->steps);
+
+    memmove(w->step + pos, w->step + pos + 1, (w->steps - pos - 1) * sizeof(C64FuzzStep));
+    w->steps--;
+}
+
+bool
+C64Fuzzer::evaluate(C64FuzzWorker *w, const C64FuzzCrash &info, bool seed)
+{
+    executions++;
+    unsigned found = mergeCoverage(w->coverage);
+
+    // Drop the steps that have not been reached
+    uint64_t reached = info.result == FUZZ_OK ? info.line : info.line + 1;
+    unsigned steps = 0;
+    for (uint64_t sum = 0; steps < w->steps && sum < reached; steps++)
+        sum += w->step[steps].lines;
+    steps = MAX(steps, 1);
+
+    if (info.result != FUZZ_OK) {
+
+        for (unsigned i = 0; i < crashes; i++) {
+            if (crash[i].result != info.result)
+                continue;
+            if (info.result == FUZZ_JAM ? crash[i].pc == info.pc : crash[i].irqLine == info.irqLine)
+                return false;
+        }
+
+        debug(2, "Crash %d at %04X after %lld lines\n", info.result, info.pc, info.line);
+        if (crashes == crashCapacity) {
+            crashCapacity = MAX(2 * crashCapacity, 16);
+            crash = (C64FuzzCrash *)realloc(crash, crashCapacity * sizeof(C64FuzzCrash));
+        }
+        crash[crashes] = info;
+        crash[crashes].input = copyInput(w->step, steps);
+        crashes++;
+        return false;
+    }
+
+    if (!found && !seed)
+        return false;
+
+    debug(2, "Input with %d steps reaches %d new addresses\n", steps, found);
+    if (corpusSize == corpusCapacity) {
+        corpusCapacity = MAX(2 * corpusCapacity, 64);
+        corpus = (C64FuzzInput *)realloc(corpus, corpusCapacity * sizeof(C64FuzzInput));
+    }
+    corpus[corpusSize++] = copyInput(w->step, steps);
+    return true;
+}
+
+unsigned
+C64Fuzzer::mergeCoverage(const uint8_t *map)
+{
+    unsigned count = 0;
+
+    for (unsigned i = 0; i < CPU::COVERAGE_MAP_SIZE; i++) {
+        uint8_t bits = map[i] & ~coverage[i];
+        if (bits) {
+            coverage[i] |= bits;
+            for (; bits; bits &= bits - 1) count++;
+        }
+    }
+    covered += count;
+    return count;
+}
+
+C64FuzzInput
+C64Fuzzer::copyInput(const C64FuzzStep *step, unsigned steps)
+{
+    C64FuzzInput input;
+    input.step = (C64FuzzStep *)malloc(steps * sizeof(C64FuzzStep));
+    input.steps = steps;
+    memcpy(input.step, step, steps * sizeof(C64FuzzStep));
+    return input;
+}
+
+uint64_t
+C64Fuzzer::random(uint64_t &state)
+{
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1DULL;
+}
+
+void
+C64Fuzzer::dumpState()
+{
+    msg("C64Fuzzer\n");
+    msg("---------\n\n");
+    msg("      Executions : %lld\n", executions);
+    msg("     Corpus size : %d\n", corpusSize);
+    msg("Covered addresses: %d\n", covered);
+    msg("         Crashes : %d\n", crashes);
+
+    for (unsigned i = 0; i < crashes; i++) {
+        if (crash[i].result == FUZZ_JAM) {
+            msg("                   JAM at %04X after %lld lines (%d steps)\n",
+                crash[i].pc, crash[i].line, crash[i].input.steps);
+        } else {
+            msg("                   IRQ hang (sources %02X) after %lld lines (%d steps)\n",
+                crash[i].irqLine, crash[i].line, crash[i].input.steps);
+        }
+    }
+
+    msg("  Covered ranges :");
+    for (unsigned addr = 0, n = 0; addr < 65536; addr++) {
+        if (!isCovered(addr) || (addr && isCovered(addr - 1)))
+            continue;
+        unsigned end = addr;
+        while (end < 65535 && isCovered(end + 1)) end++;
+        msg("%s%04X-%04X", n++ % 6 ? " " : "\n                   ", addr, end);
+    }
+    msg("\n");
+}
@@ -0,0 +1,315 @@
+/*!
+ * @header      C64Fuzzer.h
+ * @author      Dirk W. Hoffmann, www.dirkwhoffmann.de
+ * @brief       Declares C64Fuzzer class
+ */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _C64FUZZER_INC
+#define _C64FUZZER_INC
+
+#include "C64Pool.h"
+
+class Snapshot;
+
+//! @brief    Keyboard and joystick state that is held for a number of rasterlines
+typedef struct {
+
+    //! @brief    Pressed keys and joystick directions
+    C64Input input;
+
+    //! @brief    Number of rasterlines the input is held
+    uint16_t lines;
+
+} C64FuzzStep;
+
+//! @brief    Sequence of inputs that is fed into a machine during a single run
+typedef struct {
+
+    //! @brief    Steps in the order they are applied
+    C64FuzzStep *step;
+    unsigned steps;
+
+} C64FuzzInput;
+
+//! @brief    Outcome of a run
+typedef enum {
+    FUZZ_OK = 0,      //! The run has ended after the maximum number of rasterlines
+    FUZZ_JAM,         //! The CPU has executed a JAM opcode
+    FUZZ_IRQ_HANG     //! The CPU has been kept busy by an interrupt that is never acknowledged
+} C64FuzzResult;
+
+//! @brief    Crash found by the fuzzer
+typedef struct {
+
+    //! @brief    Kind of the crash
+    C64FuzzResult result;
+
+    //! @brief    Address of the JAM opcode or program counter when the hang was detected
+    uint16_t pc;
+
+    //! @brief    Sources holding down the IRQ line when the hang was detected
+    uint8_t irqLine;
+
+    //! @brief    Number of rasterlines emulated before the crash
+    uint64_t line;
+
+    //! @brief    Input reproducing the crash
+    C64FuzzInput input;
+
+} C64FuzzCrash;
+
+//! @brief    Private state of a worker thread
+typedef struct {
+
+    //! @brief    Emulated machine
+    C64 *c64;
+
+    //! @brief    Addresses of the opcodes fetched in the current run
+    uint8_t *coverage;
+
+    //! @brief    Input of the current run and its storage capacity
+    C64FuzzStep *step;
+    unsigned steps;
+    unsigned capacity;
+
+    //! @brief    State of the random number generator
+    uint64_t random;
+
+} C64FuzzWorker;
+
+/*! @class    C64Fuzzer
+ *  @brief    Coverage guided fuzzing of keyboard and joystick input
+ *  @details  The fuzzer searches for inputs that drive a program into code that has not been
+ *            executed before. Each run restores a base snapshot, feeds a sequence of inputs
+ *            into the machine, and records the addresses of all fetched opcodes with the
+ *            CPU's coverage tags. Inputs reaching a new address are added to the corpus.
+ *            New inputs are derived from the corpus by stacking random mutations: flipping
+ *            joystick bits, toggling keys, changing how long an input is held, inserting,
+ *            deleting, and duplicating steps, and splicing two corpus entries.
+ *            A run is a crash if the CPU jams or if an interrupt hangs. An interrupt is
+ *            considered hung if the IRQ line stays low while the CPU spends most of each
+ *            rasterline inside interrupt handlers. A JAM is reported once per address, a hang
+ *            once per combination of interrupt sources.
+ *            Runs are carried out by the calling thread and a number of worker threads with
+ *            one machine each. Since the workers share the corpus, the order of discoveries
+ *            depends on the scheduling if more than one thread is used.
+ *  @note     The machines are run in warp mode without auto-snapshots. The throughput is
+ *            dominated by the emulation. Short runs and many threads are the key to a high
+ *            number of executions per second. A base state without a connected drive and
+ *            without audio filter emulation runs considerably faster.
+ */
+class C64Fuzzer : public VC64Object {
+
+public:
+
+    //! @brief    Default maximum length of a run in rasterlines (two PAL frames)
+    static const unsigned DEFAULT_MAX_LINES = 2 * 312;
+
+    //! @brief    Default number of rasterlines until an interrupt is considered hung (half a frame)
+    static const unsigned DEFAULT_IRQ_LIMIT = 312 / 2;
+
+    //! @brief    Default maximum number of steps of an input
+    static const unsigned DEFAULT_MAX_STEPS = 64;
+
+private:
+
+    //! @brief    State each run starts in
+    Snapshot *base;
+
+    //! @brief    Maximum length of a run in rasterlines
+    unsigned maxLines;
+
+    //! @brief    Number of rasterlines until an interrupt is considered hung (0 = never)
+    unsigned irqLimit;
+
+    //! @brief    Maximum number of steps of an input
+    unsigned maxSteps;
+
+    //! @brief    Seed of the random number generators
+    uint64_t seed;
+
+
+    //
+    // Results
+    //
+
+    //! @brief    Inputs that have reached new code
+    C64FuzzInput *corpus;
+    unsigned corpusSize;
+    unsigned corpusCapacity;
+
+    //! @brief    Found crashes
+    C64FuzzCrash *crash;
+    unsigned crashes;
+    unsigned crashCapacity;
+
+    //! @brief    Addresses of all opcodes fetched so far
+    uint8_t *coverage;
+
+    //! @brief    Number of addresses in the coverage map
+    unsigned covered;
+
+    //! @brief    Number of performed runs
+    uint64_t executions;
+
+
+    //
+    // Worker threads
+    //
+
+    //! @brief    Requested number of threads including the calling thread (0 = one per core)
+    unsigned threads;
+
+    //! @brief    Per thread state
+    C64FuzzWorker *worker;
+    unsigned workers;
+
+    //! @brief    Protects the results and the variables below
+    pthread_mutex_t lock;
+
+    //! @brief    Number of runs that remain to be performed by the current call to fuzz()
+    uint64_t pending;
+
+    //! @brief    Next worker to be assigned to a thread
+    unsigned nextWorker;
+
+public:
+
+    //! @brief    Creates a fuzzer whose runs start in the current state of the prototype
+    C64Fuzzer(C64 *prototype);
+
+    //! @brief    Destructor
+    ~C64Fuzzer();
+
+
+    //
+    //! @functiongroup Configuring the fuzzer
+    //
+
+    //! @brief    Makes the current state of a machine the new base state
+    void setBaseState(C64 *c64);
+
+    //! @brief    Sets the maximum length of a run in rasterlines
+    void setMaxLines(unsigned value) { assert(value > 0); maxLines = value; }
+
+    //! @brief    Sets the number of rasterlines until an interrupt is considered hung (0 = never)
+    void setIrqLimit(unsigned value) { irqLimit = value; }
+
+    //! @brief    Sets the maximum number of steps of an input
+    void setMaxSteps(unsigned value) { assert(value > 0); maxSteps = value; }
+
+    //! @brief    Sets the number of threads including the calling thread (0 = one per core)
+    void setThreads(unsigned value) { threads = value; }
+
+    //! @brief    Seeds the random number generators
+    void setSeed(uint64_t value);
+
+    /*! @brief    Adds an input to the corpus
+     *  @details  The input is run once to record its coverage. It is added even if it does not
+     *            reach any new code. If the corpus is empty when fuzzing starts, an input that
+     *            holds no key or joystick direction is added.
+     *  @return   Outcome of the run
+     */
+    C64FuzzResult addSeed(const C64FuzzStep *step, unsigned steps);
+
+
+    //
+    //! @functiongroup Fuzzing
+    //
+
+    /*! @brief    Performs the specified number of runs
+     *  @return   Number of inputs added to the corpus
+     */
+    unsigned fuzz(uint64_t runs);
+
+    /*! @brief    Feeds an input into a machine, starting from the base state
+     *  @details  If the CPU of the machine records coverage, its coverage map is cleared first.
+     *            Can be used to reproduce a crash on an observed machine.
+     *  @param    info  Outcome of the run (may be NULL). The input is left untouched.
+     */
+    C64FuzzResult execute(C64 *c64, const C64FuzzStep *step, unsigned steps,
+                          C64FuzzCrash *info = NULL);
+
+    //! @brief    Performs runs as long as the current call to fuzz() requests (called by the threads)
+    void workerLoop();
+
+
+    //
+    //! @functiongroup Examining the results
+    //
+
+    //! @brief    Returns the number of performed runs
+    uint64_t numExecutions() { return executions; }
+
+    //! @brief    Returns the number of inputs in the corpus
+    unsigned numCorpusEntries() { return corpusSize; }
+
+    //! @brief    Returns an input of the corpus
+    C64FuzzInput getCorpusEntry(unsigned nr) { assert(nr < corpusSize); return corpus[nr]; }
+
+    //! @brief    Returns the number of found crashes
+    unsigned numCrashes() { return crashes; }
+
+    //! @brief    Returns a crash
+    const C64FuzzCrash &getCrash(unsigned nr) { assert(nr < crashes); return crash[nr]; }
+
+    //! @brief    Returns the number of addresses that opcodes have been fetched from
+    unsigned numCoveredAddresses() { return covered; }
+
+    //! @brief    Returns true if an opcode has been fetched from the specified address
+    bool isCovered(uint16_t addr) { return (coverage[addr >> 3] >> (addr & 7)) & 1; }
+
+    //! @brief    Returns the coverage map of all runs (see CPU::startCoverage())
+    const uint8_t *getCoverage() { return coverage; }
+
+    //! @brief    Prints the corpus, the crashes, and the covered address ranges
+    void dumpState();
+
+private:
+
+    //! @brief    Creates the per thread state
+    void createWorkers(unsigned count);
+
+    //! @brief    Picks an input from the corpus and copies it into a worker (called with the lock held)
+    void pick(C64FuzzWorker *w);
+
+    //! @brief    Applies a random stack of mutations to the input of a worker
+    void mutate(C64FuzzWorker *w);
+
+    //! @brief    Inserts a step into the input of a worker
+    void insertStep(C64FuzzWorker *w, unsigned pos, const C64FuzzStep &value);
+
+    //! @brief    Removes a step from the input of a worker
+    void deleteStep(C64FuzzWorker *w, unsigned pos);
+
+    /*! @brief    Evaluates the finished run of a worker (called with the lock held)
+     *  @param    seed  Add the input to the corpus even if it reaches no new code
+     *  @return   true, if the input has been added to the corpus
+     */
+    bool evaluate(C64FuzzWorker *w, const C64FuzzCrash &info, bool seed = false);
+
+    //! @brief    Adds the coverage map of a run and returns the number of new addresses
+    unsigned mergeCoverage(const uint8_t *map);
+
+    //! @brief    Returns a copy of an input
+    static C64FuzzInput copyInput(const C64FuzzStep *step, unsigned steps);
+
+    //! @brief    Returns the next number of a xorshift random number generator
+    static uint64_t random(uint64_t &state);
+};
+
+#endif
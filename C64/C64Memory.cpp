@@ -32,6 +32,11 @@ C64Memory::C64Memory()
 	kernalRomFile = NULL;
 	basicRomFile = NULL;
     
+    capturedRam = NULL;
+    capturedFrame = 0;
+    captureClients = 0;
+    pthread_mutex_init(&captureLock, NULL);
+    
     // Register snapshot items
     SnapshotItem items[] = {
         
@@ -50,6 +55,9 @@ C64Memory::C64Memory()
 C64Memory::~C64Memory()
 {
 	debug(3, "  Releasing main memory at address %p...\n", this);
+    
+    free(capturedRam);
+    pthread_mutex_destroy(&captureLock);
 }
 
 void
@@ -87,6 +95,15 @@ C64Memory::reset()
     for (unsigned i = 0x1; i <= 0xF; i++)
         pokeTarget[i] = M_RAM;
     pokeTarget[0x0] = M_PP;
+    
+    updateDispatchTables();
+}
+
+void
+C64Memory::loadFromBuffer(uint8_t **buffer)
+{
+    VirtualComponent::loadFromBuffer(buffer);
+    updateDispatchTables();
 }
 
 
@@ -258,6 +275,24 @@ C64Memory::updatePeekPokeLookupTables()
     MemorySource target;
     target = BankMap[index][4]; // 0xD000 - 0xDFFF (I/O or RAM)
     pokeTarget[0xD] = (target == M_IO ? M_IO : M_RAM);
+    
+    updateDispatchTables();
+}
+
+void
+C64Memory::updateDispatchTables()
+{
+    uint16_t banks = heatmap.getBanks();
+    
+    for (unsigned i = 0; i <= 0xF; i++) {
+        bool traced = banks & (1 << i);
+        peekDispatch[i] = traced ? M_TRACED : peekSrc[i];
+        pokeDispatch[i] = traced ? M_TRACED : pokeTarget[i];
+    }
+    
+    // Let the expansion port see writes into $FF00 (REU transfer trigger)
+    if (c64->expansionport.watchesFF00())
+        pokeDispatch[0xF] = M_TRACED;
 }
 
 
@@ -359,10 +394,8 @@ uint8_t C64Memory::spyIO(uint16_t addr)
     }
 }
 
-uint8_t C64Memory::peek(uint16_t addr)
+uint8_t C64Memory::peek(uint16_t addr, MemorySource src)
 {
-    MemorySource src = peekSrc[addr >> 12];
-    
     switch(src) {
             
         case M_RAM:
@@ -393,6 +426,14 @@ uint8_t C64Memory::peek(uint16_t addr)
             // what happens if RAM is unmapped?
             return ram[addr];
 
+        case M_TRACED:
+            
+            if (c64->cpu.atBeginningOfNewCommand())
+                heatmap.recordExecution(addr, c64->getCycles());
+            else
+                heatmap.recordRead(addr, c64->getCycles());
+            return peek(addr, peekSrc[addr >> 12]);
+            
         default:
             assert(0);
             return 0;
@@ -505,40 +546,6 @@ void C64Memory::pokeIO(uint16_t addr, uint8_t value)
     assert(false);
 }
 
-void C64Memory::poke(uint16_t addr, uint8_t value)
-{	
-	MemorySource target = pokeTarget[addr >> 12];
-	    
-	switch(target) {
-			
-		case M_RAM:
-			ram[addr] = value;
-			return;
-			
-		case M_IO:
-			pokeIO(addr, value);
-			return;
-			
-		case M_PP:
-			
-            if (addr == 0x0000) {
-                c64->processorPort.writeDirection(value);
-                return;
-            }
-            if (addr == 0x0001) {
-                c64->processorPort.write(value);
-                return;
-            }
-    
-            ram[addr] = value;
-            return;
-
-		default:
-			assert(0);
-			return;
-	}
-}
-
 void
 C64Memory::pokeTo(uint16_t addr, uint8_t value, MemorySource target)
 {
@@ -563,8 +570,107 @@ C64Memory::pokeTo(uint16_t addr, uint8_t value, MemorySource target)
             }
             return;
             
+        case M_TRACED:
+            
+            if (heatmap.isInstrumented(addr))
+                heatmap.recordWrite(addr, c64->getCycles());
+            pokeTo(addr, value, pokeTarget[addr >> 12]);
+            if (addr == 0xFF00)
+                c64->expansionport.pokeFF00(value);
+            return;
+            
         default: // ignore
             return;
     }
 }
 
+
+//
+//! @functiongroup Recording memory accesses
+//
+
+void
+C64Memory::enableHeatmap(uint16_t banks)
+{
+    c64->suspend();
+    heatmap.enable(banks);
+    updateDispatchTables();
+    c64->resume();
+}
+
+void
+C64Memory::disableHeatmap()
+{
+    c64->suspend();
+    heatmap.disable();
+    updateDispatchTables();
+    c64->resume();
+}
+
+
+//
+//! @functiongroup Capturing RAM at frame boundaries
+//
+
+void
+C64Memory::addCaptureClient()
+{
+    pthread_mutex_lock(&captureLock);
+    if (capturedRam == NULL) {
+        capturedRam = (uint8_t *)malloc(sizeof(ram));
+        capturedFrame = 0;
+    }
+    captureClients++;
+    pthread_mutex_unlock(&captureLock);
+}
+
+void
+C64Memory::removeCaptureClient()
+{
+    pthread_mutex_lock(&captureLock);
+    assert(captureClients > 0);
+    if (--captureClients == 0) {
+        free(capturedRam);
+        capturedRam = NULL;
+        capturedFrame = 0;
+    }
+    pthread_mutex_unlock(&captureLock);
+}
+
+void
+C64Memory::captureRam(uint64_t frame)
+{
+    if (pthread_mutex_trylock(&captureLock) != 0)
+        return;
+    
+    if (capturedRam != NULL) {
+        memcpy(capturedRam, ram, sizeof(ram));
+        capturedFrame = frame;
+    }
+    pthread_mutex_unlock(&captureLock);
+}
+
+uint64_t
+C64Memory::getCapturedFrame()
+{
+    pthread_mutex_lock(&captureLock);
+    uint64_t result = capturedRam != NULL ? capturedFrame : 0;
+    pthread_mutex_unlock(&captureLock);
+    
+    return result;
+}
+
+uint64_t
+C64Memory::copyCapturedRam(uint8_t *buffer)
+{
+    uint64_t result = 0;
+    
+    pthread_mutex_lock(&captureLock);
+    if (capturedRam != NULL && capturedFrame != 0) {
+        memcpy(buffer, capturedRam, sizeof(ram));
+        result = capturedFrame;
+    }
+    pthread_mutex_unlock(&captureLock);
+    
+    return result;
+}
@@ -22,6 +22,7 @@
 #define _C64MEMORY_INC
 
 #include "Memory.h"
+#include "Heatmap.h"
 
 // Forward declarations
 class VIC;
@@ -31,7 +32,7 @@ class SIDBridge;
  *  @details  Note that the RAM, ROM, and the I/O space are superposed and therefore share the same locations 
  *            in memory. The contents of memory location 0x0001 determines which memory is currently visible. 
  */
-class C64Memory : public Memory {
+class C64Memory final : public Memory {
 
     //! @brief    C64 bank mapping
     //
@@ -189,8 +190,25 @@ private:
     //! @brief    Lookup table for poke()
     MemorySource pokeTarget[16];
     
+    /*! @brief    Lookup tables used by peek() and poke()
+     *  @details  The tables are copies of peekSrc and pokeTarget. Banks instrumented by the
+     *            heatmap are mapped to M_TRACED which sends all accesses through the slow path.
+     *            Bank $F is mapped to M_TRACED for writes while the expansion port watches $FF00.
+     */
+    MemorySource peekDispatch[16];
+    MemorySource pokeDispatch[16];
+    
 public:
     
+    /*! @brief    Copies the lookup tables into the dispatch tables
+     *  @details  Needs to be called whenever the heatmap is enabled or disabled and whenever the
+     *            expansion port starts or stops watching $FF00.
+     */
+    void updateDispatchTables();
+    
+    //! @brief    Method from VirtualComponent
+    void loadFromBuffer(uint8_t **buffer);
+    
     /*! @brief    Updates the peek and poke lookup tables.
      *  @details  The lookup values depend on three processor port bits and the cartridge exrom and game lines 
      */
@@ -199,7 +217,56 @@ public:
     //! @brief    Returns the current peek source of the specified memory address
     MemorySource peekSource(uint16_t addr) { return peekSrc[addr >> 12]; }
     
-    uint8_t peek(uint16_t addr);
+    //! @brief    Returns the current poke target of the specified memory address
+    MemorySource pokeTargetOf(uint16_t addr) { return pokeTarget[addr >> 12]; }
+    
+    /*! @brief    Returns true if the specified memory cell is static
+     *  @details  A memory cell is static if it can be read without side effects and its
+     *            value can only be changed by the CPU. This applies to RAM and ROM.
+     */
+    bool isStatic(uint16_t addr) {
+        MemorySource src = peekDispatch[addr >> 12];
+        return src == M_RAM || src == M_ROM || (src == M_PP && addr > 0x0001);
+    }
+    
+    /*! @brief    Returns true if the specified memory cell is a pollable I/O register
+     *  @details  A register is pollable if it can be read without side effects. This
+     *            applies to all VIC registers except the collision registers.
+     */
+    bool isPollable(uint16_t addr) {
+        return peekDispatch[0xD] == M_IO && (addr & 0xFC00) == 0xD000 &&
+        (addr & 0x3F) != 0x1E && (addr & 0x3F) != 0x1F;
+    }
+    
+    //! @brief    Returns true if a CPU write to the specified address goes to RAM
+    bool isRamTarget(uint16_t addr) {
+        MemorySource target = pokeDispatch[addr >> 12];
+        return target == M_RAM || (target == M_PP && addr > 0x0001);
+    }
+    
+    /*! @brief    Returns true if CPU accesses to the specified address don't leave the CPU's memory
+     *  @details  This applies to addresses that read from RAM, ROM, or the processor port and write
+     *            into RAM or the processor port. Accesses of this kind don't need to be synchronized
+     *            with the system bus and can be performed at turbo speed.
+     */
+    bool isFast(uint16_t addr) {
+        MemorySource src = peekSrc[addr >> 12], target = pokeTarget[addr >> 12];
+        return (src == M_RAM || src == M_ROM || src == M_PP) && (target == M_RAM || target == M_PP);
+    }
+    
+    /*! @brief    Peeks a byte from memory.
+     *  @details  RAM and ROM accesses are served inline. All other accesses are
+     *            delegated to peek(addr, src).
+     */
+    uint8_t peek(uint16_t addr) {
+        MemorySource src = peekDispatch[addr >> 12];
+        if (src == M_RAM || (src == M_PP && addr > 0x0001)) return ram[addr];
+        if (src == M_ROM) return rom[addr];
+        return peek(addr, src);
+    }
+    
+    //! @brief    Peeks a byte from the specified memory source.
+    uint8_t peek(uint16_t addr, MemorySource src);
     uint8_t peekIO(uint16_t addr);
     
     uint8_t spy(uint16_t addr);
@@ -217,14 +284,87 @@ public:
     void pokeIO(uint16_t addr, uint8_t value);
 
     /*! @brief    Writes a byte into memory.
-     *  @details  The memory target (RAM, ROM, or I/O space) is read from the poke lookup table. 
+     *  @details  The memory target (RAM, ROM, or I/O space) is read from the poke lookup table.
+     *            RAM accesses are served inline. All other accesses are delegated to pokeTo().
      */
-    void poke(uint16_t addr, uint8_t value);
+    void poke(uint16_t addr, uint8_t value) {
+        MemorySource target = pokeDispatch[addr >> 12];
+        if (target == M_RAM || (target == M_PP && addr > 0x0001)) ram[addr] = value;
+        else pokeTo(addr, value, target);
+    }
     
-    //! @brief    Writes a byte into memory.
-    /*! @details  This method is only used by the debugger only.
-     */
+    //! @brief    Writes a byte into the specified memory target.
     void pokeTo(uint16_t addr, uint8_t value, MemorySource target);
+    
+    /*! @brief    Peeks a byte on behalf of a DMA controller
+     *  @details  DMA accesses see the same memory layout as the CPU, but are not recorded.
+     */
+    uint8_t peekDma(uint16_t addr) { return peek(addr, peekSrc[addr >> 12]); }
+    
+    //! @brief    Pokes a byte on behalf of a DMA controller
+    void pokeDma(uint16_t addr, uint8_t value) { pokeTo(addr, value, pokeTarget[addr >> 12]); }
+
+
+    //
+    //! @functiongroup Recording memory accesses
+    //
+
+    /*! @brief    Access statistics of the CPU
+     *  @details  Only CPU accesses are recorded. VIC fetches bypass the peek and poke functions.
+     */
+    Heatmap heatmap;
+
+    /*! @brief    Starts recording CPU accesses in the specified banks (bit n = bank n)
+     *  @details  Accesses to all other banks are still served inline.
+     */
+    void enableHeatmap(uint16_t banks);
+
+    //! @brief    Stops recording CPU accesses and frees the heatmap
+    void disableHeatmap();
+
+
+    //
+    //! @functiongroup Capturing RAM at frame boundaries
+    //
+
+private:
+
+    //! @brief    Copy of the RAM taken at the end of the most recent frame
+    uint8_t *capturedRam;
+
+    //! @brief    Frame the copy has been taken in (0 = no copy has been taken yet)
+    uint64_t capturedFrame;
+
+    //! @brief    Number of clients requesting captures
+    unsigned captureClients;
+
+    //! @brief    Protects the variables above
+    pthread_mutex_t captureLock;
+
+public:
+
+    //! @brief    Starts capturing RAM at the end of each frame
+    void addCaptureClient();
+
+    //! @brief    Stops capturing RAM once the last client is gone
+    void removeCaptureClient();
+
+    //! @brief    Returns true if RAM is captured at the end of each frame
+    bool isCapturing() { return captureClients > 0; }
+
+    /*! @brief    Copies the RAM into the capture buffer
+     *  @details  Called by the C64 at the end of each frame. The capture is skipped if a client
+     *            is reading the buffer to never stall the emulator thread.
+     */
+    void captureRam(uint64_t frame);
+
+    //! @brief    Returns the frame of the most recent capture (0 = nothing has been captured yet)
+    uint64_t getCapturedFrame();
+
+    /*! @brief    Copies the most recently captured RAM into the specified buffer
+     *  @return   Frame the capture has been taken in (0 = nothing has been captured yet)
+     */
+    uint64_t copyCapturedRam(uint8_t *buffer);
 };
 
 #endif
@@ -0,0 +1,342 @@
+/*
+ * (C) 2018 Dirk W. Hoffmann. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "C64.h"
+#include "C64Pool.h"
+
+C64Pool::C64Pool(C64 *prototype, unsigned lanes)
+{
+    assert(prototype != NULL);
+    assert(lanes > 0);
+
+    setDescription("C64Pool");
+    debug(2, "Creating pool with %d lanes\n", lanes);
+
+    this->lanes = lanes;
+    input = (C64Input *)calloc(lanes, sizeof(C64Input));
+    group = (unsigned *)calloc(lanes, sizeof(unsigned));
+    machine = NULL;
+    groupInput = NULL;
+    groups = 0;
+    capacity = 0;
+    threads = 0;
+    placeWorkers = false;
+    memset(&workerPolicy, 0, sizeof(workerPolicy));
+    workerSiblings = false;
+    frames = 0;
+    splits = 0;
+    merges = 0;
+
+    // All lanes start in the same group
+    C64Input none;
+    memset(&none, 0, sizeof(none));
+    addGroup(clone(prototype), none);
+}
+
+C64Pool::~C64Pool()
+{
+    debug(2, "Releasing pool\n");
+
+    for (unsigned i = 0; i < groups; i++)
+        delete machine[i];
+
+    free(input);
+    free(group);
+    free(machine);
+    free(groupInput);
+}
+
+C64 *
+C64Pool::clone(C64 *original)
+{
+    C64 *c64 = new C64();
+    size_t size = original->stateSize();
+    uint8_t *buffer = (uint8_t *)malloc(size);
+    uint8_t *ptr;
+
+    ptr = buffer;
+    original->saveToBuffer(&ptr);
+    ptr = buffer;
+    c64->loadFromBuffer(&ptr);
+    free(buffer);
+
+    c64->autoSaveSnapshots = false;
+    c64->setWarp(true);
+    return c64;
+}
+
+unsigned
+C64Pool::addGroup(C64 *c64, const C64Input &value)
+{
+    if (groups == capacity) {
+        capacity = MAX(2 * capacity, 16);
+        machine = (C64 **)realloc(machine, capacity * sizeof(C64 *));
+        groupInput = (C64Input *)realloc(groupInput, capacity * sizeof(C64Input));
+    }
+
+    machine[groups] = c64;
+    groupInput[groups] = value;
+    applyInput(c64, value);
+    return groups++;
+}
+
+void
+C64Pool::applyInput(C64 *c64, const C64Input &value)
+{
+    c64->keyboard.releaseAll();
+    for (unsigned i = 0; i < 64; i++) {
+        if (value.keys & ((uint64_t)1 << i))
+            c64->keyboard.pressKey(i / 8, i % 8);
+    }
+
+    ControlPort *port[2] = { &c64->port1, &c64->port2 };
+    for (unsigned i = 0; i < 2; i++) {
+        uint8_t bits = value.joystick[i];
+        port[i]->trigger(RELEASE_XY);
+        port[i]->trigger(RELEASE_FIRE);
+        if (bits & 0x01) port[i]->trigger(PULL_UP);
+        if (bits & 0x02) port[i]->trigger(PULL_DOWN);
+        if (bits & 0x04) port[i]->trigger(PULL_LEFT);
+        if (bits & 0x08) port[i]->trigger(PULL_RIGHT);
+        if (bits & 0x10) port[i]->trigger(PRESS_FIRE);
+    }
+}
+
+void
+C64Pool::setInput(unsigned lane, const C64Input &value)
+{
+    assert(lane < lanes);
+    input[lane] = value;
+}
+
+void
+C64Pool::split()
+{
+    unsigned oldGroups = groups;
+    bool *claimed = (bool *)calloc(oldGroups, sizeof(bool));
+    unsigned *parent = NULL;
+
+    for (unsigned lane = 0; lane < lanes; lane++) {
+
+        unsigned g = group[lane];
+
+        // The first lane of a group determines the input of its machine
+        if (!claimed[g]) {
+            claimed[g] = true;
+            if (!sameInput(groupInput[g], input[lane])) {
+                groupInput[g] = input[lane];
+                applyInput(machine[g], input[lane]);
+            }
+            continue;
+        }
+        if (sameInput(groupInput[g], input[lane]))
+            continue;
+
+        // Look for a group that has been split off from the same group in this round
+        unsigned h;
+        for (h = oldGroups; h < groups; h++) {
+            if (parent[h - oldGroups] == g && sameInput(groupInput[h], input[lane]))
+                break;
+        }
+
+        // Split off a new group. Its machine starts in the state of the parent machine.
+        if (h == groups) {
+            h = addGroup(clone(machine[g]), input[lane]);
+            parent = (unsigned *)realloc(parent, (groups - oldGroups) * sizeof(unsigned));
+            parent[h - oldGroups] = g;
+            splits++;
+        }
+        group[lane] = h;
+    }
+
+    free(claimed);
+    free(parent);
+}
+
+void
+C64Pool::executeGroup(unsigned nr, unsigned count)
+{
+    executeFrames(machine[nr], count);
+}
+
+void
+C64Pool::executeFrames(C64 *c64, unsigned count)
+{
+    uint64_t target = c64->getFrame() + count;
+
+    while (c64->getFrame() < target) {
+        if (!c64->executeOneLine()) {
+
+            // Keep going if the CPU has jammed or hit a breakpoint
+            c64->cpu.clearErrorState();
+            c64->floppy.cpu.clearErrorState();
+        }
+    }
+}
+
+//! @brief    Work shared among all worker threads
+typedef struct {
+    C64Pool *pool;
+    unsigned count;
+    unsigned groups;
+    unsigned nextGroup;
+    unsigned nextThread;
+    pthread_mutex_t lock;
+} C64PoolJob;
+
+static void *
+poolThread(void *data)
+{
+    C64PoolJob *job = (C64PoolJob *)data;
+
+    pthread_mutex_lock(&job->lock);
+    unsigned thread = job->nextThread++;
+    pthread_mutex_unlock(&job->lock);
+    job->pool->placeWorker(thread);
+
+    while (1) {
+
+        // Grab the next group
+        pthread_mutex_lock(&job->lock);
+        unsigned nr = job->nextGroup++;
+        pthread_mutex_unlock(&job->lock);
+
+        if (nr >= job->groups)
+            break;
+
+        job->pool->executeGroup(nr, job->count);
+    }
+
+    return NULL;
+}
+
+void
+C64Pool::executeFrames(unsigned count)
+{
+    split();
+
+    unsigned n = threads;
+    if (n == 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        n = cores > 0 ? (unsigned)cores : 1;
+    }
+    n = MIN(n, groups);
+
+    // Avoid the thread overhead if there is only one worker
+    if (n == 1) {
+        for (unsigned i = 0; i < groups; i++)
+            executeGroup(i, count);
+        frames += count;
+        return;
+    }
+
+    C64PoolJob job;
+    job.pool = this;
+    job.count = count;
+    job.groups = groups;
+    job.nextGroup = 0;
+    job.nextThread = 0;
+    pthread_mutex_init(&job.lock, NULL);
+
+    pthread_t *thread = new pthread_t[n];
+    for (unsigned i = 0; i < n; i++) {
+        pthread_create(&thread[i], NULL, poolThread, &job);
+    }
+    for (unsigned i = 0; i < n; i++) {
+        pthread_join(thread[i], NULL);
+    }
+    delete [] thread;
+
+    pthread_mutex_destroy(&job.lock);
+    frames += count;
+}
+
+void
+C64Pool::placeWorker(unsigned nr)
+{
+    if (!placeWorkers)
+        return;
+
+    ThreadPolicy policy = ThreadPlacement::policyForThread(workerPolicy, nr, workerSiblings);
+    if (!ThreadPlacement::applyToCurrentThread(policy))
+        warn("Worker policy has been rejected by the operating system\n");
+}
+
+unsigned
+C64Pool::merge()
+{
+    if (groups < 2)
+        return 0;
+
+    // All machines are in lockstep. Hence, all snapshots have the same size.
+    size_t size = machine[0]->stateSize();
+    uint8_t *state = (uint8_t *)malloc(groups * size);
+    uint64_t *hash = (uint64_t *)malloc(groups * sizeof(uint64_t));
+    unsigned *target = (unsigned *)malloc(groups * sizeof(unsigned));
+
+    for (unsigned i = 0; i < groups; i++) {
+
+        uint8_t *ptr = state + i * size;
+        assert(machine[i]->stateSize() == size);
+        machine[i]->saveToBuffer(&ptr);
+
+        // FNV-1a
+        hash[i] = 0xcbf29ce484222325ULL;
+        for (size_t j = 0; j < size; j++)
+            hash[i] = (hash[i] ^ state[i * size + j]) * 0x100000001b3ULL;
+    }
+
+    // Find the first group with the same state and input for each group
+    unsigned kept = 0;
+    for (unsigned i = 0; i < groups; i++) {
+
+        target[i] = i;
+        for (unsigned j = 0; j < i; j++) {
+            if (target[j] == j && hash[i] == hash[j] &&
+                sameInput(groupInput[i], groupInput[j]) &&
+                memcmp(state + i * size, state + j * size, size) == 0) {
+                target[i] = j;
+                break;
+            }
+        }
+    }
+
+    // Remove merged groups and renumber the remaining ones
+    for (unsigned i = 0; i < groups; i++) {
+
+        if (target[i] != i) {
+            delete machine[i];
+            target[i] = target[target[i]];
+            continue;
+        }
+        machine[kept] = machine[i];
+        groupInput[kept] = groupInput[i];
+        target[i] = kept++;
+    }
+    for (unsigned lane = 0; lane < lanes; lane++)
+        group[lane] = target[group[lane]];
+
+    unsigned removed = groups - kept;
+    merges += removed;
+    groups = kept;
+
+    free(state);
+    free(hash);
+    free(target);
+    return removed;
+}
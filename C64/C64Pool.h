@@ -0,0 +1,205 @@
+/*!
+ * @header      C64Pool.h
+ * @author      Dirk W. Hoffmann, www.dirkwhoffmann.de
+ * @brief       Declares C64Pool class
+ */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _C64POOL_INC
+#define _C64POOL_INC
+
+#include "VC64Object.h"
+#include "ThreadPlacement.h"
+
+class C64;
+
+//! @brief    Keyboard and joystick input of a machine
+typedef struct {
+
+    //! @brief    Pressed keys. Bit 8 * row + col is set if the key is pressed.
+    uint64_t keys;
+
+    //! @brief    Joystick state of both control ports
+    /*! @details  Bit 0 = up, bit 1 = down, bit 2 = left, bit 3 = right, bit 4 = fire
+     */
+    uint8_t joystick[2];
+
+} C64Input;
+
+//! @brief    Compares two lane inputs
+inline bool sameInput(const C64Input &a, const C64Input &b) {
+    return a.keys == b.keys && a.joystick[0] == b.joystick[0] && a.joystick[1] == b.joystick[1];
+}
+
+/*! @class    C64Pool
+ *  @brief    Pool of machines advancing in lockstep with individual inputs
+ *  @details  A pool consists of a fixed number of lanes. All lanes start in the same state
+ *            and advance frame by frame in lockstep. Each lane has its own input.
+ *            Lanes that have seen the same inputs so far are in the same state. Hence,
+ *            they are grouped and each group is emulated by a single machine. When the
+ *            inputs of the lanes in a group diverge, the group is split by cloning its
+ *            machine via the snapshot mechanism. Groups that have reconverged can be
+ *            merged again with merge(). The groups are distributed among multiple threads.
+ *            Each machine is an ordinary scalar emulator. The pool saves work only while
+ *            lanes share their input history. Lanes with diverging inputs cost as much as
+ *            the same number of independent machines.
+ *  @note     The machines are run in warp mode without auto-snapshots. Configuration
+ *            items that are not part of snapshots (e.g., audio settings) are not copied
+ *            from the prototype.
+ */
+class C64Pool : public VC64Object {
+
+private:
+
+    //! @brief    Number of lanes
+    unsigned lanes;
+
+    //! @brief    Requested input of each lane
+    C64Input *input;
+
+    //! @brief    Group each lane belongs to
+    unsigned *group;
+
+    //! @brief    Machine emulating each group
+    C64 **machine;
+
+    //! @brief    Input that has been applied to the machine of each group
+    C64Input *groupInput;
+
+    //! @brief    Number of groups and their storage capacity
+    unsigned groups;
+    unsigned capacity;
+
+    //! @brief    Number of worker threads (0 = one per core)
+    unsigned threads;
+
+    //! @brief    Indicates that the workers are placed according to workerPolicy
+    bool placeWorkers;
+
+    //! @brief    Placement policy of the worker threads
+    ThreadPolicy workerPolicy;
+
+    //! @brief    Indicates that co-operating workers are placed on SMT siblings first
+    bool workerSiblings;
+
+    //! @brief    Number of emulated frames
+    uint64_t frames;
+
+    //! @brief    Statistics
+    uint64_t splits;
+    uint64_t merges;
+
+public:
+
+    //! @brief    Creates a pool whose lanes start in the state of the prototype
+    C64Pool(C64 *prototype, unsigned lanes);
+
+    //! @brief    Destructor
+    ~C64Pool();
+
+
+    //
+    //! @functiongroup Configuring the pool
+    //
+
+    //! @brief    Returns the number of lanes
+    unsigned numLanes() { return lanes; }
+
+    //! @brief    Sets the number of worker threads (0 = one per core)
+    void setThreads(unsigned value) { threads = value; }
+
+    /*! @brief    Places the worker threads
+     *  @details  Each worker is pinned to a single processor of the policy's set and gets the
+     *            policy's scheduling class and priority (see ThreadPlacement::policyForThread()).
+     *  @param    siblings  Fill the SMT siblings of a core before using the next core
+     */
+    void setWorkerPolicy(const ThreadPolicy &policy, bool siblings) {
+        placeWorkers = true; workerPolicy = policy; workerSiblings = siblings; }
+
+    //! @brief    Places a worker thread (called by the worker threads)
+    void placeWorker(unsigned nr);
+
+
+    //
+    //! @functiongroup Running the pool
+    //
+
+    //! @brief    Sets the input of a lane. It takes effect with the next frame.
+    void setInput(unsigned lane, const C64Input &value);
+
+    //! @brief    Returns the input of a lane
+    C64Input getInput(unsigned lane) { assert(lane < lanes); return input[lane]; }
+
+    /*! @brief    Emulates the specified number of frames in all lanes
+     *  @details  Groups are split according to the current inputs first.
+     */
+    void executeFrames(unsigned count = 1);
+
+    /*! @brief    Merges groups whose machines are in identical states
+     *  @details  Compares the snapshots of all machines. The check is costly and should
+     *            be called only once in a while.
+     *  @return   The number of removed groups
+     */
+    unsigned merge();
+
+
+    //
+    //! @functiongroup Examining the pool
+    //
+
+    //! @brief    Returns the number of emulated frames
+    uint64_t getFrames() { return frames; }
+
+    //! @brief    Returns the number of groups (i.e., emulated machines)
+    unsigned numGroups() { return groups; }
+
+    //! @brief    Returns the group of a lane
+    unsigned getGroup(unsigned lane) { assert(lane < lanes); return group[lane]; }
+
+    /*! @brief    Returns the machine emulating a lane
+     *  @details  The machine is shared with all other lanes of the same group and must
+     *            not be modified.
+     */
+    C64 *getMachine(unsigned lane) { assert(lane < lanes); return machine[group[lane]]; }
+
+    //! @brief    Returns the number of group splits and merges so far
+    uint64_t getSplits() { return splits; }
+    uint64_t getMerges() { return merges; }
+
+    //! @brief    Emulates frames of a single group (called by the worker threads)
+    void executeGroup(unsigned nr, unsigned count);
+
+    //! @brief    Makes a machine see the specified input
+    static void applyInput(C64 *c64, const C64Input &value);
+
+    /*! @brief    Emulates the specified number of frames on a single machine
+     *  @details  The machine keeps running if the CPU jams or hits a breakpoint.
+     */
+    static void executeFrames(C64 *c64, unsigned count);
+
+private:
+
+    //! @brief    Creates a machine in the state of another one
+    C64 *clone(C64 *original);
+
+    //! @brief    Adds a group and returns its number
+    unsigned addGroup(C64 *c64, const C64Input &value);
+
+    //! @brief    Splits all groups whose lanes have diverging inputs
+    void split();
+};
+
+#endif
@@ -11,6 +11,7 @@
 #include "Cartridge_types.h"
 #include "ControlPort_types.h"
 #include "Mouse_types.h"
+#include "VIC_globals.h"
 
 /*! @brief    Color schemes
  *  @details  Predefined RGB color values
@@ -30,6 +31,51 @@ typedef enum {
     GRAYSCALE       = 0x0B
 } ColorScheme;
 
+/*! @brief    Raster time accounting of a single rasterline
+ *  @details  Stolen cycles are the cycles with the BA line pulled down. The CPU may still
+ *            complete up to three write cycles in the beginning of such a phase.
+ */
+typedef struct {
+    
+    //! @brief    Cycles stolen by the VIC for fetching character pointers (bad line)
+    uint8_t badLineCycles;
+    
+    //! @brief    Cycles stolen by the VIC for fetching sprite data
+    uint8_t spriteDmaCycles;
+    
+    //! @brief    Cycles the CPU spent inside an IRQ or NMI handler
+    uint8_t interruptCycles;
+    
+    //! @brief    Cycles the CPU spent parked in a detected idle loop (requires idle loop detection)
+    uint8_t idleLoopCycles;
+    
+} RasterlineTiming;
+
+/*! @brief    Raster time accounting of a complete frame
+ *  @details  Recorded by the C64 if raster time accounting is enabled.
+ */
+typedef struct {
+    
+    //! @brief    Frame number as reported by the C64
+    uint64_t frame;
+    
+    //! @brief    Number of recorded rasterlines
+    uint16_t rasterlines;
+    
+    //! @brief    Total number of cycles of the frame
+    uint32_t cycles;
+    
+    //! @brief    Frame totals of the per-line counters
+    uint32_t badLineCycles;
+    uint32_t spriteDmaCycles;
+    uint32_t interruptCycles;
+    uint32_t idleLoopCycles;
+    
+    //! @brief    Per-line counters
+    RasterlineTiming line[PAL_HEIGHT];
+    
+} FrameTiming;
+
 /*! @brief    Message types
  *  @details  List of all possible message id's
  */
@@ -23,9 +23,6 @@ CPU::CPU()
 	setDescription("CPU");
 	debug(3, "  Creating CPU at address %p...\n", this);
 	
-    // Chip model
-    chipModel = MOS_6510;
-
 	// Establish callback for each instruction
 	registerInstructions();
 		
@@ -33,14 +30,27 @@ CPU::CPU()
 	for (int i = 0; i <  65536; i++) {
 		breakpoint[i] = NO_BREAKPOINT;	
 	}
+    errorAddr = 0;
+    coverage = NULL;
+    
+    // Idle loop detection is switched on by the owner of the CPU
+    idleLoopState = IDLE_LOOP_DISABLED;
+    idleLoopRejected = 0;
+    idleLoopRetryDelay = 0;
+    idleLoopLength = 0;
+    idleLoopPhase = 0;
+    idleLoopPolls = 0;
+    idleLoopStores = 0;
+    idleLoopCycles = 0;
+    
+    interruptDepth = 0;
+    interruptEnteredAt = 0;
+    interruptCycles = 0;
     
     // Register snapshot items
     SnapshotItem items[] = {
         
-        // Lifetime items
-        { &chipModel,               sizeof(chipModel), KEEP_ON_RESET },
-
-         // Internal state
+        // Internal state
         { &A,                       sizeof(A),                      CLEAR_ON_RESET },
         { &X,                       sizeof(X),                      CLEAR_ON_RESET },
         { &Y,                       sizeof(Y),                      CLEAR_ON_RESET },
@@ -92,6 +102,34 @@ CPU::reset()
     B = 1;
 	rdyLine = true;
 	next = fetch;
+    
+    if (idleLoopState != IDLE_LOOP_DISABLED)
+        idleLoopState = IDLE_LOOP_SEARCHING;
+    idleLoopRetryDelay = 0;
+    interruptDepth = 0;
+}
+
+void
+CPU::loadFromBuffer(uint8_t **buffer)
+{
+    VirtualComponent::loadFromBuffer(buffer);
+    
+    // Snapshots never contain a parked CPU
+    if (idleLoopState != IDLE_LOOP_DISABLED)
+        idleLoopState = IDLE_LOOP_SEARCHING;
+    idleLoopRetryDelay = 0;
+    
+    // The interrupt nesting is not part of the snapshot
+    interruptDepth = 0;
+}
+
+void
+CPU::saveToBuffer(uint8_t **buffer)
+{
+    // Materialize the processor state if the CPU is parked in an idle loop
+    leaveIdleLoop();
+    
+    VirtualComponent::saveToBuffer(buffer);
 }
 
 void 
@@ -114,13 +152,108 @@ CPU::dumpState()
     msg("      Irq line : %02X\n", irqLine);
     msg("Level detector : %02X\n", read8_delayed(levelDetector));
     msg("         doIrq : %s\n", doIrq ? "yes" : "no");
-	msg("   IRQ routine : %02X%02X\n", mem->spy(0xFFFF), mem->spy(0xFFFE));
-	msg("   NMI routine : %02X%02X\n", mem->spy(0xFFFB), mem->spy(0xFFFA));
+	msg("   IRQ routine : %02X%02X\n", spy(0xFFFF), spy(0xFFFE));
+	msg("   NMI routine : %02X%02X\n", spy(0xFFFB), spy(0xFFFA));
+    msg("     Idle loop : %s", idleLoopState == IDLE_LOOP_PARKED ? "parked" : "no");
+    if (idleLoopState == IDLE_LOOP_PARKED)
+        msg(" (%04X - %04X, %d cycles)", idleLoopHead, idleLoopTail, idleLoopLength);
+    msg("\n");
+    msg(" Parked cycles : %llu\n", idleLoopCycles);
 	msg("\n");
-    
+}
+
+template <> void
+CPUImpl<C64Memory>::dumpState()
+{
+    CPU::dumpState();
     c64->processorPort.dumpState();
 }
 
+template <> CPUChipModel
+CPUImpl<C64Memory>::getChipModel()
+{
+    return MOS_6510;
+}
+
+template <> CPUChipModel
+CPUImpl<VC1541Memory>::getChipModel()
+{
+    return MOS_6502;
+}
+
+template <> bool
+CPUImpl<C64Memory>::executeTrap()
+{
+    return c64->datasette.executeTrap();
+}
+
+template <> bool
+CPUImpl<C64Memory>::canAccelerate()
+{
+    // Interrupts and instructions observed by the debugger run at normal speed
+    if (!rdyLine || doIrq || doNmi || breakpoint[PC] || tracingEnabled())
+        return false;
+    
+    // The idle loop detector may park the CPU when the loop head is fetched
+    if (idleLoopState == IDLE_LOOP_RECORDING && PC == idleLoopHead)
+        return false;
+    
+    uint8_t op = mem->spy(PC);
+    uint8_t lo = mem->spy(PC + 1);
+    uint8_t hi = mem->spy(PC + 2);
+    uint16_t base, addr;
+    
+    // Single byte instructions perform a dummy read of the following byte
+    if (actionFunc[op] == JAM || !mem->isFast(PC) || !mem->isFast(PC + 1) ||
+        (getLengthOfInstruction(op) == 3 && !mem->isFast(PC + 2)))
+        return false;
+    
+    // Zero page and stack accesses always stay inside the CPU's memory
+    switch (addressingMode[op]) {
+            
+        case ADDR_ABSOLUTE:
+        case ADDR_INDIRECT:
+            
+            return mem->isFast(LO_HI(lo, hi));
+            
+        case ADDR_ABSOLUTE_X:
+        case ADDR_ABSOLUTE_Y:
+            
+            // Crossing a page boundary causes a dummy read from the unfixed address
+            base = LO_HI(lo, hi);
+            addr = base + (addressingMode[op] == ADDR_ABSOLUTE_X ? X : Y);
+            return mem->isFast(addr) && mem->isFast(LO_HI(LO_BYTE(addr), HI_BYTE(base)));
+            
+        case ADDR_INDIRECT_X:
+            
+            addr = LO_HI(mem->spy((uint8_t)(lo + X)), mem->spy((uint8_t)(lo + X + 1)));
+            return mem->isFast(addr);
+            
+        case ADDR_INDIRECT_Y:
+            
+            base = LO_HI(mem->spy(lo), mem->spy((uint8_t)(lo + 1)));
+            addr = base + Y;
+            return mem->isFast(addr) && mem->isFast(LO_HI(LO_BYTE(addr), HI_BYTE(base)));
+            
+        case ADDR_RELATIVE:
+            
+            // A taken branch reads from the following instruction and the branch target
+            base = PC + 2;
+            addr = base + (int8_t)lo;
+            return mem->isFast(base) && mem->isFast(addr) &&
+            mem->isFast(LO_HI(LO_BYTE(addr), HI_BYTE(base)));
+            
+        case ADDR_IMPLIED:
+            
+            // BRK reads the interrupt vector
+            return op != 0x00 || mem->isFast(0xFFFE);
+            
+        default:
+            
+            return true;
+    }
+}
+
 void
 CPU::pullDownNmiLine(InterruptSource bit)
 {
@@ -155,6 +288,26 @@ CPU::releaseIrqLine(InterruptSource source)
     write8_delayed(levelDetector, irqLine);
 }
 
+void
+CPU::enterInterrupt()
+{
+    if (interruptDepth++ == 0)
+        interruptEnteredAt = c64->cycle;
+}
+
+void
+CPU::leaveInterrupt()
+{
+    if (interruptDepth && --interruptDepth == 0)
+        interruptCycles += c64->cycle - interruptEnteredAt;
+}
+
+uint64_t
+CPU::getInterruptCycles()
+{
+    return interruptCycles + (interruptDepth ? c64->cycle - interruptEnteredAt : 0);
+}
+
 void
 CPU::setRDY(bool value)
 {
@@ -170,6 +323,107 @@ CPU::setRDY(bool value)
     }
 }
 
+void
+CPU::setIdleLoopDetection(bool enable)
+{
+    if (!enable) {
+        leaveIdleLoop();
+        idleLoopState = IDLE_LOOP_DISABLED;
+    } else if (idleLoopState == IDLE_LOOP_DISABLED) {
+        idleLoopState = IDLE_LOOP_SEARCHING;
+        idleLoopRetryDelay = 0;
+    }
+}
+
+void
+CPU::leaveIdleLoop()
+{
+    switch (idleLoopState) {
+            
+        case IDLE_LOOP_PARKED:
+            
+            restoreIdleLoopCycle(idleLoopTrace[idleLoopPhase]);
+            
+            // Don't try to park again before the next iteration has been executed
+            rejectIdleLoop(1);
+            break;
+            
+        case IDLE_LOOP_RECORDING:
+            
+            idleLoopState = IDLE_LOOP_SEARCHING;
+            break;
+            
+        default:
+            break;
+    }
+}
+
+void
+CPU::rejectIdleLoop(uint8_t delay)
+{
+    idleLoopState = IDLE_LOOP_SEARCHING;
+    idleLoopRejected = idleLoopHead;
+    idleLoopRetryDelay = delay;
+}
+
+void
+CPU::saveIdleLoopCycle(IdleLoopCycle &cycle)
+{
+    cycle.next = next;
+    cycle.PC = PC;
+    cycle.PC_at_cycle_0 = PC_at_cycle_0;
+    cycle.A = A;
+    cycle.X = X;
+    cycle.Y = Y;
+    cycle.SP = SP;
+    cycle.N = N;
+    cycle.V = V;
+    cycle.B = B;
+    cycle.D = D;
+    cycle.I = I;
+    cycle.Z = Z;
+    cycle.C = C;
+    cycle.opcode = opcode;
+    cycle.addr_lo = addr_lo;
+    cycle.addr_hi = addr_hi;
+    cycle.ptr = ptr;
+    cycle.pc_lo = pc_lo;
+    cycle.pc_hi = pc_hi;
+    cycle.data = data;
+    cycle.overflow = overflow;
+    cycle.doNmi = doNmi;
+    cycle.doIrq = doIrq;
+}
+
+void
+CPU::restoreIdleLoopCycle(const IdleLoopCycle &cycle)
+{
+    next = cycle.next;
+    PC = cycle.PC;
+    PC_at_cycle_0 = cycle.PC_at_cycle_0;
+    A = cycle.A;
+    X = cycle.X;
+    Y = cycle.Y;
+    SP = cycle.SP;
+    N = cycle.N;
+    V = cycle.V;
+    B = cycle.B;
+    D = cycle.D;
+    I = cycle.I;
+    Z = cycle.Z;
+    C = cycle.C;
+    opcode = cycle.opcode;
+    addr_lo = cycle.addr_lo;
+    addr_hi = cycle.addr_hi;
+    ptr = cycle.ptr;
+    pc_lo = cycle.pc_lo;
+    pc_hi = cycle.pc_hi;
+    data = cycle.data;
+    overflow = cycle.overflow;
+    doNmi = cycle.doNmi;
+    doIrq = cycle.doIrq;
+}
+
 // Instruction set
 const char 
 *CPU::getMnemonic(uint8_t opcode)
@@ -214,7 +468,7 @@ CPU::disassemble(uint16_t addr, bool hex)
     DisassembledInstruction instr;
         
     // Get opcode
-    uint8_t opcode = mem->spy(addr);
+    uint8_t opcode = spy(addr);
     instr.addr = addr; 
     instr.size = getLengthOfInstruction(opcode);
     
@@ -228,7 +482,7 @@ CPU::disassemble(uint16_t addr, bool hex)
         case ADDR_ZERO_PAGE_Y:
         case ADDR_INDIRECT_X:
         case ADDR_INDIRECT_Y: {
-            uint8_t value = mem->spy(addr+1);
+            uint8_t value = spy(addr+1);
             hex ? sprint8x(operand, value) : sprint8d(operand, value);
             break;
         }
@@ -237,12 +491,12 @@ CPU::disassemble(uint16_t addr, bool hex)
         case ADDR_ABSOLUTE:
         case ADDR_ABSOLUTE_X:
         case ADDR_ABSOLUTE_Y: {
-            uint16_t value = LO_HI(mem->spy(addr+1),mem->spy(addr+2));
+            uint16_t value = LO_HI(spy(addr+1),spy(addr+2));
             hex ? sprint16x(operand, value) : sprint16d(operand, value);
             break;
         }
         case ADDR_RELATIVE: {
-            uint16_t value = addr + 2 + (int8_t)mem->spy(addr+1);
+            uint16_t value = addr + 2 + (int8_t)spy(addr+1);
             hex ? sprint16x(operand, value) : sprint16d(operand, value);
             break;
         }
@@ -317,19 +571,19 @@ CPU::disassemble(uint16_t addr, bool hex)
 
     // Convert memory contents to strings
     if (instr.size >= 1) {
-        uint8_t byte = mem->spy(addr);
+        uint8_t byte = spy(addr);
         hex ? sprint8x(instr.byte1, byte) : sprint8d(instr.byte1, byte);
     } else {
         hex ? strcpy(instr.byte1, "  ") : strcpy(instr.byte1, "   ");
     }
     if (instr.size >= 2) {
-        uint8_t byte = mem->spy(addr + 1);
+        uint8_t byte = spy(addr + 1);
         hex ? sprint8x(instr.byte2, byte) : sprint8d(instr.byte2, byte);
     } else {
         hex ? strcpy(instr.byte2, "  ") : strcpy(instr.byte2, "   ");
     }
     if (instr.size >= 3) {
-        uint8_t byte = mem->spy(addr + 2);
+        uint8_t byte = spy(addr + 2);
         hex ? sprint8x(instr.byte3, byte) : sprint8d(instr.byte3, byte);
     } else {
         hex ? strcpy(instr.byte3, "  ") : strcpy(instr.byte3, "   ");
@@ -355,7 +609,12 @@ CPU::setErrorState(ErrorState state)
 	if (errorState == state)
         return;
 
+    // A jammed CPU keeps its state until it is cleared, even if a breakpoint is hit
+    if (errorState == CPU_ILLEGAL_INSTRUCTION && state != CPU_OK)
+        return;
+
     errorState = state;
+    errorAddr = PC_at_cycle_0;
     
     switch (errorState) {
         case CPU_OK:
@@ -375,4 +634,38 @@ CPU::setErrorState(ErrorState state)
     }
 }
 
+void
+CPU::startCoverage(uint8_t *map)
+{
+    assert(map != NULL);
+    
+    coverage = map;
+    memset(coverage, 0, COVERAGE_MAP_SIZE);
+    for (unsigned i = 0; i < 65536; i++)
+        breakpoint[i] |= COVERAGE;
+}
+
+void
+CPU::stopCoverage()
+{
+    for (unsigned i = 0; i < 65536; i++)
+        breakpoint[i] &= ~COVERAGE;
+    coverage = NULL;
+}
 
+void
+CPU::clearCoverage()
+{
+    if (coverage == NULL)
+        return;
+    
+    for (unsigned i = 0; i < COVERAGE_MAP_SIZE; i++) {
+        if (coverage[i] == 0)
+            continue;
+        for (unsigned j = 0; j < 8; j++) {
+            if (coverage[i] & (1 << j))
+                breakpoint[8 * i + j] |= COVERAGE;
+        }
+        coverage[i] = 0;
+    }
+}
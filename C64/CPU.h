@@ -24,7 +24,15 @@
 #include "CPU_types.h"
 #include "Memory.h"
 
-/*! @class  The virtual 6502 / 6510 processor
+// Forward declarations
+class C64Memory;
+class VC1541Memory;
+
+/*! @class    The virtual 6502 / 6510 processor
+ *  @details  This class contains everything that is independent of the connected memory,
+ *            i.e., the register set, the interrupt logic, the instruction tables, and the
+ *            debugger interface. The micro instructions are executed by CPUImpl which binds
+ *            the CPU statically to a concrete memory implementation.
  */
 class CPU : public VirtualComponent {
 
@@ -60,17 +68,7 @@ public:
         KEYBOARD = 0x10
     } InterruptSource;
 
-	//! @brief    Reference to the connected virtual memory
-	Memory *mem;
-
-    /*! @brief    Selected chip model
-     *  @details  Right now, this atrribute is only used to distinguish the C64 CPU (MOS6510)
-     *            from the VC1541 CPU (MOS6502). Hardware differences between both models
-     *            are not emulated.
-     */
-    CPUChipModel chipModel;
-
-private:
+protected:
     
 	//! @brief    Accumulator
 	uint8_t A;
@@ -212,11 +210,121 @@ private:
 	//! @brief    Current error state
 	ErrorState errorState;
     
+    //! @brief    Address of the instruction that has caused the current error state
+    uint16_t errorAddr;
+    
 	//! @brief    Breakpoint tag for each memory cell
 	uint8_t breakpoint[65536];
+    
+    /*! @brief    Bitmap of fetched opcode addresses (NULL = not recording)
+     *  @details  Bit (addr & 7) of byte (addr >> 3) is set when an opcode is fetched from addr.
+     */
+    uint8_t *coverage;
 	
 #include "Instructions.h"
-		
+    
+    //! @brief    Maximum distance between the first and the last instruction of an idle loop
+    static const unsigned MAX_IDLE_LOOP_BYTES = 24;
+    
+    //! @brief    Maximum number of cycles of a single idle loop iteration
+    static const unsigned MAX_IDLE_LOOP_CYCLES = 32;
+    
+    //! @brief    Maximum number of I/O registers polled and RAM cells written by an idle loop
+    static const unsigned MAX_IDLE_LOOP_ACCESSES = 4;
+    
+    //! @brief    Processor state at the beginning of a single cycle of an idle loop iteration
+    typedef struct {
+        MicroInstruction next;
+        uint16_t PC, PC_at_cycle_0;
+        uint8_t A, X, Y, SP;
+        uint8_t N, V, B, D, I, Z, C;
+        uint8_t opcode, addr_lo, addr_hi, ptr, pc_lo, pc_hi, data;
+        bool overflow, doNmi, doIrq;
+    } IdleLoopCycle;
+    
+    /*! @brief    Current state of the idle loop detector
+     *  @details  An idle loop is a short loop that does not change any observable state, e.g.,
+     *            "JMP *" or "LDA $D012 : CMP #$80 : BNE *-5". Such a loop is recorded for a
+     *            single iteration and parked afterwards. While parked, no micro instruction is
+     *            executed. The CPU only keeps track of its position inside the loop and leaves
+     *            the loop in exactly that state when an event occurs that may change its
+     *            outcome (an interrupt, a changing I/O register, or RDY pulled low on a write).
+     */
+    IdleLoopState idleLoopState;
+    
+    //! @brief    Address of the first instruction of the recorded or parked loop
+    uint16_t idleLoopHead;
+    
+    //! @brief    Address of the last instruction (the backward jump) of the recorded or parked loop
+    uint16_t idleLoopTail;
+    
+    //! @brief    Most recently rejected loop head
+    uint16_t idleLoopRejected;
+    
+    //! @brief    Number of backward jumps to idleLoopRejected to ignore before trying again
+    uint8_t idleLoopRetryDelay;
+    
+    //! @brief    Processor state at each cycle of the recorded loop iteration
+    IdleLoopCycle idleLoopTrace[MAX_IDLE_LOOP_CYCLES];
+    
+    //! @brief    Number of cycles of a single loop iteration
+    unsigned idleLoopLength;
+    
+    //! @brief    Position of the parked CPU inside the loop iteration
+    unsigned idleLoopPhase;
+    
+    //! @brief    I/O registers polled by the loop and the values seen while recording
+    uint16_t idleLoopPollAddr[MAX_IDLE_LOOP_ACCESSES];
+    uint8_t idleLoopPollValue[MAX_IDLE_LOOP_ACCESSES];
+    unsigned idleLoopPolls;
+    
+    //! @brief    RAM cells written by the loop and their values before recording
+    uint16_t idleLoopStoreAddr[MAX_IDLE_LOOP_ACCESSES];
+    uint8_t idleLoopStoreValue[MAX_IDLE_LOOP_ACCESSES];
+    unsigned idleLoopStores;
+    
+    //! @brief    Total number of cycles spent in parked idle loops (not stalled by RDY)
+    uint64_t idleLoopCycles;
+    
+    //! @brief    Saves the current processor state into a trace entry
+    void saveIdleLoopCycle(IdleLoopCycle &cycle);
+    
+    //! @brief    Restores the processor state from a trace entry
+    void restoreIdleLoopCycle(const IdleLoopCycle &cycle);
+    
+    /*! @brief    Marks the current loop head as rejected
+     *  @param    delay  Number of backward jumps to this head that are ignored
+     */
+    void rejectIdleLoop(uint8_t delay);
+    
+    /*! @brief    Returns true if an interrupt may be recognized in the current cycle
+     *  @details  The check is conservative. It only looks at the interrupt lines and detectors.
+     */
+    bool idleLoopInterrupted();
+    
+    
+    //
+    // Interrupt time accounting
+    //
+    
+    /*! @brief    Number of nested interrupt handlers the CPU is currently executing
+     *  @details  The counter is increased when an IRQ or NMI is taken and decreased by RTI.
+     *            Handlers that are left by other means are only detected at the next RTI.
+     */
+    uint8_t interruptDepth;
+    
+    //! @brief    Cycle in which the outermost interrupt handler has been entered
+    uint64_t interruptEnteredAt;
+    
+    //! @brief    Total number of cycles spent in completed interrupt handlers
+    uint64_t interruptCycles;
+    
+    //! @brief    Records the begin of an interrupt handler
+    void enterInterrupt();
+    
+    //! @brief    Records the end of an interrupt handler (RTI)
+    void leaveInterrupt();
+    
 public:
 
 	//! @brief    Constructor
@@ -231,8 +339,16 @@ public:
 	//! @brief    Prints debugging information.
 	void dumpState();	
 
-    //! @brief    Returns true iff this object is the C64 CPU (for debugging, only).
-    bool isC64CPU() { return strcmp(getDescription(), "CPU") == 0; /* VC1541 CPU is calles "1541CPU" */ }
+    //! @brief    Loads the internal state from a snapshot buffer
+    void loadFromBuffer(uint8_t **buffer);
+    
+    //! @brief    Saves the internal state into a snapshot buffer
+    void saveToBuffer(uint8_t **buffer);
+    
+    /*! @brief    Reads a byte from the connected memory without causing side effects
+     *  @details  This function is used by the debugger, only.
+     */
+    virtual uint8_t spy(uint16_t addr) = 0;
 
     
     //
@@ -249,7 +365,7 @@ public:
     uint8_t getY() { return Y; }
 
     //! @brief    Initialize PC with its start up value.
-    void initPC() { PC = LO_HI(mem->spy(0xFFFC), mem->spy(0xFFFD)); }
+    void initPC() { PC = LO_HI(spy(0xFFFC), spy(0xFFFD)); }
 
 	//! @brief    Returns current value of the program counter.
     uint16_t getPC() { return PC; }
@@ -370,9 +486,6 @@ public:
     
 	//! @brief    Loads the stack register. The Z- and N-flag may change.
     void loadSP(uint8_t s) { SP = s; N = s & 128; Z = (s == 0); }
-    
-	//! @brief    Loads a value into memory. The Z- and N-flag may change.
-    void loadM(uint16_t addr, uint8_t s) { mem->poke(addr, s); N = s & 128; Z = (s == 0); }
 
     
     //
@@ -399,8 +512,19 @@ public:
      */
     void releaseIrqLine(InterruptSource source);
     
+    //! @brief    Returns the sources holding down the IRQ line (0 = line is high)
+    uint8_t getIrqLine() { return irqLine; }
+    
+	//! @brief    Returns the RDY line.
+    bool getRDY() { return rdyLine; }
+    
 	//! @brief    Sets the RDY line.
     void setRDY(bool value);
+    
+    /*! @brief    Returns the total number of cycles spent inside interrupt handlers
+     *  @details  Includes the elapsed cycles of the currently running handler.
+     */
+    uint64_t getInterruptCycles();
 		
     
     //
@@ -421,7 +545,7 @@ public:
 	/*! @brief    Returns the length in bytes of the instruction with the specified address.
      *  @result   Integer value between 1 and 3.
      */
-    int getLengthOfInstructionAtAddress(uint16_t addr) { return getLengthOfInstruction(mem->spy(addr)); }
+    int getLengthOfInstructionAtAddress(uint16_t addr) { return getLengthOfInstruction(spy(addr)); }
     
 	/*! @brief    Returns the length in bytes of the next instruction to execute.
      *  @result   Integer value between 1 and 3.
@@ -450,15 +574,15 @@ public:
     //! @functiongroup Executing the device
     //
     
-	/*! @brief    Executes the next micro instruction.
-	 *  @return   true, if the micro instruction was processed successfully.
-     *            false, if the CPU was halted, e.g., by reaching a breakpoint
-     */
-    bool executeOneCycle();
-    
 	//! @brief    Returns the current error state.
     ErrorState getErrorState() { return errorState; }
     
+    /*! @brief    Returns the address of the instruction that has caused the error state
+     *  @details  A JAM opcode does not stop the emulation. Hence, the program counter has
+     *            usually moved on when the error state is examined.
+     */
+    uint16_t getErrorAddr() { return errorAddr; }
+    
 	//! @brief    Sets the error state.
     void setErrorState(ErrorState state);
     
@@ -466,6 +590,32 @@ public:
     void clearErrorState() { setErrorState(CPU_OK); }
     
     
+    
+    //
+    //! @functiongroup Detecting idle loops
+    //
+    
+    //! @brief    Returns true iff idle loops are detected and skipped
+    bool getIdleLoopDetection() { return idleLoopState != IDLE_LOOP_DISABLED; }
+    
+    /*! @brief    Enables or disables idle loop detection
+     *  @details  A parked loop is left before the detector is switched off.
+     */
+    void setIdleLoopDetection(bool enable);
+    
+    //! @brief    Returns true iff the CPU is currently parked in an idle loop
+    bool inIdleLoop() { return idleLoopState == IDLE_LOOP_PARKED; }
+    
+    /*! @brief    Leaves a parked idle loop
+     *  @details  The processor state is restored to exactly the state the CPU would have if
+     *            the loop had been executed all the time.
+     */
+    void leaveIdleLoop();
+    
+    //! @brief    Returns the total number of cycles spent in parked idle loops
+    uint64_t getIdleLoopCycles() { return idleLoopCycles; }
+    
+    
     //
     //! @functiongroup Handling breakpoints
     //
@@ -493,6 +643,155 @@ public:
     
 	//! @brief    Sets or deletes a hard breakpoint at the specified address.
 	void toggleSoftBreakpoint(uint16_t addr) { breakpoint[addr] ^= SOFT_BREAKPOINT; }
+
+    /*! @brief    Removes all hard and soft breakpoints and stores them in a buffer (64 KB)
+     *  @details  Traps stay installed. Used by the reverse debugger to re-execute code
+     *            without stopping or consuming soft breakpoints.
+     */
+    void suspendBreakpoints(uint8_t *buffer) {
+        memcpy(buffer, breakpoint, sizeof(breakpoint));
+        for (unsigned i = 0; i < 65536; i++) breakpoint[i] &= TRAP; }
+
+    //! @brief    Reinstalls the breakpoints stored by suspendBreakpoints()
+    void resumeBreakpoints(const uint8_t *buffer) { memcpy(breakpoint, buffer, sizeof(breakpoint)); }
+
+    
+    //
+    //! @functiongroup Recording code coverage
+    //
+    
+    //! @brief    Size of a coverage map in bytes
+    static const unsigned COVERAGE_MAP_SIZE = 65536 / 8;
+    
+    /*! @brief    Starts recording the addresses of fetched opcodes
+     *  @details  Each memory cell is tagged with COVERAGE. The tag is deleted when the address
+     *            is recorded. Hence, each address costs a single bit test in the fetch cycle and
+     *            code that has been recorded once runs at full speed (including turbo mode).
+     *  @param    map  Bitmap of COVERAGE_MAP_SIZE bytes. It is cleared and owned by the caller.
+     */
+    void startCoverage(uint8_t *map);
+    
+    //! @brief    Stops recording and removes all coverage tags
+    void stopCoverage();
+    
+    /*! @brief    Clears the coverage map
+     *  @details  Only the recorded addresses are tagged again, so the costs depend on the size
+     *            of the executed code, not on the size of the address space.
+     */
+    void clearCoverage();
+    
+    //! @brief    Returns true while the addresses of fetched opcodes are recorded
+    bool recordsCoverage() { return coverage != NULL; }
+
+    
+    //
+    //! @functiongroup Handling traps
+    //
+    
+    //! @brief    Returns true iff a trap is installed at the specified address
+    bool trap(uint16_t addr) { return (breakpoint[addr] & TRAP) != 0; }
+    
+    /*! @brief    Installs a trap at the specified address
+     *  @details  Before the opcode at this address is fetched, the trap handler of the
+     *            connected machine is called. It may replace the code by modifying
+     *            registers and memory.
+     */
+    void setTrap(uint16_t addr) { breakpoint[addr] |= TRAP; }
+    
+    //! @brief    Removes the trap at the specified address
+    void deleteTrap(uint16_t addr) { breakpoint[addr] &= (0xFF - TRAP); }
+};
+
+
+/*! @class    A virtual CPU bound to a specific memory implementation
+ *  @details  The memory type is a template parameter. Hence, all peek and poke operations
+ *            issued by the micro instructions are resolved at compile time and do not go
+ *            through the virtual functions of class Memory. The C64 CPU (MOS6510) is bound to
+ *            C64Memory and the VC1541 CPU (MOS6502) is bound to VC1541Memory.
+ */
+template <class M> class CPUImpl : public CPU {
+    
+public:
+    
+    //! @brief    Reference to the connected virtual memory
+    M *mem;
+    
+    //! @brief    Prints debugging information.
+    void dumpState() { CPU::dumpState(); }
+    
+    //! @brief    Returns the emulated chip model
+    CPUChipModel getChipModel();
+    
+    uint8_t spy(uint16_t addr) { return mem->spy(addr); }
+    
+	//! @brief    Loads a value into memory. The Z- and N-flag may change.
+    void loadM(uint16_t addr, uint8_t s) { mem->poke(addr, s); N = s & 128; Z = (s == 0); }
+    
+	/*! @brief    Executes the next micro instruction.
+	 *  @return   true, if the micro instruction was processed successfully.
+     *            false, if the CPU was halted, e.g., by reaching a breakpoint
+     */
+    bool executeOneCycle();
+    
+    /*! @brief    Checks if the next instruction can be executed at turbo speed
+     *  @details  Needs to be called right before the opcode is fetched. The check succeeds if
+     *            all memory accesses of the instruction stay inside the CPU's memory (see
+     *            C64Memory::isFast()) and the instruction is neither interrupted nor observed
+     *            by the debugger.
+     */
+    bool canAccelerate() { return false; }
+    
+private:
+    
+    /*! @brief    Checks if the code between head and tail forms an idle loop candidate
+     *  @details  The check is static. It succeeds if the loop consists of side effect free
+     *            instructions only, reads RAM, ROM, or pollable I/O registers, writes to RAM
+     *            only, and ends with a backward jump to head. Polled registers and written
+     *            RAM cells are collected for the dynamic checks.
+     */
+    bool analyzeIdleLoop(uint16_t head, uint16_t tail);
+    
+    /*! @brief    Computes the effective address of a loop instruction
+     *  @return   false, if the addressing mode is not supported inside an idle loop or if
+     *            a dummy read would hit a memory cell that is not static.
+     */
+    bool idleLoopOperand(AddressingMode mode, uint8_t lo, uint8_t hi,
+                         bool xModified, bool yModified, uint16_t *addr);
+    
+    //! @brief    Starts to record a loop iteration if the loop is an idle loop candidate
+    void detectIdleLoop(uint16_t head, uint16_t tail);
+    
+    //! @brief    Records the processor state of a single cycle of a loop iteration
+    void recordIdleLoopCycle();
+    
+    //! @brief    Returns true if one of the polled I/O registers has changed its value
+    bool idleLoopPollsChanged();
+    
+    /*! @brief    Calls the trap handler for the current PC
+     *  @return   true, if the handler has replaced the code at this location
+     */
+    bool executeTrap() { return false; }
 };
 
+//! @brief    The C64 CPU (MOS6510)
+typedef CPUImpl<C64Memory> C64CPU;
+
+//! @brief    The VC1541 CPU (MOS6502)
+typedef CPUImpl<VC1541Memory> VC1541CPU;
+
+// The MOS6510 processor port is only dumped by the C64 CPU
+template <> void CPUImpl<C64Memory>::dumpState();
+template <> CPUChipModel CPUImpl<C64Memory>::getChipModel();
+template <> CPUChipModel CPUImpl<VC1541Memory>::getChipModel();
+
+// Traps are only supported by the C64 CPU
+template <> bool CPUImpl<C64Memory>::executeTrap();
+
+// Turbo mode is only supported by the C64 CPU
+template <> bool CPUImpl<C64Memory>::canAccelerate();
+
+// Both instances are explicitly instantiated in Instructions.cpp
+extern template class CPUImpl<C64Memory>;
+extern template class CPUImpl<VC1541Memory>;
+
 #endif
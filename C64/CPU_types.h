@@ -54,13 +54,30 @@ typedef enum {
  *
  *            HARD_BREAKPOINT: execution is halted
  *            SOFT_BREAKPOINT: execution is halted and the tag is deleted
+ *            TRAP:            a trap handler is called before the opcode is fetched
+ *            COVERAGE:        the address is recorded in the coverage map when the opcode
+ *                             is fetched and the tag is deleted
  */
 typedef enum {
     NO_BREAKPOINT   = 0x00,
     HARD_BREAKPOINT = 0x01,
-    SOFT_BREAKPOINT = 0x02
+    SOFT_BREAKPOINT = 0x02,
+    TRAP            = 0x04,
+    COVERAGE        = 0x08
 } Breakpoint;
 
+/*! @brief    State of the idle loop detector
+ *  @details  IDLE_LOOP_SEARCHING: The CPU watches out for short backward jumps.
+ *            IDLE_LOOP_RECORDING: A candidate loop is executed and its state is recorded cycle by cycle.
+ *            IDLE_LOOP_PARKED:    The loop has been proven to be idle and is no longer executed.
+ */
+typedef enum {
+    IDLE_LOOP_DISABLED = 0,
+    IDLE_LOOP_SEARCHING,
+    IDLE_LOOP_RECORDING,
+    IDLE_LOOP_PARKED
+} IdleLoopState;
+
 //! @brief    Disassembled instruction
 typedef struct {
     uint16_t addr; 
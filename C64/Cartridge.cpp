@@ -78,7 +78,11 @@ Cartridge::isSupportedType(CartridgeType type)
 Cartridge *
 Cartridge::makeCartridgeWithType(C64 *c64, CartridgeType type)
 {
-     assert(isSupportedType(type));
+    // The REU is not distributed as CRT file
+    if (type == CRT_REU)
+        return new REU(c64);
+    
+    assert(isSupportedType(type));
     
     switch (type) {
             
@@ -156,6 +156,21 @@ public:
     //! @brief    Poke fallthrough for I/O space 2
     virtual void pokeIO2(uint16_t addr, uint8_t value) { }
 
+    //! @brief    Returns true if the cartridge needs to see CPU writes into $FF00
+    virtual bool watchesFF00() { return false; }
+
+    //! @brief    Poke fallthrough for $FF00 (only called if watchesFF00() returns true)
+    virtual void pokeFF00(uint8_t value) { }
+
+    //! @brief    Returns true if the cartridge can pull down the DMA line
+    virtual bool hasDMA() { return false; }
+
+    //! @brief    DMA callback
+    /*! @details  This function is invoked by the expansion port in each cycle while the
+     *            cartridge pulls down the DMA line. The CPU is halted in these cycles.
+     */
+    virtual void executeDMA() { }
+
     //! @brief    Returns the cartridge type
     virtual CartridgeType getCartridgeType() { return CRT_NORMAL; }
     
@@ -97,6 +97,7 @@ typedef enum {
     CRT_RRNETMK3 = 58,
     CRT_EASYCALC = 59,
     CRT_GMOD2 = 60,
+    CRT_REU = 254,      // RAM Expansion Unit (no CRT file type)
     CRT_NONE = 255
 } CartridgeType;
 
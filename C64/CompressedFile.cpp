@@ -0,0 +1,799 @@
+/*!
+ * @file        CompressedFile.cpp
+ * @author      Dirk W. Hoffmann, www.dirkwhoffmann.de
+ * @copyright   2018 Dirk W. Hoffmann
+ */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "CompressedFile.h"
+#include <strings.h>
+
+//
+// Checksums
+//
+
+/*! @brief    CRC-32 lookup tables (polynomial 0xEDB88320, as used by gzip and zip)
+ *  @details  The additional tables let the checksum process eight bytes at a time.
+ */
+struct CrcTable {
+
+    uint32_t entry[8][256];
+
+    CrcTable() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (unsigned k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+            entry[0][i] = c;
+        }
+        for (uint32_t i = 0; i < 256; i++) {
+            for (unsigned k = 1; k < 8; k++)
+                entry[k][i] = entry[0][entry[k - 1][i] & 0xFF] ^ (entry[k - 1][i] >> 8);
+        }
+    }
+};
+
+static uint32_t
+crc32(const uint8_t *buffer, size_t length)
+{
+    static const CrcTable table;
+    const uint32_t (*t)[256] = table.entry;
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (; length >= 8; buffer += 8, length -= 8) {
+        uint32_t lo = crc ^ (buffer[0] | buffer[1] << 8 | buffer[2] << 16 | (uint32_t)buffer[3] << 24);
+        uint32_t hi = buffer[4] | buffer[5] << 8 | buffer[6] << 16 | (uint32_t)buffer[7] << 24;
+        crc =
+        t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+        t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+    }
+    for (; length > 0; buffer++, length--)
+        crc = t[0][(crc ^ *buffer) & 0xFF] ^ (crc >> 8);
+
+    return crc ^ 0xFFFFFFFF;
+}
+
+static uint16_t le16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+static uint32_t le32(const uint8_t *p) { return le16(p) | ((uint32_t)le16(p + 2) << 16); }
+
+
+//
+// Inflating (RFC 1951)
+//
+
+/*! @brief    Canonical Huffman code
+ *  @details  Codes of up to FAST_BITS bits are decoded with a single table lookup. Longer codes
+ *            are decoded bit by bit with the counts of each code length.
+ */
+struct Huffman {
+
+    static const unsigned FAST_BITS = 10;
+
+    //! @brief    Number of codes of each length
+    uint16_t count[16];
+
+    //! @brief    Symbols ordered by code
+    uint16_t symbol[288];
+
+    //! @brief    Lookup table indexed by the next FAST_BITS input bits (length << 9 | symbol)
+    uint16_t fast[1 << FAST_BITS];
+};
+
+/*! @brief    Streaming deflate decoder
+ *  @details  The compressed data is read from a file in chunks. The output is written into a
+ *            single contiguous buffer which also serves as the history window.
+ */
+class Inflater {
+
+    //! @brief    Input file and the number of compressed bytes still to read
+    FILE *file;
+    long remaining;
+
+    //! @brief    Input chunk
+    uint8_t chunk[0x10000];
+    size_t pos, len;
+
+    //! @brief    Bit buffer (LSB first) and number of valid bits
+    uint64_t bits;
+    unsigned count;
+
+    //! @brief    Number of bytes appended after the end of the input
+    unsigned overrun;
+
+    //! @brief    Huffman codes of the current block
+    Huffman lencode, distcode;
+
+public:
+
+    Inflater(FILE *file, long size) :
+    file(file), remaining(size), pos(0), len(0), bits(0), count(0), overrun(0) { }
+
+    //! @brief    Inflates up to length bytes (returns the number of inflated bytes)
+    size_t inflate(uint8_t *out, size_t length);
+
+private:
+
+    //! @brief    Reads the next byte of the compressed data
+    inline uint8_t nextByte() {
+        if (pos == len && !fill()) { overrun++; return 0; }
+        return chunk[pos++];
+    }
+
+    //! @brief    Reads the next chunk of compressed data
+    bool fill();
+
+    /*! @brief    Makes sure that the bit buffer contains at least 56 bits
+     *  @details  Inside a chunk, eight bytes are loaded at once and only the bytes that fit
+     *            completely are consumed. The remaining bits are loaded again by the next
+     *            refill at the same position, which leaves the buffer unchanged.
+     */
+    inline void refill() {
+        if (len - pos >= 8) {
+            bits |= ((uint64_t)chunk[pos] | (uint64_t)chunk[pos + 1] << 8 |
+                     (uint64_t)chunk[pos + 2] << 16 | (uint64_t)chunk[pos + 3] << 24 |
+                     (uint64_t)chunk[pos + 4] << 32 | (uint64_t)chunk[pos + 5] << 40 |
+                     (uint64_t)chunk[pos + 6] << 48 | (uint64_t)chunk[pos + 7] << 56) << count;
+            pos += (63 - count) >> 3;
+            count |= 56;
+            return;
+        }
+        while (count <= 56) { bits |= (uint64_t)nextByte() << count; count += 8; }
+    }
+
+    //! @brief    Reads n bits (n <= 32)
+    inline uint32_t getBits(unsigned n) {
+        if (count < n) refill();
+        uint32_t result = (uint32_t)(bits & ((1ULL << n) - 1));
+        bits >>= n; count -= n;
+        return result;
+    }
+
+    //! @brief    Builds a Huffman code from code lengths (returns false if over-subscribed)
+    static bool build(Huffman *h, const uint8_t *length, unsigned n);
+
+    //! @brief    Decodes a symbol (returns -1 on invalid codes)
+    int decode(const Huffman *h);
+
+    //! @brief    Reads the code lengths of a dynamic block
+    bool readDynamicCodes();
+
+    //! @brief    Inflates a stored block
+    bool stored(uint8_t *out, size_t *produced, size_t length);
+
+    //! @brief    Inflates a Huffman coded block
+    bool codes(uint8_t *out, size_t *produced, size_t length);
+};
+
+static const uint16_t lengthBase[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t lengthExtra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t distBase[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t distExtra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+bool
+Inflater::fill()
+{
+    if (remaining <= 0)
+        return false;
+
+    size_t request = MIN((size_t)remaining, sizeof(chunk));
+    len = fread(chunk, 1, request, file);
+    pos = 0;
+    remaining -= len;
+
+    if (len == 0) {
+        remaining = 0;
+        return false;
+    }
+    return true;
+}
+
+bool
+Inflater::build(Huffman *h, const uint8_t *length, unsigned n)
+{
+    uint16_t offs[16];
+
+    memset(h->count, 0, sizeof(h->count));
+    memset(h->fast, 0, sizeof(h->fast));
+    for (unsigned i = 0; i < n; i++)
+        h->count[length[i]]++;
+
+    // Reject over-subscribed codes (incomplete codes are permitted)
+    int left = 1;
+    for (unsigned len = 1; len < 16; len++) {
+        left = (left << 1) - h->count[len];
+        if (left < 0)
+            return false;
+    }
+
+    offs[1] = 0;
+    for (unsigned len = 1; len < 15; len++)
+        offs[len + 1] = offs[len] + h->count[len];
+    for (unsigned i = 0; i < n; i++) {
+        if (length[i]) h->symbol[offs[length[i]]++] = i;
+    }
+
+    // Fill the lookup table with all short codes. Deflate stores Huffman codes starting with
+    // the most significant bit. Hence, the table is indexed with the bit-reversed code.
+    unsigned code = 0, index = 0;
+    for (unsigned len = 1; len < 16; len++) {
+        for (unsigned i = 0; i < h->count[len]; i++, code++, index++) {
+
+            if (len > Huffman::FAST_BITS)
+                continue;
+
+            unsigned reversed = 0;
+            for (unsigned b = 0; b < len; b++)
+                reversed |= ((code >> b) & 1) << (len - 1 - b);
+
+            for (unsigned k = reversed; k < (1 << Huffman::FAST_BITS); k += (1 << len))
+                h->fast[k] = (uint16_t)((len << 9) | h->symbol[index]);
+        }
+        code <<= 1;
+    }
+    return true;
+}
+
+int
+Inflater::decode(const Huffman *h)
+{
+    refill();
+
+    uint16_t entry = h->fast[bits & ((1 << Huffman::FAST_BITS) - 1)];
+    if (entry) {
+        unsigned len = entry >> 9;
+        bits >>= len; count -= len;
+        return entry & 0x1FF;
+    }
+
+    // Decode long codes bit by bit
+    int code = 0, first = 0, index = 0;
+    for (unsigned len = 1; len < 16; len++) {
+
+        code |= (bits >> (len - 1)) & 1;
+        int n = h->count[len];
+        if (code - n < first) {
+            bits >>= len; count -= len;
+            return h->symbol[index + (code - first)];
+        }
+        index += n;
+        first += n;
+        first <<= 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+bool
+Inflater::readDynamicCodes()
+{
+    static const uint8_t order[19] = {
+        16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+    uint8_t length[320];
+
+    unsigned nlen = getBits(5) + 257;
+    unsigned ndist = getBits(5) + 1;
+    unsigned ncode = getBits(4) + 4;
+    if (nlen > 286 || ndist > 30)
+        return false;
+
+    // Code lengths of the code length code
+    memset(length, 0, 19);
+    for (unsigned i = 0; i < ncode; i++)
+        length[order[i]] = getBits(3);
+    if (!build(&lencode, length, 19))
+        return false;
+
+    // Code lengths of the literal / length and the distance code
+    for (unsigned i = 0; i < nlen + ndist; ) {
+
+        int symbol = decode(&lencode);
+        if (symbol < 0)
+            return false;
+
+        if (symbol < 16) {
+            length[i++] = symbol;
+            continue;
+        }
+
+        uint8_t value = 0;
+        unsigned repeat;
+        if (symbol == 16) {
+            if (i == 0) return false;
+            value = length[i - 1];
+            repeat = 3 + getBits(2);
+        } else if (symbol == 17) {
+            repeat = 3 + getBits(3);
+        } else {
+            repeat = 11 + getBits(7);
+        }
+        if (i + repeat > nlen + ndist)
+            return false;
+        while (repeat--) length[i++] = value;
+    }
+
+    // The end-of-block code must be present
+    if (length[256] == 0)
+        return false;
+
+    return build(&lencode, length, nlen) && build(&distcode, length + nlen, ndist);
+}
+
+bool
+Inflater::stored(uint8_t *out, size_t *produced, size_t length)
+{
+    // Skip to the next byte boundary
+    getBits(count & 7);
+
+    unsigned n = getBits(16);
+    if ((getBits(16) ^ 0xFFFF) != n)
+        return false;
+
+    // Drain the bit buffer first, then copy the input chunk by chunk
+    while (n > 0 && count >= 8 && *produced < length) {
+        out[(*produced)++] = getBits(8);
+        n--;
+    }
+    if (count >= 8) {
+        // The remaining buffered bytes belong to the next block
+        return true;
+    }
+    bits = 0;
+    count = 0;
+    while (n > 0 && *produced < length) {
+        if (pos == len && !fill())
+            return false;
+        size_t bytes = MIN(MIN((size_t)n, len - pos), length - *produced);
+        memcpy(out + *produced, chunk + pos, bytes);
+        pos += bytes;
+        *produced += bytes;
+        n -= bytes;
+    }
+    return true;
+}
+
+bool
+Inflater::codes(uint8_t *out, size_t *produced, size_t length)
+{
+    size_t p = *produced;
+
+    while (p < length) {
+
+        int symbol = decode(&lencode);
+
+        if (symbol < 256) {
+            if (symbol < 0) return false;
+            out[p++] = (uint8_t)symbol;
+            continue;
+        }
+        if (symbol == 256) {
+            *produced = p;
+            return true;
+        }
+
+        symbol -= 257;
+        if (symbol >= 29) return false;
+        unsigned len = lengthBase[symbol] + getBits(lengthExtra[symbol]);
+
+        symbol = decode(&distcode);
+        if (symbol < 0 || symbol >= 30) return false;
+        size_t dist = distBase[symbol] + getBits(distExtra[symbol]);
+        if (dist > p) return false;
+
+        // The copy may overlap with its own output
+        if (len > length - p) len = (unsigned)(length - p);
+        const uint8_t *from = out + p - dist;
+        if (dist >= len) {
+            memcpy(out + p, from, len);
+        } else {
+            for (unsigned i = 0; i < len; i++)
+                out[p + i] = from[i];
+        }
+        p += len;
+    }
+
+    *produced = p;
+    return true;
+}
+
+size_t
+Inflater::inflate(uint8_t *out, size_t length)
+{
+    size_t produced = 0;
+    bool last = false;
+
+    while (!last && produced < length) {
+
+        last = getBits(1);
+        unsigned type = getBits(2);
+        bool success;
+
+        switch (type) {
+
+            case 0:
+                success = stored(out, &produced, length);
+                break;
+
+            case 1: {
+                uint8_t fixed[320];
+                memset(fixed, 8, 144);
+                memset(fixed + 144, 9, 112);
+                memset(fixed + 256, 7, 24);
+                memset(fixed + 280, 8, 8);
+                memset(fixed + 288, 5, 30);
+                build(&lencode, fixed, 288);
+                build(&distcode, fixed + 288, 30);
+                success = codes(out, &produced, length);
+                break;
+            }
+            case 2:
+                success = readDynamicCodes() && codes(out, &produced, length);
+                break;
+
+            default:
+                success = false;
+        }
+
+        // Input must not be consumed beyond its end
+        if (!success || overrun > sizeof(bits)) {
+            break;
+        }
+    }
+
+    return produced;
+}
+
+
+//
+// CompressedFile
+//
+
+CompressedFile::CompressedFile()
+{
+    file = NULL;
+    format = PLAIN_FILE;
+    name = NULL;
+    size = 0;
+    crc = 0;
+    dataOffset = 0;
+    dataSize = 0;
+    deflated = false;
+    member = NULL;
+    numMembers = 0;
+}
+
+CompressedFile::~CompressedFile()
+{
+    close();
+}
+
+bool
+CompressedFile::isCompressedPath(const char *path)
+{
+    assert(path != NULL);
+
+    size_t len = strlen(path);
+
+    if (len > 3 && strcasecmp(path + len - 3, ".gz") == 0)
+        return true;
+    if (len > 4 && strcasecmp(path + len - 4, ".zip") == 0)
+        return true;
+
+    for (const char *p = path; (p = strchr(p, '#')) != NULL; p++) {
+        if (p - path > 4 && strncasecmp(p - 4, ".zip", 4) == 0)
+            return true;
+    }
+    return false;
+}
+
+bool
+CompressedFile::open(const char *path)
+{
+    assert(path != NULL);
+
+    close();
+
+    size_t len = strlen(path);
+
+    // Gzip compressed file
+    if (len > 3 && strcasecmp(path + len - 3, ".gz") == 0) {
+
+        if (openGzip(path))
+            return true;
+        close();
+        return false;
+    }
+
+    // Member of a zip archive
+    if (isCompressedPath(path)) {
+
+        char *archive = strdup(path);
+        char *memberName = NULL;
+
+        for (char *p = archive; (p = strchr(p, '#')) != NULL; p++) {
+            if (p - archive > 4 && strncasecmp(p - 4, ".zip", 4) == 0) {
+                *p = 0;
+                memberName = p + 1;
+                break;
+            }
+        }
+
+        bool success = openZip(archive, memberName);
+        free(archive);
+        if (!success) close();
+        return success;
+    }
+
+    // Plain file
+    struct stat fileProperties;
+    if (stat(path, &fileProperties) != 0 || !(file = fopen(path, "r")))
+        return false;
+
+    format = PLAIN_FILE;
+    name = strdup(path);
+    size = fileProperties.st_size;
+    dataOffset = 0;
+    dataSize = fileProperties.st_size;
+    deflated = false;
+    return true;
+}
+
+void
+CompressedFile::close()
+{
+    if (file) {
+        fclose(file);
+        file = NULL;
+    }
+    if (name) {
+        free(name);
+        name = NULL;
+    }
+    for (unsigned i = 0; i < numMembers; i++) {
+        free(member[i].name);
+    }
+    free(member);
+    member = NULL;
+    numMembers = 0;
+    format = PLAIN_FILE;
+    size = 0;
+}
+
+bool
+CompressedFile::openGzip(const char *path)
+{
+    uint8_t header[10], trailer[8];
+    struct stat fileProperties;
+
+    if (stat(path, &fileProperties) != 0 || fileProperties.st_size < 18)
+        return false;
+    if (!(file = fopen(path, "r")))
+        return false;
+
+    // Check magic bytes and compression method (8 = deflate)
+    if (fread(header, 1, 10, file) != 10)
+        return false;
+    if (header[0] != 0x1F || header[1] != 0x8B || header[2] != 8)
+        return false;
+
+    // Skip optional fields
+    uint8_t flags = header[3];
+    if (flags & 0x04) {
+        uint8_t extra[2];
+        if (fread(extra, 1, 2, file) != 2)
+            return false;
+        fseek(file, le16(extra), SEEK_CUR);
+    }
+    if (flags & 0x08) {
+        int c; while ((c = fgetc(file)) != 0 && c != EOF);
+    }
+    if (flags & 0x10) {
+        int c; while ((c = fgetc(file)) != 0 && c != EOF);
+    }
+    if (flags & 0x02) {
+        fseek(file, 2, SEEK_CUR);
+    }
+    dataOffset = ftell(file);
+    dataSize = (long)fileProperties.st_size - 8 - dataOffset;
+    if (dataSize <= 0)
+        return false;
+
+    // The trailer stores the checksum and the size of the uncompressed data
+    fseek(file, -8, SEEK_END);
+    if (fread(trailer, 1, 8, file) != 8)
+        return false;
+
+    format = GZIP_FILE;
+    name = strndup(path, strlen(path) - 3);
+    crc = le32(trailer);
+    size = le32(trailer + 4);
+    deflated = true;
+    return true;
+}
+
+bool
+CompressedFile::openZip(const char *path, const char *memberName)
+{
+    if (!(file = fopen(path, "r")))
+        return false;
+
+    format = ZIP_FILE;
+    if (!readZipDirectory())
+        return false;
+
+    // Select the requested member or the first one
+    for (unsigned i = 0; i < numMembers; i++) {
+        if (memberName == NULL || *memberName == 0 || strcmp(member[i].name, memberName) == 0)
+            return selectMember(i);
+    }
+    for (unsigned i = 0; i < numMembers; i++) {
+        if (strcasecmp(member[i].name, memberName) == 0)
+            return selectMember(i);
+    }
+
+    debug(2, "Zip archive %s has no member %s\n", path, memberName ? memberName : "");
+    return false;
+}
+
+bool
+CompressedFile::readZipDirectory()
+{
+    // Search the end of central directory record at the end of the file. It takes 22 bytes
+    // plus a comment of up to 65535 bytes. Most archives have no comment. Hence, only the last
+    // few hundred bytes are searched first.
+    uint8_t *tail = NULL, *directory = NULL;
+    bool success = false;
+    long end, entries, dirSize, dirOffset;
+    const uint8_t *eocd = NULL;
+
+    if (fseek(file, 0, SEEK_END) != 0 || (end = ftell(file)) < 22)
+        goto exit;
+
+    for (long window = 512; eocd == NULL; window = 22 + 0xFFFF) {
+
+        long start = MAX(0, end - window);
+        size_t tailSize = end - start;
+
+        free(tail);
+        if (!(tail = (uint8_t *)malloc(tailSize)))
+            goto exit;
+
+        fseek(file, start, SEEK_SET);
+        if (fread(tail, 1, tailSize, file) != tailSize)
+            goto exit;
+
+        for (long i = (long)tailSize - 22; i >= 0; i--) {
+            if (le32(tail + i) == 0x06054B50) {
+                eocd = tail + i;
+                break;
+            }
+        }
+        if (start == 0 || window > 0xFFFF)
+            break;
+    }
+    if (eocd == NULL)
+        goto exit;
+
+    entries = le16(eocd + 10);
+    dirSize = le32(eocd + 12);
+    dirOffset = le32(eocd + 16);
+    if (dirOffset + dirSize > end)
+        goto exit;
+
+    // Read the central directory
+    if (!(directory = (uint8_t *)malloc(dirSize + 1)))
+        goto exit;
+    fseek(file, dirOffset, SEEK_SET);
+    if (fread(directory, 1, dirSize, file) != (size_t)dirSize)
+        goto exit;
+
+    member = (ZipMember *)calloc(entries + 1, sizeof(ZipMember));
+    for (long i = 0, p = 0; i < entries; i++) {
+
+        if (p + 46 > dirSize || le32(directory + p) != 0x02014B50)
+            goto exit;
+
+        const uint8_t *entry = directory + p;
+        unsigned nameLength = le16(entry + 28);
+        unsigned extraLength = le16(entry + 30);
+        unsigned commentLength = le16(entry + 32);
+        if (p + 46 + nameLength > dirSize)
+            goto exit;
+
+        // Directories are skipped
+        if (nameLength > 0 && entry[46 + nameLength - 1] != '/') {
+
+            ZipMember *m = &member[numMembers++];
+            m->name = strndup((const char *)entry + 46, nameLength);
+            m->method = le16(entry + 10);
+            m->crc = le32(entry + 16);
+            m->compressedSize = le32(entry + 20);
+            m->size = le32(entry + 24);
+            m->offset = le32(entry + 42);
+        }
+        p += 46 + nameLength + extraLength + commentLength;
+    }
+    success = true;
+
+exit:
+
+    free(tail);
+    free(directory);
+    return success;
+}
+
+bool
+CompressedFile::selectMember(unsigned n)
+{
+    assert(n < numMembers);
+
+    ZipMember *m = &member[n];
+    uint8_t header[30];
+
+    if (m->method != 0 && m->method != 8) {
+        warn("Zip member %s uses unsupported compression method %d\n", m->name, m->method);
+        return false;
+    }
+
+    // The local header may store an extra field of a different length
+    fseek(file, m->offset, SEEK_SET);
+    if (fread(header, 1, 30, file) != 30 || le32(header) != 0x04034B50)
+        return false;
+
+    name = strdup(m->name);
+    size = m->size;
+    crc = m->crc;
+    dataOffset = m->offset + 30 + le16(header + 26) + le16(header + 28);
+    dataSize = m->compressedSize;
+    deflated = (m->method == 8);
+    return true;
+}
+
+size_t
+CompressedFile::read(uint8_t *buffer, size_t length)
+{
+    assert(buffer != NULL);
+
+    if (file == NULL)
+        return 0;
+
+    length = MIN(length, size);
+    fseek(file, dataOffset, SEEK_SET);
+
+    size_t result;
+    if (deflated) {
+        Inflater *inflater = new Inflater(file, dataSize);
+        result = inflater->inflate(buffer, length);
+        delete inflater;
+    } else {
+        result = fread(buffer, 1, MIN(length, (size_t)dataSize), file);
+    }
+
+    // Verify the checksum if the whole file has been read
+    if (format != PLAIN_FILE && result == size && crc32(buffer, result) != crc) {
+        warn("Checksum mismatch in %s\n", getName());
+        return 0;
+    }
+    return result;
+}
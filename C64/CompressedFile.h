@@ -0,0 +1,165 @@
+/*!
+ * @header      CompressedFile.h
+ * @author      Dirk W. Hoffmann, www.dirkwhoffmann.de
+ * @copyright   2018 Dirk W. Hoffmann
+ */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _COMPRESSEDFILE_INC
+#define _COMPRESSEDFILE_INC
+
+#include "VC64Object.h"
+
+//! @brief    Storage format of a file
+enum CompressionFormat {
+    PLAIN_FILE,
+    GZIP_FILE,
+    ZIP_FILE
+};
+
+//! @brief    A file stored in a zip archive
+typedef struct {
+
+    //! @brief    Name of the member (as stored in the archive)
+    char *name;
+
+    //! @brief    Compression method (0 = stored, 8 = deflated)
+    uint16_t method;
+
+    //! @brief    Checksum of the uncompressed data
+    uint32_t crc;
+
+    //! @brief    Size of the compressed and uncompressed data
+    uint32_t compressedSize;
+    uint32_t size;
+
+    //! @brief    File offset of the local header
+    uint32_t offset;
+
+} ZipMember;
+
+/*! @class    CompressedFile
+ *  @brief    Read access to plain, gzip compressed, and zip archived files
+ *  @details  The class lets all containers open their files straight from .gz and .zip files.
+ *            A gzip compressed file is referred to by its own path, e.g., "game.d64.gz". A
+ *            member of a zip archive is referred to by appending its name to the path of the
+ *            archive, separated by '#', e.g., "collection.zip#game.d64". Without a member name,
+ *            the first file in the archive is used.
+ *            The uncompressed size is taken from the file headers. Hence, containers can
+ *            allocate their buffer before decompressing. The data is inflated while the file is
+ *            read chunk by chunk, directly into the container's buffer. If only the first bytes
+ *            are requested (e.g., to check the magic bytes of a file), decompression stops as
+ *            soon as they are available.
+ */
+class CompressedFile : public VC64Object {
+
+private:
+
+    //! @brief    The opened file
+    FILE *file;
+
+    //! @brief    Storage format
+    CompressionFormat format;
+
+    //! @brief    Name of the stored file (used to determine its type)
+    char *name;
+
+    //! @brief    Uncompressed size
+    size_t size;
+
+    //! @brief    Checksum of the uncompressed data (not used for plain files)
+    uint32_t crc;
+
+    //! @brief    File offset and size of the compressed data
+    long dataOffset;
+    long dataSize;
+
+    //! @brief    Indicates that the data is stored with deflate compression
+    bool deflated;
+
+    //! @brief    Members of a zip archive
+    ZipMember *member;
+    unsigned numMembers;
+
+public:
+
+    //! @brief    Constructor
+    CompressedFile();
+
+    //! @brief    Destructor
+    ~CompressedFile();
+
+    /*! @brief    Returns true if the path refers to a compressed file
+     *  @details  The decision is based on the path only (.gz suffix, .zip suffix, or zip member).
+     */
+    static bool isCompressedPath(const char *path);
+
+    /*! @brief    Opens a file for reading
+     *  @details  Plain files are opened, too. In that case, read() simply reads the file.
+     */
+    bool open(const char *path);
+
+    //! @brief    Closes the file and frees all resources
+    void close();
+
+    //! @brief    Returns the storage format of the opened file
+    CompressionFormat getFormat() { return format; }
+
+    /*! @brief    Returns the name of the stored file
+     *  @details  For a gzip compressed file, this is the path without the .gz suffix. For a zip
+     *            archive, this is the name of the selected member.
+     */
+    const char *getName() { return name ? name : ""; }
+
+    //! @brief    Returns the uncompressed size of the stored file
+    size_t getSize() { return size; }
+
+    /*! @brief    Reads the stored file from the beginning
+     *  @details  If length equals the size of the file, the data is verified by its checksum.
+     *  @return   Number of bytes written into the buffer (less than length on errors)
+     */
+    size_t read(uint8_t *buffer, size_t length);
+
+
+    //
+    //! @functiongroup Listing zip archives
+    //
+
+    //! @brief    Returns the number of files in the opened zip archive
+    unsigned getNumberOfMembers() { return numMembers; }
+
+    //! @brief    Returns the name of a file in the opened zip archive
+    const char *getNameOfMember(unsigned n) { assert(n < numMembers); return member[n].name; }
+
+    //! @brief    Returns the uncompressed size of a file in the opened zip archive
+    size_t getSizeOfMember(unsigned n) { assert(n < numMembers); return member[n].size; }
+
+private:
+
+    //! @brief    Parses the header and trailer of a gzip file
+    bool openGzip(const char *path);
+
+    //! @brief    Parses the central directory of a zip archive and selects a member
+    bool openZip(const char *path, const char *memberName);
+
+    //! @brief    Reads the central directory of a zip archive
+    bool readZipDirectory();
+
+    //! @brief    Locates the compressed data of a zip member
+    bool selectMember(unsigned n);
+};
+
+#endif
@@ -17,6 +17,7 @@
  */
 
 #include "Container.h"
+#include "CompressedFile.h"
 
 Container::Container()
 {
@@ -84,8 +85,8 @@ Container::readFromFile(const char *filename)
     
     bool success = false;
 	uint8_t *buffer = NULL;
-	FILE *file = NULL;
-	struct stat fileProperties;
+	CompressedFile file;
+    size_t size;
     char *name = NULL;
 	
 	// Check file type
@@ -93,39 +94,31 @@ Container::readFromFile(const char *filename)
 		goto exit;
 	}
 	
-	// Get file properties
-    if (stat(filename, &fileProperties) != 0) {
-		goto exit;
-	}
-		
-	// Open file
-	if (!(file = fopen(filename, "r"))) {
+	// Open file (compressed files are inflated while reading)
+	if (!file.open(filename)) {
 		goto exit;
 	}
 
 	// Allocate memory
-	if (!(buffer = (uint8_t *)malloc(fileProperties.st_size))) {
+    size = file.getSize();
+	if (!(buffer = (uint8_t *)malloc(size))) {
 		goto exit;
 	}
 	
 	// Read from file
-	int c;
-	for (unsigned i = 0; i < fileProperties.st_size; i++) {
-		c = fgetc(file);
-		if (c == EOF)
-			break;
-		buffer[i] = (uint8_t)c;
+	if (file.read(buffer, size) != size) {
+		goto exit;
 	}
 	
 	// Read from buffer (subclass specific behaviour)
 	dealloc();
-	if (!readFromBuffer(buffer, (unsigned)fileProperties.st_size)) {
+	if (!readFromBuffer(buffer, size)) {
 		goto exit;
 	}
 
 	// Set path and default name
     setPath(filename);
-    name = ExtractFilenameWithoutSuffix(filename);
+    name = ExtractFilenameWithoutSuffix(file.getName());
     setName(name);
         
     debug(1, "Container %s (%s) read successfully from file %s\n", name, getName(), path);
@@ -133,10 +126,8 @@ Container::readFromFile(const char *filename)
 
 exit:
 	
-    if (name)
-        free(name);
-    if (file)
-		fclose(file);
+	if (name)
+		free(name);
 	if (buffer)
 		free(buffer);
 
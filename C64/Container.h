@@ -124,7 +124,8 @@ public:
 	
     /*! @brief    Read container contents from a file.
      *  @details  This function requires no custom implementation. It first reads in the file contents 
-     *            in memory and invokes readFromBuffer afterwards. 
+     *            in memory and invokes readFromBuffer afterwards. Gzip compressed files and
+     *            members of zip archives are inflated on the fly (see CompressedFile).
      *  @param    filename The name of a file containing a binary representation.
      */
 	bool readFromFile(const char *filename);
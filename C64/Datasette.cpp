@@ -21,6 +21,20 @@
 
 #include "C64.h"
 
+// Kernal routine reading a block from tape. The trap replaces the call that installs the
+// tape interrupt handler. Execution continues at the routine finishing the tape operation.
+static const uint16_t readTrapAddr = 0xF8A1;   // JSR $FCBD
+static const uint16_t readTrapExit = 0xFC93;   // PHP, SEI, ...
+
+// Pulse length ranges (in cycles) of the Kernal encoding
+static const int shortPulseMin = 256;
+static const int mediumPulseMin = 440;
+static const int longPulseMin = 600;
+static const int longPulseMax = 880;
+
+// Minimum number of short pulses forming a pilot tone
+static const uint64_t minPilotLength = 64;
+
 Datasette::Datasette()
 {
     setDescription("Datasette");
@@ -52,6 +66,7 @@ Datasette::Datasette()
     size = 0;
     type = 0;
     durationInCycles = 0;
+    fastLoad = true;
 }
 
 Datasette::~Datasette()
@@ -67,6 +82,9 @@ Datasette::reset()
 {
     VirtualComponent::reset();
     rewind();
+
+    if (fastLoad)
+        c64->cpu.setTrap(readTrapAddr);
 }
 
 void
@@ -155,6 +173,7 @@ Datasette::insertTape(TAPContainer *a)
     durationInCycles = headInCycles;
     rewind();
     
+    c64->selectExecutionLoop();
     c64->putMessage(MSG_VC1530_TAPE);
 }
 
@@ -166,6 +185,7 @@ Datasette::ejectTape()
     if (!hasTape())
         return;
     
+    c64->suspend();
     pressStop();
     
     assert(data != NULL);
@@ -176,6 +196,8 @@ Datasette::ejectTape()
     durationInCycles = 0;
     head = -1;
 
+    c64->selectExecutionLoop();
+    c64->resume();
     c64->putMessage(MSG_VC1530_NO_TAPE);
 }
 
@@ -202,24 +224,24 @@ Datasette::advanceHead(bool silent)
 }
 
 int
-Datasette::pulseLength(int *skip)
+Datasette::pulseLength(uint64_t pos, int *skip)
 {
-    assert(head < size);
+    assert(pos < size);
 
-    if (data[head] != 0) {
+    if (data[pos] != 0) {
         // Pulse lengths between 1 * 8 and 255 * 8
         if (skip) *skip = 1;
-        return 8 * data[head];
+        return 8 * data[pos];
     }
     
-    if (type == 0) {
+    if (type == 0 || pos + 3 >= size) {
         // Pulse lengths greater than 8 * 255 (TAP V0 files)
         if (skip) *skip = 1;
         return 8 * 256;
     } else {
         // Pulse lengths greater than 8 * 255 (TAP V1 files)
         if (skip) *skip = 4;
-        return  LO_LO_HI_HI(data[head+1], data[head+2], data[head+3], 0);
+        return  LO_LO_HI_HI(data[pos+1], data[pos+2], data[pos+3], 0);
     }
 }
 
@@ -296,3 +318,217 @@ Datasette::_executeFalling()
     nextRisingEdge = length / 2;
     nextFallingEdge = length;
 }
+
+void
+Datasette::setFastLoad(bool value)
+{
+    fastLoad = value;
+    
+    if (fastLoad)
+        c64->cpu.setTrap(readTrapAddr);
+    else
+        c64->cpu.deleteTrap(readTrapAddr);
+}
+
+char
+Datasette::kernalPulse(uint64_t *pos)
+{
+    if (*pos >= size)
+        return 0;
+    
+    int skip;
+    int length = pulseLength(*pos, &skip);
+    *pos += skip;
+    
+    if (length < shortPulseMin || length >= longPulseMax) return 0;
+    if (length < mediumPulseMin) return 'S';
+    if (length < longPulseMin) return 'M';
+    return 'L';
+}
+
+int
+Datasette::decodeKernalByte(uint64_t *pos)
+{
+    // Each byte starts with a long and a medium pulse. A long and a short pulse mark
+    // the end of the data.
+    if (kernalPulse(pos) != 'L')
+        return -2;
+    switch (kernalPulse(pos)) {
+        case 'M': break;
+        case 'S': return -1;
+        default: return -2;
+    }
+    
+    // 8 data bits (LSB first) and an odd parity bit. Each bit is encoded as a pulse pair.
+    int value = 0, parity = 1;
+    for (unsigned i = 0; i < 9; i++) {
+        
+        char first = kernalPulse(pos);
+        char second = kernalPulse(pos);
+        int bit;
+        
+        if (first == 'S' && second == 'M') bit = 0;
+        else if (first == 'M' && second == 'S') bit = 1;
+        else return -2;
+        
+        if (i < 8) {
+            value |= bit << i;
+            parity ^= bit;
+        } else if (bit != parity) {
+            return -2;
+        }
+    }
+    
+    return value;
+}
+
+int
+Datasette::decodeKernalBlock(uint64_t *pos, uint64_t maxGap, uint8_t *buffer, size_t capacity,
+                             size_t *length, bool *checksumOk)
+{
+    uint64_t p = *pos, pilot = 0, gap = 0;
+    
+    // Search the pilot tone and the first byte marker
+    while (1) {
+        
+        uint64_t marker = p;
+        char pulse = kernalPulse(&p);
+        
+        if (p >= size || gap > maxGap)
+            return -1;
+        
+        if (pulse == 'S') {
+            pilot++;
+            continue;
+        }
+        if (pulse == 'L' && pilot >= minPilotLength && kernalPulse(&p) == 'M') {
+            p = marker;
+            break;
+        }
+        gap += pilot + 1;
+        pilot = 0;
+    }
+    
+    // Countdown sequence ($89 ... $81 for the first copy, $09 ... $01 for the repetition)
+    int first = decodeKernalByte(&p);
+    if (first != 0x89 && first != 0x09)
+        return -1;
+    for (int i = first - 1; i > first - 9; i--) {
+        if (decodeKernalByte(&p) != i)
+            return -1;
+    }
+    
+    // Data bytes followed by the checksum
+    uint8_t checksum = 0;
+    *length = 0;
+    while (1) {
+        
+        int value = decodeKernalByte(&p);
+        if (value == -1)
+            break;
+        if (value < 0 || *length == capacity)
+            return -1;
+        
+        buffer[(*length)++] = (uint8_t)value;
+        checksum ^= (uint8_t)value;
+    }
+    
+    // The checksum is the XOR of all data bytes. Hence, XORing it in yields zero.
+    *checksumOk = *length > 1 && checksum == 0;
+    *pos = p;
+    return first;
+}
+
+bool
+Datasette::executeTrap()
+{
+    C64Memory *mem = &c64->mem;
+    C64CPU *cpu = &c64->cpu;
+    
+    if (!fastLoad || !hasTape() || !playKey || head >= size)
+        return false;
+    
+    // Make sure that the trapped code belongs to a compatible Kernal
+    if (cpu->getPC() != readTrapAddr ||
+        mem->spy(readTrapAddr) != 0x20 ||
+        mem->spy(readTrapAddr + 1) != 0xBD ||
+        mem->spy(readTrapAddr + 2) != 0xFC ||
+        mem->spy(readTrapExit) != 0x08 ||
+        mem->spy(readTrapExit + 1) != 0x78) {
+        return false;
+    }
+    
+    // Only reading is supported (X = $08 when writing)
+    if (cpu->getX() != 0x0E)
+        return false;
+    
+    // Each block is recorded twice. The repetition is used if the first copy is corrupted.
+    const size_t capacity = 0x10001;
+    uint8_t *block = (uint8_t *)malloc(2 * capacity);
+    uint8_t *repetition = block + capacity;
+    size_t length, repLength;
+    bool ok, repOk = false;
+    uint64_t pos = head;
+    
+    int countdown = decodeKernalBlock(&pos, size, block, capacity, &length, &ok);
+    if (countdown == 0x89) {
+        uint64_t repPos = pos;
+        if (decodeKernalBlock(&repPos, minPilotLength, repetition, capacity, &repLength, &repOk) == 0x09) {
+            pos = repPos;
+        } else {
+            repOk = false;
+        }
+    }
+    
+    if (countdown < 0 || (!ok && !repOk)) {
+        debug(2, "No Kernal block found at head position %llu\n", head);
+        free(block);
+        return false;
+    }
+    if (!ok) {
+        memcpy(block, repetition, repLength);
+        length = repLength;
+    }
+    length--; // Checksum
+    
+    // Copy the block into memory (or compare it if the Kernal performs a VERIFY)
+    uint16_t start = LO_HI(mem->spy(0xC1), mem->spy(0xC2));
+    uint16_t end = LO_HI(mem->spy(0xAE), mem->spy(0xAF));
+    uint16_t count = (uint16_t)(end - start);
+    bool verify = mem->spy(0x93) != 0;
+    uint8_t status = 0x40;
+
+    if (length < count) status |= 0x04; // Short block
+    if (length > count) status |= 0x08; // Long block
+    
+    uint16_t i;
+    for (i = 0; i < count && i < length; i++) {
+        if (!verify) {
+            mem->poke(start + i, block[i]);
+        } else if (mem->spy(start + i) != block[i]) {
+            status |= 0x10;
+        }
+    }
+    free(block);
+    
+    mem->poke(0xAC, LO_BYTE(start + i));
+    mem->poke(0xAD, HI_BYTE(start + i));
+    mem->poke(0x90, mem->spy(0x90) | status);
+    
+    debug(2, "Kernal block loaded (%zu bytes to $%04X, status $%02X)\n", length, start, status);
+    
+    // Move the head behind the block
+    while (head < pos)
+        advanceHead();
+    if (head < size) {
+        uint64_t pulse = pulseLength();
+        nextRisingEdge = pulse / 2;
+        nextFallingEdge = pulse;
+    }
+    
+    // Continue with the routine finishing the tape operation
+    cpu->setC(0);
+    cpu->setI(0);
+    cpu->setPC(readTrapExit);
+    return true;
+}
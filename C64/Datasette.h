@@ -123,6 +123,13 @@ private:
      */
     bool motor;
     
+    /*! @brief    Indicates whether Kernal blocks are loaded instantly
+     *  @details  If set, the Kernal routine reading a block from tape is trapped. If the
+     *            tape contains a standard Kernal block at the head position, the block is
+     *            decoded directly from the pulse data and copied into memory.
+     */
+    bool fastLoad;
+    
     // ---------------------------------------------------------------------------------------------
     //                                    Methods
     // ---------------------------------------------------------------------------------------------
@@ -183,8 +190,12 @@ public:
     
     /*! @brief    Returns the pulse length at the current head position
      */
-    int pulseLength(int *skip);
-    int pulseLength() { return pulseLength(NULL); }
+    int pulseLength(int *skip) { return pulseLength(head, skip); }
+    int pulseLength() { return pulseLength(head, NULL); }
+
+    /*! @brief    Returns the pulse length at the specified position
+     */
+    int pulseLength(uint64_t pos, int *skip);
 
     
     //
@@ -215,6 +226,29 @@ public:
      */
     void execute() { if (playKey && motor) _execute(); }
 
+    
+    //
+    //! @functiongroup Loading Kernal blocks instantly
+    //
+    
+    /*! @brief    Returns true if Kernal blocks are loaded instantly
+     */
+    bool getFastLoad() { return fastLoad; }
+    
+    /*! @brief    Enables or disables instant loading of Kernal blocks
+     */
+    void setFastLoad(bool value);
+    
+    /*! @brief    Trap handler for the Kernal tape read routine
+     *  @details  Called by the CPU when it is about to execute the trapped instruction.
+     *            If a standard Kernal block is found at the head position, the block is
+     *            copied into memory, the head is moved behind the block, and the CPU is
+     *            redirected to the end of the Kernal routine. Otherwise, nothing happens
+     *            and the block is read in real time.
+     *  @return   true, if the block has been loaded
+     */
+    bool executeTrap();
+
 private:
 
     //! @brief    Internal execution function
@@ -226,6 +260,24 @@ private:
     //! @brief    Simulates the rising edge of a pulse
     void _executeRising();
 
+    /*! @brief    Classifies the pulse at the specified position and advances the position
+     *  @return   'S', 'M', or 'L' for a short, medium, or long Kernal pulse, 0 otherwise
+     */
+    char kernalPulse(uint64_t *pos);
+    
+    /*! @brief    Decodes a Kernal byte at the specified position
+     *  @return   The byte value, -1 for the end-of-data marker, or -2 if no byte is found
+     */
+    int decodeKernalByte(uint64_t *pos);
+    
+    /*! @brief    Decodes the next Kernal block (pilot, countdown, data, checksum)
+     *  @param    maxGap  Maximum number of pulses preceding the pilot tone
+     *  @param    length  Number of decoded bytes, including the checksum
+     *  @return   The first countdown byte (0x89 or 0x09), or -1 if no block is found
+     */
+    int decodeKernalBlock(uint64_t *pos, uint64_t maxGap, uint8_t *buffer, size_t capacity,
+                          size_t *length, bool *checksumOk);
+
 };
 
 #endif
@@ -42,11 +42,24 @@ Disk525::Disk525()
     for (unsigned i = 0; i < 16; i++)
         invgcr[gcr[i]] = i;
 
+    memset(syncIndex, 0, sizeof(syncIndex));
     clearDisk();
 }
 
 Disk525::~Disk525()
 {
+    for (Halftrack ht = 1; ht <= 84; ht++) {
+        free(syncIndex[ht].syncStart);
+        free(syncIndex[ht].syncEnd);
+        free(syncIndex[ht].header);
+    }
+}
+
+void
+Disk525::loadFromBuffer(uint8_t **buffer)
+{
+    VirtualComponent::loadFromBuffer(buffer);
+    invalidateSyncIndex();
 }
 
 void
@@ -142,6 +155,33 @@ Disk525::clearHalftrack(Halftrack ht)
 {
     assert(isHalftrackNumber(ht));
     memset(data.halftrack[ht], 0x55, sizeof(data.halftrack[ht]));
+    syncIndex[ht].valid = false;
+}
+
+uint16_t
+Disk525::readBitsFromHalftrack(Halftrack ht, unsigned offset, unsigned count)
+{
+    assert(isHalftrackNumber(ht));
+    assert(count <= 16);
+    
+    unsigned len = length.halftrack[ht];
+    offset %= len;
+    
+    // Bits wrapping around the end of the halftrack are read one by one
+    if (offset + count > len) {
+        uint16_t result = 0;
+        for (unsigned i = 0; i < count; i++)
+            result = (result << 1) | readBitFromHalftrack(ht, offset + i);
+        return result;
+    }
+    
+    // All other bits are contained in at most three bytes
+    uint8_t *ptr = data.halftrack[ht] + offset / 8;
+    unsigned first = offset % 8, bytes = (first + count + 7) / 8;
+    uint32_t bits = 0;
+    for (unsigned i = 0; i < bytes; i++)
+        bits = (bits << 8) | ptr[i];
+    return (bits >> (8 * bytes - first - count)) & ((1 << count) - 1);
 }
 
 const char *
@@ -161,6 +201,161 @@ Disk525::dataAbs(Halftrack ht, int start, unsigned n)
     return text;
 }
 
+// ---------------------------------------------------------------------------------------------
+//                            Locating SYNC marks and sector headers
+// ---------------------------------------------------------------------------------------------
+
+static int
+compareOffsets(const void *a, const void *b)
+{
+    return (int)*(const uint16_t *)a - (int)*(const uint16_t *)b;
+}
+
+//! @brief    Returns the first list index with an entry greater or equal to the specified offset
+static unsigned
+lowerBound(const uint16_t *list, unsigned count, unsigned offset)
+{
+    unsigned lo = 0, hi = count;
+    while (lo < hi) {
+        unsigned mid = (lo + hi) / 2;
+        if (list[mid] < offset) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+//! @brief    Returns the distance from an offset to the next list entry on a circular track
+static unsigned
+distanceToNext(const uint16_t *list, unsigned count, unsigned offset, unsigned len)
+{
+    if (count == 0)
+        return UINT_MAX;
+    
+    unsigned i = lowerBound(list, count, offset);
+    return i < count ? list[i] - offset : list[0] + len - offset;
+}
+
+//! @brief    Returns the distance from the previous list entry to an offset on a circular track
+static unsigned
+distanceFromPrevious(const uint16_t *list, unsigned count, unsigned offset, unsigned len)
+{
+    if (count == 0)
+        return UINT_MAX;
+    
+    unsigned i = lowerBound(list, count, offset + 1);
+    return i > 0 ? offset - list[i - 1] : offset + len - list[count - 1];
+}
+
+void
+Disk525::buildSyncIndex(Halftrack ht)
+{
+    SyncIndex *index = &syncIndex[ht];
+    unsigned len = length.halftrack[ht];
+    uint8_t *track = data.halftrack[ht];
+    
+    // Each SYNC mark occupies at least eleven bits (including the terminating '0')
+    unsigned capacity = len / 11 + 1;
+    index->syncStart = (uint16_t *)realloc(index->syncStart, capacity * sizeof(uint16_t));
+    index->syncEnd = (uint16_t *)realloc(index->syncEnd, capacity * sizeof(uint16_t));
+    index->header = (SectorHeader *)realloc(index->header, capacity * sizeof(SectorHeader));
+    index->syncs = 0;
+    index->headers = 0;
+    index->valid = true;
+    
+    // Start behind a '0' bit, so that no SYNC mark wraps around the end of the scanned range
+    unsigned first = 0;
+    while (first < len && readBit(track, first))
+        first++;
+    if (first == len)
+        return; // No '0' bit at all. The drive never drops the SYNC signal.
+    
+    for (unsigned i = 1, pos = first, ones = 0; i <= len; i++) {
+        
+        if (++pos == len) pos = 0;
+        if (readBit(track, pos)) {
+            ones++;
+            continue;
+        }
+        if (ones >= 10) {
+            index->syncStart[index->syncs] = (pos + len - ones + 9) % len;
+            index->syncEnd[index->syncs++] = pos;
+        }
+        ones = 0;
+    }
+    
+    // The SYNC mark scanned first is not necessarily the one with the smallest offset
+    qsort(index->syncStart, index->syncs, sizeof(uint16_t), compareOffsets);
+    qsort(index->syncEnd, index->syncs, sizeof(uint16_t), compareOffsets);
+    
+    // Decode the first four bytes behind each SYNC mark. Header blocks start with 0x08.
+    for (unsigned i = 0; i < index->syncs; i++) {
+        
+        unsigned offset = index->syncEnd[i];
+        uint8_t header[4];
+        decodeGcr(readByteFromHalftrack(ht, offset),
+                  readByteFromHalftrack(ht, offset + 8),
+                  readByteFromHalftrack(ht, offset + 16),
+                  readByteFromHalftrack(ht, offset + 24),
+                  readByteFromHalftrack(ht, offset + 32), header);
+        
+        if (header[0] == 0x08) {
+            SectorHeader *entry = &index->header[index->headers++];
+            entry->offset = offset;
+            entry->sector = header[2];
+            entry->track = header[3];
+        }
+    }
+    
+    debug(3, "Halftrack %d: %d SYNC marks, %d sector headers\n", ht, index->syncs, index->headers);
+}
+
+void
+Disk525::invalidateSyncIndex()
+{
+    for (Halftrack ht = 1; ht <= 84; ht++)
+        syncIndex[ht].valid = false;
+}
+
+unsigned
+Disk525::distanceToSync(Halftrack ht, unsigned offset)
+{
+    SyncIndex *index = getSyncIndex(ht);
+    return distanceToNext(index->syncStart, index->syncs, offset, length.halftrack[ht]);
+}
+
+unsigned
+Disk525::distanceToSyncEnd(Halftrack ht, unsigned offset)
+{
+    SyncIndex *index = getSyncIndex(ht);
+    return distanceToNext(index->syncEnd, index->syncs, offset, length.halftrack[ht]);
+}
+
+unsigned
+Disk525::distanceFromSyncEnd(Halftrack ht, unsigned offset)
+{
+    SyncIndex *index = getSyncIndex(ht);
+    return distanceFromPrevious(index->syncEnd, index->syncs, offset, length.halftrack[ht]);
+}
+
+const SectorHeader *
+Disk525::nextSectorHeader(Halftrack ht, unsigned offset, unsigned *distance)
+{
+    SyncIndex *index = getSyncIndex(ht);
+    
+    if (index->headers == 0)
+        return NULL;
+    
+    // Binary search for the first header at or behind the specified offset
+    unsigned lo = 0, hi = index->headers;
+    while (lo < hi) {
+        unsigned mid = (lo + hi) / 2;
+        if (index->header[mid].offset < offset) lo = mid + 1; else hi = mid;
+    }
+    
+    const SectorHeader *header = &index->header[lo < index->headers ? lo : 0];
+    *distance = (header->offset + length.halftrack[ht] - offset) % length.halftrack[ht];
+    return header;
+}
+
 // ---------------------------------------------------------------------------------------------
 //                               Data encoding and decoding
 // ---------------------------------------------------------------------------------------------
@@ -197,6 +392,7 @@ Disk525::encodeArchive(G64Archive *a)
         }
         assert(a->getByte() == -1); /* check for EOF */
     }
+    invalidateSyncIndex();
 }
 
 void
@@ -229,6 +425,7 @@ Disk525::encodeArchive(NIBArchive *a)
             data.halftrack[ht][i] = (uint8_t)b;
         }
     }
+    invalidateSyncIndex();
 }
 
 void
@@ -289,6 +486,7 @@ Disk525::encodeArchive(D64Archive *a)
     for (Halftrack ht = 1; ht <= 84; ht++) {
         assert(length.halftrack[ht] <= sizeof(data.halftrack[ht]) * 8);
     }    
+    invalidateSyncIndex();
 }
 
 unsigned
@@ -74,6 +74,48 @@ inline bool isTrackNumber(unsigned nr) { return 1 <= nr && nr <= 42; }
  */
 const unsigned MAX_FILES_ON_DISK = 144;
 
+/*! @brief    Sector header found on a halftrack
+ */
+typedef struct {
+    
+    //! @brief    Bit offset of the first GCR byte behind the SYNC mark
+    uint16_t offset;
+    
+    //! @brief    Track number stored in the header
+    uint8_t track;
+    
+    //! @brief    Sector number stored in the header
+    uint8_t sector;
+    
+} SectorHeader;
+
+/*! @brief    Positions of all SYNC marks and sector headers on a halftrack
+ *  @details  A SYNC mark begins at the bit completing a sequence of ten '1' bits and ends at
+ *            the next '0' bit. The drive raises the SYNC signal when reading the first bit and
+ *            drops it when reading the latter. All positions are bit offsets in ascending order.
+ */
+typedef struct {
+    
+    //! @brief    Indicates that the index matches the halftrack data
+    bool valid;
+    
+    //! @brief    Number of SYNC marks
+    unsigned syncs;
+    
+    //! @brief    Beginnings of all SYNC marks
+    uint16_t *syncStart;
+    
+    //! @brief    Ends of all SYNC marks
+    uint16_t *syncEnd;
+    
+    //! @brief    Number of sector headers
+    unsigned headers;
+    
+    //! @brief    Sector headers (each of them follows a SYNC mark)
+    SectorHeader *header;
+    
+} SyncIndex;
+
 
 //
 // Disk525
@@ -91,6 +133,9 @@ public:
     //! @brief    Dump debug information
     void dumpState();
     
+    //! @brief    Restores the disk from a snapshot
+    void loadFromBuffer(uint8_t **buffer);
+    
     
 private:
     
@@ -170,6 +215,12 @@ private:
      */
     bool modified;
 
+    /*! @brief   SYNC marks and sector headers of each halftrack
+     *  @details An index is built when it is accessed for the first time after the halftrack has
+     *           been loaded or written.
+     */
+    SyncIndex syncIndex[85];
+
     
 public:
     
@@ -238,6 +289,14 @@ public:
         return result;
     }
 
+    /*! @brief   Reads multiple bits from disk
+     *  @param   ht      Number of halftrack to read from
+     *  @param   offset  Position of first bit to read (first bit has offset 0)
+     *  @param   count   Number of bits to read (16 at most)
+     *  @result  The bits in reading order, the last one in bit 0
+     */
+    uint16_t readBitsFromHalftrack(Halftrack ht, unsigned offset, unsigned count);
+
     
     //
     //! @functiongroup Writing data to disk
@@ -269,7 +328,8 @@ public:
      *  @param  bit    0 for a '0' bit, every other value for a '1' bit
      */
     void writeBitToHalftrack(Halftrack ht, unsigned offset, uint8_t bit) {
-        assert(isHalftrackNumber(ht)); writeBit(data.halftrack[ht], offset % length.halftrack[ht], bit); }
+        assert(isHalftrackNumber(ht)); writeBit(data.halftrack[ht], offset % length.halftrack[ht], bit);
+        syncIndex[ht].valid = false; }
  
     /*! @brief  Writes a single byte to disk
      *  @param  data   Pointer to the first data byte of a track
@@ -329,6 +389,49 @@ public:
     void debugSyncMarks(uint8_t *data, unsigned lengthInBits);
 
     
+    //
+    //! @functiongroup Locating SYNC marks and sector headers
+    //
+    
+    /*! @brief   Returns the number of bits from a position to the beginning of the next SYNC mark
+     *  @details A SYNC mark beginning at the specified position has distance 0.
+     *  @result  UINT_MAX, if the halftrack contains no SYNC mark
+     */
+    unsigned distanceToSync(Halftrack ht, unsigned offset);
+    
+    /*! @brief   Returns the number of bits from a position to the end of the next SYNC mark
+     *  @result  UINT_MAX, if the halftrack contains no SYNC mark
+     */
+    unsigned distanceToSyncEnd(Halftrack ht, unsigned offset);
+
+    /*! @brief   Returns the number of bits from the end of the most recent SYNC mark to a position
+     *  @details A SYNC mark ending at the specified position has distance 0.
+     *  @result  UINT_MAX, if the halftrack contains no SYNC mark
+     */
+    unsigned distanceFromSyncEnd(Halftrack ht, unsigned offset);
+
+    /*! @brief   Returns the next sector header behind a position
+     *  @param   distance  Number of bits from the position to the header
+     *  @result  NULL, if the halftrack contains no sector header
+     */
+    const SectorHeader *nextSectorHeader(Halftrack ht, unsigned offset, unsigned *distance);
+    
+    //! @brief   Marks the index of all halftracks as outdated
+    void invalidateSyncIndex();
+    
+private:
+    
+    //! @brief   Returns the index of a halftrack and builds it if necessary
+    SyncIndex *getSyncIndex(Halftrack ht) {
+        assert(isHalftrackNumber(ht));
+        if (!syncIndex[ht].valid) buildSyncIndex(ht);
+        return &syncIndex[ht];
+    }
+    
+    //! @brief   Locates all SYNC marks and sector headers of a halftrack
+    void buildSyncIndex(Halftrack ht);
+
+    
     //
     //! @functiongroup Encoding disk data
     //
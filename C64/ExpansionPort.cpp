@@ -26,6 +26,7 @@ ExpansionPort::ExpansionPort()
     cartridge = NULL;
     gameLine = 1;
     exromLine = 1;
+    dma = false;
 }
 
 ExpansionPort::~ExpansionPort()
@@ -73,6 +74,7 @@ ExpansionPort::loadFromBuffer(uint8_t **buffer)
         delete cartridge;
         cartridge = NULL;
     }
+    dma = false;
     
     // Read cartridge type
     CartridgeType cartridgeType = (CartridgeType)read16(buffer);
@@ -85,6 +87,8 @@ ExpansionPort::loadFromBuffer(uint8_t **buffer)
         cartridge->loadFromBuffer(buffer);
     }
     
+    c64->mem.updateDispatchTables();
+    
     debug(2, "  Expansion port state loaded (%d bytes)\n", *buffer - old);
     assert(*buffer - old == stateSize());
 }
@@ -220,6 +224,7 @@ ExpansionPort::attachCartridge(Cartridge *c)
     
     // Reset cartridge to update exrom and game line on the expansion port
     cartridge->reset();
+    c64->selectExecutionLoop();
     
     c64->putMessage(MSG_CARTRIDGE);
     debug(1, "Cartridge attached to expansion port");
@@ -228,6 +233,17 @@ ExpansionPort::attachCartridge(Cartridge *c)
     return true;
 }
 
+bool
+ExpansionPort::attachReu(unsigned kb)
+{
+    if (!REU::isSupportedSize(kb)) {
+        warn("Cannot attach REU: Unsupported size (%d KB)\n", kb);
+        return false;
+    }
+    
+    return attachCartridge(new REU(c64, kb));
+}
+
 /*
 bool
 ExpansionPort::attachCartridge(CRTContainer *c)
@@ -252,9 +268,11 @@ ExpansionPort::detachCartridge()
     
     delete cartridge;
     cartridge = NULL;
+    dma = false;
     
     setGameLine(1);
     setExromLine(1);
+    c64->selectExecutionLoop();
 
     c64->putMessage(MSG_NO_CARTRIDGE);
     
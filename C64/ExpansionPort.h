@@ -58,6 +58,11 @@ private:
      */
     bool exromLine;
     
+    /*! @brief    Indicates that the cartridge has pulled down the DMA line
+     *  @details  While the DMA line is low, the CPU is halted and the cartridge owns the bus.
+     */
+    bool dma;
+    
 public:
     
     //! @brief    Constructor
@@ -135,12 +140,35 @@ public:
      */
     void setExromLine(bool value);
     
+    //! @brief    Returns true if the attached cartridge can pull down the DMA line
+    bool hasDMA() { return cartridge && cartridge->hasDMA(); }
+    
+    //! @brief    Returns true while the DMA line is pulled down
+    bool dmaIsActive() { return dma; }
+    
+    //! @brief    Sets the state of the DMA line (true = pulled down)
+    void setDMA(bool value) { dma = value; }
+    
+    //! @brief    Execution thread callback
+    /*! @details  This method is invoked in each cycle while the DMA line is pulled down.
+     */
+    void executeDMA() { cartridge->executeDMA(); }
+    
+    //! @brief    Returns true if the attached cartridge needs to see CPU writes into $FF00
+    bool watchesFF00() { return cartridge && cartridge->watchesFF00(); }
+    
+    //! @brief    Poke fallthrough for $FF00
+    void pokeFF00(uint8_t value) { if (cartridge) cartridge->pokeFF00(value); }
+    
     //! @brief    Returns true if a cartridge is attached to the expansion port
     bool getCartridgeAttached() { return cartridge != NULL; }
 
     //! @brief    Attaches a cartridge to the expansion port
     bool attachCartridge(Cartridge *c);
 
+    //! @brief    Attaches a RAM Expansion Unit with the specified amount of memory
+    bool attachReu(unsigned kb);
+
     //! @brief    Removes a cartridge from the expansion port (if any)
     void detachCartridge();
 
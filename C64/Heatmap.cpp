@@ -0,0 +1,155 @@
+/*!
+ * @file        Heatmap.cpp
+ * @author      Dirk W. Hoffmann, www.dirkwhoffmann.de
+ * @copyright   2018 Dirk W. Hoffmann
+ */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "Heatmap.h"
+
+Heatmap::Heatmap()
+{
+    reads = NULL;
+    writes = NULL;
+    executions = NULL;
+    firstAccess = NULL;
+    lastAccess = NULL;
+    banks = 0;
+}
+
+Heatmap::~Heatmap()
+{
+    disable();
+}
+
+void
+Heatmap::enable(uint16_t value)
+{
+    if (!isEnabled()) {
+
+        // All counters share a single allocation
+        size_t counters = 3 * 0x10000 * sizeof(uint32_t);
+        size_t cycles = 2 * 0x10000 * sizeof(uint64_t);
+        uint8_t *block = (uint8_t *)malloc(counters + cycles);
+        if (block == NULL) {
+            warn("Cannot allocate heatmap.\n");
+            return;
+        }
+
+        firstAccess = (uint64_t *)block;
+        lastAccess = firstAccess + 0x10000;
+        reads = (uint32_t *)(lastAccess + 0x10000);
+        writes = reads + 0x10000;
+        executions = writes + 0x10000;
+        clear();
+    }
+    banks = value;
+}
+
+void
+Heatmap::disable()
+{
+    // The cycle array marks the beginning of the allocated block
+    free(firstAccess);
+    reads = NULL;
+    writes = NULL;
+    executions = NULL;
+    firstAccess = NULL;
+    lastAccess = NULL;
+}
+
+void
+Heatmap::clear()
+{
+    if (!isEnabled())
+        return;
+
+    memset(firstAccess, 0, 0x10000 * sizeof(uint64_t));
+    memset(lastAccess, 0, 0x10000 * sizeof(uint64_t));
+    memset(reads, 0, 0x10000 * sizeof(uint32_t));
+    memset(writes, 0, 0x10000 * sizeof(uint32_t));
+    memset(executions, 0, 0x10000 * sizeof(uint32_t));
+}
+
+//! @brief    Writes a value in little endian byte order
+static void
+writeLE(uint8_t **ptr, uint64_t value, unsigned bytes)
+{
+    for (unsigned i = 0; i < bytes; i++)
+        *((*ptr)++) = (uint8_t)(value >> (8 * i));
+}
+
+size_t
+Heatmap::exportMap(uint8_t *buffer)
+{
+    const size_t headerSize = 16, recordSize = 30;
+    uint32_t records = 0;
+
+    for (unsigned addr = 0; addr < 0x10000; addr++) {
+        if (wasAccessed(addr)) records++;
+    }
+    if (buffer == NULL)
+        return headerSize + records * recordSize;
+
+    uint8_t *ptr = buffer;
+    memcpy(ptr, "VC64HMAP", 8); ptr += 8;
+    writeLE(&ptr, 1, 1);
+    writeLE(&ptr, 0, 1);
+    writeLE(&ptr, getBanks(), 2);
+    writeLE(&ptr, records, 4);
+
+    for (unsigned addr = 0; addr < 0x10000; addr++) {
+
+        if (!wasAccessed(addr))
+            continue;
+
+        writeLE(&ptr, addr, 2);
+        writeLE(&ptr, reads[addr], 4);
+        writeLE(&ptr, writes[addr], 4);
+        writeLE(&ptr, executions[addr], 4);
+        writeLE(&ptr, getFirstAccess(addr), 8);
+        writeLE(&ptr, getLastAccess(addr), 8);
+    }
+
+    assert((size_t)(ptr - buffer) == headerSize + records * recordSize);
+    return ptr - buffer;
+}
+
+//! @brief    Maps a counter to a brightness value (logarithmic scale)
+static uint8_t
+brightness(uint32_t count)
+{
+    unsigned bits = 0;
+    while (count) { bits++; count >>= 1; }
+    return bits ? (uint8_t)MIN(255, 56 + bits * 12) : 0;
+}
+
+void
+Heatmap::exportImage(uint32_t *pixels)
+{
+    assert(pixels != NULL);
+
+    for (unsigned addr = 0; addr < 0x10000; addr++) {
+
+        if (!isInstrumented(addr)) {
+            pixels[addr] = LO_LO_HI_HI(0x30, 0x30, 0x30, 0xFF);
+            continue;
+        }
+        pixels[addr] = LO_LO_HI_HI(brightness(writes[addr]),
+                                   brightness(reads[addr]),
+                                   brightness(executions[addr]), 0xFF);
+    }
+}
@@ -0,0 +1,151 @@
+/*!
+ * @header      Heatmap.h
+ * @author      Dirk W. Hoffmann, www.dirkwhoffmann.de
+ * @copyright   2018 Dirk W. Hoffmann
+ */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _HEATMAP_INC
+#define _HEATMAP_INC
+
+#include "VC64Object.h"
+
+/*! @class    Heatmap
+ *  @brief    Access statistics of a 64 KB address space
+ *  @details  For each address, the heatmap counts the CPU reads, writes, and opcode fetches
+ *            and records the cycles of the first and the last access. Statistics are only
+ *            gathered in instrumented banks (4 KB each). The counters are allocated when the
+ *            heatmap is enabled. The memory classes route accesses to instrumented banks
+ *            through their slow path only while the heatmap is enabled. Hence, a disabled
+ *            heatmap costs nothing.
+ */
+class Heatmap : public VC64Object {
+
+public:
+
+    //! @brief    Size of an instrumented bank
+    static const unsigned BANK_SIZE = 0x1000;
+
+    //! @brief    Width and height of the exported image (one pixel per address)
+    static const unsigned IMAGE_WIDTH = 256;
+    static const unsigned IMAGE_HEIGHT = 256;
+
+private:
+
+    //! @brief    Access counters (NULL while disabled)
+    uint32_t *reads;
+    uint32_t *writes;
+    uint32_t *executions;
+
+    //! @brief    Cycles of the first and the last access (0 = never accessed)
+    uint64_t *firstAccess;
+    uint64_t *lastAccess;
+
+    //! @brief    Instrumented banks (bit n = bank n)
+    uint16_t banks;
+
+public:
+
+    //! @brief    Constructor
+    Heatmap();
+
+    //! @brief    Destructor
+    ~Heatmap();
+
+    //! @brief    Returns true if statistics are gathered
+    bool isEnabled() { return reads != NULL; }
+
+    /*! @brief    Starts gathering statistics in the specified banks
+     *  @details  The memory classes wrap this function, because they have to update their
+     *            dispatch paths, too.
+     */
+    void enable(uint16_t banks);
+
+    //! @brief    Stops gathering statistics and frees all counters
+    void disable();
+
+    //! @brief    Resets all counters
+    void clear();
+
+    //! @brief    Returns the instrumented banks (bit n = bank n)
+    uint16_t getBanks() { return isEnabled() ? banks : 0; }
+
+    //! @brief    Returns true if accesses to the specified bank are recorded
+    bool isInstrumented(uint16_t addr) { return isEnabled() && (banks & (1 << (addr >> 12))); }
+
+
+    //
+    //! @functiongroup Recording accesses
+    //
+
+    //! @brief    Updates the first and last access cycle
+    inline void touch(uint16_t addr, uint64_t cycle) {
+        if (firstAccess[addr] == 0) firstAccess[addr] = cycle + 1;
+        lastAccess[addr] = cycle + 1;
+    }
+
+    //! @brief    Records a read access (called by the memory in instrumented banks)
+    inline void recordRead(uint16_t addr, uint64_t cycle) { reads[addr]++; touch(addr, cycle); }
+
+    //! @brief    Records a write access (called by the memory in instrumented banks)
+    inline void recordWrite(uint16_t addr, uint64_t cycle) { writes[addr]++; touch(addr, cycle); }
+
+    //! @brief    Records an opcode fetch (called by the memory in instrumented banks)
+    inline void recordExecution(uint16_t addr, uint64_t cycle) { executions[addr]++; touch(addr, cycle); }
+
+
+    //
+    //! @functiongroup Querying statistics
+    //
+
+    uint32_t getReads(uint16_t addr) { return isEnabled() ? reads[addr] : 0; }
+    uint32_t getWrites(uint16_t addr) { return isEnabled() ? writes[addr] : 0; }
+    uint32_t getExecutions(uint16_t addr) { return isEnabled() ? executions[addr] : 0; }
+
+    //! @brief    Returns true if the specified address has been accessed
+    bool wasAccessed(uint16_t addr) { return isEnabled() && firstAccess[addr] != 0; }
+
+    //! @brief    Returns the cycle of the first access (only valid if wasAccessed() is true)
+    uint64_t getFirstAccess(uint16_t addr) { return isEnabled() ? firstAccess[addr] - 1 : 0; }
+
+    //! @brief    Returns the cycle of the last access (only valid if wasAccessed() is true)
+    uint64_t getLastAccess(uint16_t addr) { return isEnabled() ? lastAccess[addr] - 1 : 0; }
+
+
+    //
+    //! @functiongroup Exporting statistics
+    //
+
+    /*! @brief    Writes all accessed addresses into a binary map
+     *  @details  The map starts with the magic bytes "VC64HMAP", a version byte (1), a reserved
+     *            byte, the instrumented banks (2 bytes), and the number of records (4 bytes).
+     *            Each record stores the address (2 bytes), the read, write, and execution counts
+     *            (4 bytes each), and the first and last access cycle (8 bytes each). All values
+     *            are stored in little endian byte order.
+     *  @param    buffer    Target buffer. If NULL, only the required size is computed.
+     *  @return   Size of the map in bytes
+     */
+    size_t exportMap(uint8_t *buffer);
+
+    /*! @brief    Renders the statistics into a 256 x 256 RGBA image
+     *  @details  Each row covers a memory page. The red, green, and blue channels show the
+     *            number of writes, reads, and executions on a logarithmic scale. Banks that are
+     *            not instrumented are drawn in dark gray.
+     */
+    void exportImage(uint32_t *pixels);
+};
+
+#endif
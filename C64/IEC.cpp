@@ -120,7 +120,10 @@ IEC::dumpTrace()
 void 
 IEC::connectDrive() 
 { 
+    c64->suspend();
 	driveConnected = true; 
+    c64->selectExecutionLoop();
+    c64->resume();
 	c64->putMessage(MSG_VC1541_ATTACHED);
     if (c64->floppy.soundMessagesEnabled())
         c64->putMessage(MSG_VC1541_ATTACHED_SOUND);
@@ -129,14 +132,19 @@ IEC::connectDrive()
 void 
 IEC::disconnectDrive()
 {
+    c64->suspend();
+
     // Disconnect drive from bus
 	driveConnected = false; 
+    c64->selectExecutionLoop();
 	c64->putMessage(MSG_VC1541_DETACHED);
     if (c64->floppy.soundMessagesEnabled())
         c64->putMessage(MSG_VC1541_DETACHED_SOUND);
 
-    // Switch drive off and on
+    // Switch drive off and on (it is not emulated until it is connected again)
     c64->floppy.powerUp();
+    
+    c64->resume();
 }
 
 /*
@@ -191,6 +199,11 @@ bool IEC::_updateIecLines()
     bool deviceAtn = (deviceBits & 0x10) ? 1 : 0;
     bool deviceClock = (deviceBits & 0x08) ? 1 : 0;
     bool deviceData = (deviceBits & 0x02) ? 1 : 0;
+    bool virtualDrive = c64->virtualDrive.isActive();
+    if (virtualDrive) {
+        deviceClock = c64->virtualDrive.getClockOut();
+        deviceData = c64->virtualDrive.getDataOut();
+    }
 
     // Get bus signals from c64 side
     uint8_t ciaBits = c64->cia2.PA;
@@ -220,10 +233,13 @@ bool IEC::_updateIecLines()
     //               ---      ----     UB1
     //               UA1      UD3
     
-    bool UA1 = !atnLine;
-    bool UD3 = UA1 ^ deviceAtn;
-    bool UB1 = !UD3;
-    dataLine &= UB1;
+    // The virtual drive acknowledges ATN by itself
+    if (!virtualDrive) {
+        bool UA1 = !atnLine;
+        bool UD3 = UA1 ^ deviceAtn;
+        bool UB1 = !UD3;
+        dataLine &= UB1;
+    }
     
     // Return true iff one of the three bus signals changed.
     return (oldAtnLine != atnLine || oldClockLine != clockLine || oldDataLine != dataLine);
@@ -237,7 +253,9 @@ void IEC::updateIecLines()
 	signals_changed = _updateIecLines();	
 
     // ATN signal is connected to CA1 pin of VIA 1
-    c64->floppy.via1.setCA1(!getAtnLine());
+    if (!c64->virtualDrive.isActive()) {
+        c64->floppy.via1.setCA1(!getAtnLine());
+    }
     
 	if (signals_changed) {
         
@@ -268,6 +286,10 @@ void IEC::updateCiaPins(uint8_t cia_data, uint8_t cia_direction)
 	ciaDataPin = (cia_data & 0x20) ? 0 : 1; // Pin and line are connected via an inverter
 		
 	updateIecLines(); 
+
+    // Let the virtual drive react to the new bus state
+    if (c64->virtualDrive.isActive())
+        c64->virtualDrive.update();
 }
 
 void IEC::updateDevicePins(uint8_t device_data, uint8_t device_direction)
@@ -308,7 +308,9 @@ typedef enum {
     SRE_ind_x, SRE_ind_x_2, SRE_ind_x_3, SRE_ind_x_4, SRE_ind_x_5, SRE_ind_x_6, SRE_ind_x_7,
     SRE_ind_y, SRE_ind_y_2, SRE_ind_y_3, SRE_ind_y_4, SRE_ind_y_5, SRE_ind_y_6, SRE_ind_y_7,
     
-    TAS_abs_y, TAS_abs_y_2, TAS_abs_y_3, TAS_abs_y_4
+    TAS_abs_y, TAS_abs_y_2, TAS_abs_y_3, TAS_abs_y_4,
+    
+    idle_loop
     
 } MicroInstruction;
 
@@ -364,6 +366,49 @@ typedef enum {
 #define CONTINUE next = (MicroInstruction)((int)next+1); return true;
 #define DONE     next = fetch; return true;
 
+#define EXECUTE_OPERATION (this->*operation[opcode])();
+#define EXECUTE_MODIFICATION (this->*modification[opcode])();
+
+/* Instructions sharing the micro instructions of their addressing mode.
+ * Each list applies x(instruction, suffix) to all of its members. E.g., the expression
+ * READ_ZPG(CASE_LABEL, _zpg_2) expands to the case labels of the second cycle of all
+ * read instructions in zero page addressing mode.
+ */
+#define CASE_LABEL(i,s) case i##s:
+
+#define READ_IMM(x,s)   x(ADC,s) x(AND,s) x(CMP,s) x(CPX,s) x(CPY,s) x(EOR,s) x(LDA,s) \
+                        x(LDX,s) x(LDY,s) x(ORA,s) x(SBC,s) x(ALR,s) x(ANC,s) x(ANE,s)
+#define READ_ZPG(x,s)   x(ADC,s) x(AND,s) x(BIT,s) x(CMP,s) x(CPX,s) x(CPY,s) x(EOR,s) \
+                        x(LDA,s) x(LDX,s) x(LDY,s) x(ORA,s) x(SBC,s) x(LAX,s) x(NOP,s)
+#define READ_ZPG_X(x,s) x(ADC,s) x(AND,s) x(CMP,s) x(EOR,s) x(LDA,s) x(LDY,s) x(ORA,s) \
+                        x(SBC,s) x(NOP,s)
+#define READ_ZPG_Y(x,s) x(LDX,s) x(LAX,s)
+#define READ_ABS(x,s)   READ_ZPG(x,s)
+#define READ_ABS_X(x,s) READ_ZPG_X(x,s)
+#define READ_ABS_Y(x,s) x(ADC,s) x(AND,s) x(CMP,s) x(EOR,s) x(LDA,s) x(LDX,s) x(ORA,s) \
+                        x(SBC,s) x(LAX,s) x(LAS,s)
+#define READ_IND_X(x,s) x(ADC,s) x(AND,s) x(CMP,s) x(EOR,s) x(LDA,s) x(ORA,s) x(SBC,s) \
+                        x(LAX,s)
+#define READ_IND_Y(x,s) READ_IND_X(x,s)
+
+#define WRITE_ZPG(x,s)   x(STA,s) x(STX,s) x(STY,s) x(SAX,s)
+#define WRITE_ZPG_X(x,s) x(STA,s) x(STY,s)
+#define WRITE_ZPG_Y(x,s) x(STX,s) x(SAX,s)
+#define WRITE_ABS(x,s)   WRITE_ZPG(x,s)
+#define WRITE_ABS_X(x,s) x(STA,s)
+#define WRITE_ABS_Y(x,s) x(STA,s)
+#define WRITE_IND_X(x,s) x(STA,s) x(SAX,s)
+#define WRITE_IND_Y(x,s) x(STA,s)
+
+#define RMW_ZPG(x,s)    x(ASL,s) x(DEC,s) x(INC,s) x(LSR,s) x(ROL,s) x(ROR,s) \
+                        x(DCP,s) x(ISC,s) x(RLA,s) x(RRA,s) x(SLO,s) x(SRE,s)
+#define RMW_ZPG_X(x,s)  RMW_ZPG(x,s)
+#define RMW_ABS(x,s)    RMW_ZPG(x,s)
+#define RMW_ABS_X(x,s)  RMW_ZPG(x,s)
+#define RMW_ABS_Y(x,s)  x(DCP,s) x(ISC,s) x(RLA,s) x(RRA,s) x(SLO,s) x(SRE,s)
+#define RMW_IND_X(x,s)  RMW_ABS_Y(x,s)
+#define RMW_IND_Y(x,s)  RMW_ABS_Y(x,s)
+
 
 //! Next microinstruction to be executed
 MicroInstruction next;
@@ -380,12 +425,22 @@ AddressingMode addressingMode[256];
 //! Static array containing all callback function
 static void (CPU::*callbacks[])(void);
 
+//! Operation that an instruction carries out on its operand
+typedef void (CPU::*Operation)();
+
+//! Operation of each instruction that shares the micro instructions of its addressing mode
+Operation operation[256];
+
+//! Modification of the operand of each read-modify-write instruction in this group
+Operation modification[256];
+
 //! Register callback function for a single opcode
 void registerCallback(uint8_t opcode, MicroInstruction mInstr);
 
 //! Register callback function for a single opcode
 void registerCallback(uint8_t opcode, const char *mnemonic,
-                      AddressingMode mode, MicroInstruction mInstr);
+                      AddressingMode mode, MicroInstruction mInstr,
+                      Operation op = NULL, Operation mod = NULL);
 
 //! Register illegal instructions
 void registerIllegalInstructions();
@@ -405,3 +460,40 @@ void cmp(uint8_t op1, uint8_t op2);
 uint8_t ror(uint8_t op);
 uint8_t rol(uint8_t op);
 
+// Operations of read instructions (applied to the read value)
+void opADC();
+void opAND();
+void opBIT();
+void opCMP();
+void opCPX();
+void opCPY();
+void opEOR();
+void opLDA();
+void opLDX();
+void opLDY();
+void opORA();
+void opSBC();
+void opALR();
+void opANC();
+void opANE();
+void opLAS();
+void opLAX();
+void opNOP();
+
+// Operations of write instructions (compute the value to write)
+void opSTA();
+void opSTX();
+void opSTY();
+void opSAX();
+
+// Modifications of read-modify-write instructions (applied before the final write)
+void opASL();
+void opDEC();
+void opINC();
+void opLSR();
+void opROL();
+void opROR();
+
+// Operation of the legal read-modify-write instructions (applied after the final write)
+void opNZ();
+
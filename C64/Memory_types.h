@@ -22,7 +22,21 @@ typedef enum {
     M_CRTLO,
     M_CRTHI,
     M_PP,
-    M_NONE
+    M_NONE,
+    M_TRACED    //! Bank with observed accesses (never stored in peekSrc or pokeTarget)
 } MemorySource;
 
+//! @brief    Conditions a candidate has to satisfy to survive a RAM search filter pass
+typedef enum {
+    SEARCH_EQUAL = 0,       //! Value equals the reference value
+    SEARCH_NOT_EQUAL,       //! Value differs from the reference value
+    SEARCH_LESS,            //! Value is less than the reference value
+    SEARCH_GREATER,         //! Value is greater than the reference value
+    SEARCH_UNCHANGED,       //! Value equals the previously captured value
+    SEARCH_CHANGED,         //! Value differs from the previously captured value
+    SEARCH_INCREASED,       //! Value is greater than the previously captured value
+    SEARCH_DECREASED,       //! Value is less than the previously captured value
+    SEARCH_CHANGED_BY       //! Value minus the previously captured value equals the reference value
+} RamSearchCondition;
+
 #endif
@@ -29,6 +29,13 @@ PixelEngine::PixelEngine()
     currentScreenBuffer = screenBuffer1[0];
     pixelBuffer = currentScreenBuffer;
     bufferoffset = 0;
+    
+    currentDirtyLines = dirtyLines1;
+    comparedLines = 0;
+    memset(dirtyLines1, 0xFF, sizeof(dirtyLines1));
+    memset(dirtyLines2, 0xFF, sizeof(dirtyLines2));
+    frameCounter = 0;
+    frameStamp1 = frameStamp2 = 0;
 
     // Register snapshot items
     SnapshotItem items[] = {
@@ -78,12 +85,32 @@ PixelEngine::resetScreenBuffers()
             screenBuffer1[line][i] = screenBuffer2[line][i] = (line % 2) ? colors[8] : colors[9];
         }
     }
+    
+    // Force consumers to pick up the whole buffer
+    memset(dirtyLines1, 0xFF, sizeof(dirtyLines1));
+    memset(dirtyLines2, 0xFF, sizeof(dirtyLines2));
+    frameStamp1 = frameStamp2 = ++frameCounter;
+}
+
+void
+PixelEngine::markDirtyLine(unsigned line)
+{
+    assert(line < PAL_RASTERLINES);
+    
+    int *other = (currentScreenBuffer == screenBuffer1[0]) ? screenBuffer2[0] : screenBuffer1[0];
+    size_t offset = line * NTSC_PIXELS;
+    
+    if (memcmp(currentScreenBuffer + offset, other + offset, NTSC_PIXELS * sizeof(int)) != 0)
+        currentDirtyLines[line / 64] |= (uint64_t)1 << (line % 64);
 }
 
 void
 PixelEngine::beginFrame()
 {
     visibleColumn = false;
+    
+    memset(currentDirtyLines, 0, sizeof(dirtyLines1));
+    comparedLines = 0;
 }
 
 void
@@ -125,6 +152,11 @@ PixelEngine::endRasterline()
         // Make the border look nice
         expandBorders();
         
+        // Check if the line has changed compared to the previous frame
+        uint16_t line = (pixelBuffer - currentScreenBuffer) / NTSC_PIXELS;
+        markDirtyLine(line);
+        comparedLines = line + 1;
+        
         // Advance pixelBuffer
         uint16_t nextline = c64->getRasterline() - PAL_UPPER_VBLANK + 1;
         if (nextline < PAL_RASTERLINES) {
@@ -144,8 +176,20 @@ PixelEngine::endRasterline()
 void
 PixelEngine::endFrame()
 {
+    // Lines that have not been drawn (NTSC) keep the contents of an older frame
+    for (unsigned line = comparedLines; line < PAL_RASTERLINES; line++)
+        markDirtyLine(line);
+    
+    // Stamp the finished buffer
+    if (currentScreenBuffer == screenBuffer1[0]) {
+        frameStamp1 = ++frameCounter;
+    } else {
+        frameStamp2 = ++frameCounter;
+    }
+    
     // Switch active screen buffer
     currentScreenBuffer = (currentScreenBuffer == screenBuffer1[0]) ? screenBuffer2[0] : screenBuffer1[0];
+    currentDirtyLines = (currentDirtyLines == dirtyLines1) ? dirtyLines2 : dirtyLines1;
     pixelBuffer = currentScreenBuffer;    
 }
 
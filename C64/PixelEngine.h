@@ -150,6 +150,33 @@ private:
      */
     int *currentScreenBuffer;
     
+    /*! @brief    Dirty rasterline maps of both screen buffers
+     *  @details  Bit n is set if rasterline n of the buffer differs from the same line in the
+     *            other buffer, i.e., if it changed compared to the previous frame. The maps are
+     *            filled while a frame is drawn and are stable while the buffer is stable.
+     */
+    uint64_t dirtyLines1[(PAL_RASTERLINES + 63) / 64];
+    uint64_t dirtyLines2[(PAL_RASTERLINES + 63) / 64];
+    
+    //! @brief    Dirty rasterline map of the current screen buffer
+    uint64_t *currentDirtyLines;
+    
+    //! @brief    Number of leading rasterlines already compared in the current frame
+    uint16_t comparedLines;
+    
+    /*! @brief    Number of completed frames
+     *  @details  Unlike the frame counter of the C64, this counter is never reset or restored
+     *            from a snapshot. Hence, it always matches the contents of the screen buffers.
+     */
+    uint64_t frameCounter;
+    
+    /*! @brief    Frame stamps of both screen buffers
+     *  @details  Value of frameCounter when the buffer has been completed. A stamp of 0
+     *            indicates that the buffer contents is unrelated to the other buffer.
+     */
+    uint64_t frameStamp1;
+    uint64_t frameStamp2;
+    
     /*! @brief    Pointer to the beginning of the current rasterline
      *  @details  This pointer is used by all rendering methods to write pixels. It always points 
      *            to the beginning of a rasterline, either in screenBuffer1 or screenBuffer2. 
@@ -178,6 +205,9 @@ private:
      */
     short bufferoffset;
     
+    //! @brief    Compares a rasterline of the current buffer with the previous frame
+    void markDirtyLine(unsigned line);
+    
 public:
     
     /*! @brief    Get screen buffer that is currently stable
@@ -187,6 +217,21 @@ public:
         return (currentScreenBuffer == screenBuffer1[0]) ? screenBuffer2[0] : screenBuffer1[0];
     }
 
+    /*! @brief    Get dirty rasterline map of the stable screen buffer
+     *  @details  The map has one bit per rasterline (least significant bit first). A set bit
+     *            indicates that the line differs from the frame drawn before. If a consumer has
+     *            seen exactly that previous frame (screenBufferFrame() - 1), it only needs to
+     *            copy the dirty lines. Otherwise, it has to copy the whole buffer.
+     */
+    uint64_t *screenBufferDirtyLines() {
+        return (currentScreenBuffer == screenBuffer1[0]) ? dirtyLines2 : dirtyLines1;
+    }
+    
+    //! @brief    Get frame stamp of the stable screen buffer (0 = unknown)
+    uint64_t screenBufferFrame() {
+        return (currentScreenBuffer == screenBuffer1[0]) ? frameStamp2 : frameStamp1;
+    }
+
     
     // ------------------------------------------------------------------------------------------
     //                                  Rastercycle information
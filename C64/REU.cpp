@@ -0,0 +1,622 @@
+/*!
+ * @author      Dirk W. Hoffmann, www.dirkwhoffmann.de
+ * @copyright   2018 Dirk W. Hoffmann
+ */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "C64.h"
+
+// Status register
+#define REU_IRQ_PENDING  0x80
+#define REU_END_OF_BLOCK 0x40
+#define REU_FAULT        0x20
+#define REU_SIZE_256K    0x10
+
+// Command register
+#define REU_EXECUTE      0x80
+#define REU_AUTOLOAD     0x20
+#define REU_NO_FF00      0x10
+
+// Address control register
+#define REU_FIX_C64      0x80
+#define REU_FIX_REU      0x40
+
+REU::REU(C64 *c64, unsigned kb) : Cartridge(c64)
+{
+    setDescription("REU");
+    debug(1, "  Creating REU (%d KB)...\n", kb);
+
+    assert(isSupportedSize(kb));
+    size = kb * 1024;
+    addrMask = (size <= 0x80000) ? 0x7FFFF : 0xFFFFFF;
+    ram = (uint8_t *)calloc(size, 1);
+    dirty = (uint8_t *)calloc(size / PAGE_SIZE, 1);
+}
+
+REU::~REU()
+{
+    debug(1, "  Releasing REU...\n");
+
+    free(ram);
+    free(dirty);
+}
+
+bool
+REU::isSupportedSize(unsigned kb)
+{
+    // 1700, 1764, 1750, and clones up to 16 MB
+    return kb >= 128 && kb <= 16384 && (kb & (kb - 1)) == 0;
+}
+
+void
+REU::reset()
+{
+    Cartridge::reset();
+
+    // The expansion RAM survives a reset
+    status = 0;
+    command = REU_NO_FF00;
+    c64Addr = c64Base = 0;
+    reuAddr = reuBase = 0;
+    length = lengthBase = 0xFFFF;
+    irqMask = 0;
+    addrControl = 0;
+
+    active = false;
+    bulk = false;
+    dmaCycles = 0;
+    result = 0;
+    swapPhase = 0;
+    latchC64 = latchReu = 0;
+
+    c64->expansionport.setDMA(false);
+    c64->cpu.releaseIrqLine(CPU::EXPANSION);
+}
+
+unsigned
+REU::numberOfDirtyPages()
+{
+    unsigned result = 0;
+
+    for (unsigned i = 0; i < size / PAGE_SIZE; i++)
+        if (dirty[i]) result++;
+
+    return result;
+}
+
+size_t
+REU::stateSize()
+{
+    return Cartridge::stateSize()
+    + 4 + size / PAGE_SIZE + numberOfDirtyPages() * PAGE_SIZE // Memory
+    + 4 * sizeof(uint8_t) + 4 * sizeof(uint16_t) + 2 * sizeof(uint32_t) // Registers
+    + 2 * sizeof(uint8_t) + sizeof(uint32_t) + 4 * sizeof(uint8_t); // DMA engine
+}
+
+void
+REU::loadFromBuffer(uint8_t **buffer)
+{
+    uint8_t *old = *buffer;
+
+    Cartridge::loadFromBuffer(buffer);
+
+    // Memory (only written pages are stored)
+    uint32_t newSize = read32(buffer);
+    if (newSize != size) {
+        free(ram);
+        free(dirty);
+        size = newSize;
+        addrMask = (size <= 0x80000) ? 0x7FFFF : 0xFFFFFF;
+        ram = (uint8_t *)malloc(size);
+        dirty = (uint8_t *)malloc(size / PAGE_SIZE);
+    }
+    readBlock(buffer, dirty, size / PAGE_SIZE);
+    for (unsigned i = 0; i < size / PAGE_SIZE; i++) {
+        if (dirty[i]) {
+            readBlock(buffer, ram + i * PAGE_SIZE, PAGE_SIZE);
+        } else {
+            memset(ram + i * PAGE_SIZE, 0, PAGE_SIZE);
+        }
+    }
+
+    // Registers
+    status = read8(buffer);
+    command = read8(buffer);
+    c64Addr = read16(buffer);
+    reuAddr = read32(buffer);
+    length = read16(buffer);
+    c64Base = read16(buffer);
+    reuBase = read32(buffer);
+    lengthBase = read16(buffer);
+    irqMask = read8(buffer);
+    addrControl = read8(buffer);
+
+    // DMA engine
+    active = (bool)read8(buffer);
+    bulk = (bool)read8(buffer);
+    dmaCycles = read32(buffer);
+    result = read8(buffer);
+    swapPhase = read8(buffer);
+    latchC64 = read8(buffer);
+    latchReu = read8(buffer);
+
+    c64->expansionport.setDMA(active);
+
+    debug(2, "  REU state loaded (%d bytes)\n", *buffer - old);
+    assert(*buffer - old == stateSize());
+}
+
+void
+REU::saveToBuffer(uint8_t **buffer)
+{
+    uint8_t *old = *buffer;
+
+    Cartridge::saveToBuffer(buffer);
+
+    // Memory (only written pages are stored)
+    write32(buffer, size);
+    writeBlock(buffer, dirty, size / PAGE_SIZE);
+    for (unsigned i = 0; i < size / PAGE_SIZE; i++) {
+        if (dirty[i]) writeBlock(buffer, ram + i * PAGE_SIZE, PAGE_SIZE);
+    }
+
+    // Registers
+    write8(buffer, status);
+    write8(buffer, command);
+    write16(buffer, c64Addr);
+    write32(buffer, reuAddr);
+    write16(buffer, length);
+    write16(buffer, c64Base);
+    write32(buffer, reuBase);
+    write16(buffer, lengthBase);
+    write8(buffer, irqMask);
+    write8(buffer, addrControl);
+
+    // DMA engine
+    write8(buffer, (uint8_t)active);
+    write8(buffer, (uint8_t)bulk);
+    write32(buffer, dmaCycles);
+    write8(buffer, result);
+    write8(buffer, swapPhase);
+    write8(buffer, latchC64);
+    write8(buffer, latchReu);
+
+    debug(4, "  REU state saved (%d bytes)\n", *buffer - old);
+    assert(*buffer - old == stateSize());
+}
+
+void
+REU::dumpState()
+{
+    msg("\n");
+    msg("REU\n");
+    msg("---\n");
+
+    msg("Expansion RAM:     %d KB (%d pages written)\n", size / 1024, numberOfDirtyPages());
+    msg("Status:            %02X\n", status);
+    msg("Command:           %02X\n", command);
+    msg("C64 address:       %04X (base %04X)\n", c64Addr, c64Base);
+    msg("REU address:       %06X (base %06X)\n", reuAddr, reuBase);
+    msg("Transfer length:   %04X (base %04X)\n", length, lengthBase);
+    msg("Interrupt mask:    %02X\n", irqMask);
+    msg("Address control:   %02X\n", addrControl);
+    msg("Transfer running:  %s%s\n", active ? "yes" : "no", active && bulk ? " (bulk)" : "");
+}
+
+
+//
+//! @functiongroup Accessing the registers
+//
+
+uint8_t
+REU::peekIO1(uint16_t addr)
+{
+    return c64->vic.prevDataBus;
+}
+
+uint8_t
+REU::readIO1(uint16_t addr)
+{
+    return c64->vic.prevDataBus;
+}
+
+uint8_t
+REU::peekIO2(uint16_t addr)
+{
+    uint8_t result = readIO2(addr);
+
+    // Reading the status register clears the interrupt and transfer bits
+    if ((addr & 0x1F) == 0x00) {
+        status = 0;
+        c64->cpu.releaseIrqLine(CPU::EXPANSION);
+    }
+
+    return result;
+}
+
+uint8_t
+REU::readIO2(uint16_t addr)
+{
+    switch (addr & 0x1F) {
+
+        case 0x00:
+            return status | (size > 0x20000 ? REU_SIZE_256K : 0x00);
+        case 0x01:
+            return command | 0x4C;
+        case 0x02:
+            return LO_BYTE(c64Addr);
+        case 0x03:
+            return HI_BYTE(c64Addr);
+        case 0x04:
+            return LO_BYTE(reuAddr);
+        case 0x05:
+            return HI_BYTE(reuAddr);
+        case 0x06:
+            return (uint8_t)(reuAddr >> 16) | (addrMask == 0x7FFFF ? 0xF8 : 0x00);
+        case 0x07:
+            return LO_BYTE(length);
+        case 0x08:
+            return HI_BYTE(length);
+        case 0x09:
+            return irqMask | 0x1F;
+        case 0x0A:
+            return addrControl | 0x3F;
+        default:
+            return 0xFF;
+    }
+}
+
+void
+REU::pokeIO2(uint16_t addr, uint8_t value)
+{
+    // The registers can't be written while the REU holds the bus
+    if (active)
+        return;
+
+    // Writing an address or length register sets the counter and the autoload value
+    switch (addr & 0x1F) {
+
+        case 0x01:
+            command = value;
+            if ((command & (REU_EXECUTE | REU_NO_FF00)) == (REU_EXECUTE | REU_NO_FF00)) {
+                startTransfer();
+            }
+            c64->mem.updateDispatchTables();
+            break;
+        case 0x02:
+            c64Base = (c64Base & 0xFF00) | value;
+            c64Addr = c64Base;
+            break;
+        case 0x03:
+            c64Base = (c64Base & 0x00FF) | (value << 8);
+            c64Addr = c64Base;
+            break;
+        case 0x04:
+            reuBase = (reuBase & 0xFFFF00) | value;
+            reuAddr = reuBase;
+            break;
+        case 0x05:
+            reuBase = (reuBase & 0xFF00FF) | (value << 8);
+            reuAddr = reuBase;
+            break;
+        case 0x06:
+            reuBase = ((reuBase & 0x00FFFF) | (value << 16)) & addrMask;
+            reuAddr = reuBase;
+            break;
+        case 0x07:
+            lengthBase = (lengthBase & 0xFF00) | value;
+            length = lengthBase;
+            break;
+        case 0x08:
+            lengthBase = (lengthBase & 0x00FF) | (value << 8);
+            length = lengthBase;
+            break;
+        case 0x09:
+            irqMask = value & 0xE0;
+            updateIrq();
+            break;
+        case 0x0A:
+            addrControl = value & 0xC0;
+            break;
+        default:
+            break;
+    }
+}
+
+void
+REU::pokeFF00(uint8_t value)
+{
+    if (watchesFF00()) {
+        startTransfer();
+        c64->mem.updateDispatchTables();
+    }
+}
+
+
+//
+//! @functiongroup Performing DMA
+//
+
+void
+REU::startTransfer()
+{
+    uint32_t count = length ? length : 0x10000;
+
+    active = true;
+    swapPhase = 0;
+    bulk = canTransferInBulk(count);
+    if (bulk) {
+        dmaCycles = transferInBulk(count);
+    }
+
+    c64->expansionport.setDMA(true);
+}
+
+bool
+REU::canTransferInBulk(uint32_t count)
+{
+    TransferType type = (TransferType)(command & 0x03);
+    bool reads = (type != FETCH);
+    bool writes = (type == FETCH || type == SWAP);
+
+    if (addrControl & REU_FIX_C64)
+        count = 1;
+
+    // Collect the banks touched on the C64 side
+    uint16_t banks = 0;
+    if (count > 0xF000) {
+        banks = 0xFFFF;
+    } else {
+        uint16_t first = c64Addr >> 12, last = (uint16_t)(c64Addr + count - 1) >> 12;
+        for (unsigned i = first; ; i = (i + 1) & 0xF) {
+            banks |= 1 << i;
+            if (i == last) break;
+        }
+    }
+
+    // The processor port has side effects
+    if ((uint16_t)(0x0000 - c64Addr) < count || (uint16_t)(0x0001 - c64Addr) < count)
+        return false;
+
+    // Writes must not show up on the screen before they would have been performed
+    if (writes) {
+        uint16_t vicBanks = 0xF << (c64->vic.getMemoryBankAddr() >> 12);
+        if (banks & vicBanks)
+            return false;
+    }
+
+    for (unsigned i = 0; i < 16; i++) {
+
+        if (!(banks & (1 << i)))
+            continue;
+
+        MemorySource src = c64->mem.peekSource(i << 12);
+        MemorySource target = c64->mem.pokeTargetOf(i << 12);
+
+        if (reads && src != M_RAM && src != M_ROM && src != M_PP && src != M_NONE)
+            return false;
+        if (writes && target != M_RAM && target != M_PP)
+            return false;
+    }
+
+    return true;
+}
+
+uint32_t
+REU::transferInBulk(uint32_t count)
+{
+    TransferType type = (TransferType)(command & 0x03);
+    bool fixC64 = addrControl & REU_FIX_C64;
+    bool fixReu = addrControl & REU_FIX_REU;
+    uint8_t *c64ram = c64->mem.ram;
+    uint8_t buffer[0x1000];
+    uint32_t done = 0;
+
+    result = 0;
+
+    while (done < count) {
+
+        // Split the transfer into chunks that neither cross a C64 bank nor the end of RAM
+        uint32_t chunk = count - done;
+        uint32_t reuOffset = reuAddr & (size - 1);
+        if (!fixC64) chunk = MIN(chunk, 0x1000 - (c64Addr & 0xFFF));
+        if (!fixReu) chunk = MIN(chunk, size - reuOffset);
+
+        uint8_t *src = (c64->mem.peekSource(c64Addr) == M_ROM) ? c64->mem.rom : c64ram;
+        uint8_t *c64ptr = src + c64Addr;
+        uint8_t *reuptr = ram + reuOffset;
+
+        switch (type) {
+
+            case STASH:
+
+                if (fixReu) {
+                    *reuptr = fixC64 ? *c64ptr : c64ptr[chunk - 1];
+                } else if (fixC64) {
+                    memset(reuptr, *c64ptr, chunk);
+                } else {
+                    memcpy(reuptr, c64ptr, chunk);
+                }
+                markDirty(reuOffset, fixReu ? 1 : chunk);
+                break;
+
+            case FETCH:
+
+                c64ptr = c64ram + c64Addr;
+                if (fixC64) {
+                    *c64ptr = fixReu ? *reuptr : reuptr[chunk - 1];
+                } else if (fixReu) {
+                    memset(c64ptr, *reuptr, chunk);
+                } else {
+                    memcpy(c64ptr, reuptr, chunk);
+                }
+                break;
+
+            case SWAP:
+
+                if (!fixC64 && !fixReu) {
+                    memcpy(buffer, c64ptr, chunk);
+                    memcpy(c64ram + c64Addr, reuptr, chunk);
+                    memcpy(reuptr, buffer, chunk);
+                } else {
+                    for (uint32_t i = 0; i < chunk; i++) {
+                        uint8_t *c = c64ptr + (fixC64 ? 0 : i);
+                        uint8_t *r = reuptr + (fixReu ? 0 : i);
+                        uint8_t value = *c;
+                        c64ram[c - src] = *r;
+                        *r = value;
+                    }
+                }
+                markDirty(reuOffset, fixReu ? 1 : chunk);
+                break;
+
+            case VERIFY:
+
+                for (uint32_t i = 0; i < chunk; i++) {
+                    if (c64ptr[fixC64 ? 0 : i] != reuptr[fixReu ? 0 : i]) {
+
+                        // The transfer stops after the first difference
+                        result |= REU_FAULT;
+                        advance(i + 1);
+                        done += i + 1;
+                        if (done == count) result |= REU_END_OF_BLOCK;
+                        return done;
+                    }
+                }
+                break;
+        }
+
+        advance(chunk);
+        done += chunk;
+    }
+
+    result |= REU_END_OF_BLOCK;
+    return type == SWAP ? 2 * count : count;
+}
+
+void
+REU::advance(uint32_t bytes)
+{
+    if (!(addrControl & REU_FIX_C64))
+        c64Addr += bytes;
+    if (!(addrControl & REU_FIX_REU))
+        reuAddr = (reuAddr + bytes) & addrMask;
+
+    // The length counter stops at 1
+    uint32_t count = length ? length : 0x10000;
+    length = (bytes >= count) ? 1 : (uint16_t)(count - bytes);
+}
+
+void
+REU::executeDMA()
+{
+    // The REU has to wait while VIC holds the bus
+    if (c64->vic.BAlow)
+        return;
+
+    if (bulk) {
+        if (--dmaCycles == 0) finishTransfer(result);
+    } else {
+        transferByte();
+    }
+}
+
+void
+REU::transferByte()
+{
+    TransferType type = (TransferType)(command & 0x03);
+    uint8_t value;
+
+    switch (type) {
+
+        case STASH:
+            writeRam(reuAddr, c64->mem.peekDma(c64Addr));
+            break;
+
+        case FETCH:
+            c64->mem.pokeDma(c64Addr, readRam(reuAddr));
+            break;
+
+        case SWAP:
+            if (swapPhase == 0) {
+                latchC64 = c64->mem.peekDma(c64Addr);
+                latchReu = readRam(reuAddr);
+                swapPhase = 1;
+                return;
+            }
+            c64->mem.pokeDma(c64Addr, latchReu);
+            writeRam(reuAddr, latchC64);
+            swapPhase = 0;
+            break;
+
+        case VERIFY:
+            value = c64->mem.peekDma(c64Addr);
+            if (value != readRam(reuAddr)) {
+                bool last = (length == 1);
+                advance(1);
+                finishTransfer(REU_FAULT | (last ? REU_END_OF_BLOCK : 0));
+                return;
+            }
+            break;
+    }
+
+    if (length == 1) {
+        advance(1);
+        finishTransfer(REU_END_OF_BLOCK);
+    } else {
+        advance(1);
+    }
+}
+
+void
+REU::finishTransfer(uint8_t statusBits)
+{
+    status |= statusBits;
+
+    if (command & REU_AUTOLOAD) {
+        c64Addr = c64Base;
+        reuAddr = reuBase;
+        length = lengthBase;
+    }
+
+    // The transfer clears the execute bit and disables the $FF00 trigger
+    command = (command & ~REU_EXECUTE) | REU_NO_FF00;
+    active = false;
+    bulk = false;
+
+    c64->expansionport.setDMA(false);
+    c64->mem.updateDispatchTables();
+    updateIrq();
+}
+
+void
+REU::updateIrq()
+{
+    if (!(irqMask & REU_IRQ_PENDING))
+        return;
+
+    if (status & irqMask & (REU_END_OF_BLOCK | REU_FAULT)) {
+        status |= REU_IRQ_PENDING;
+        c64->cpu.pullDownIrqLine(CPU::EXPANSION);
+    }
+}
+
+void
+REU::markDirty(uint32_t addr, uint32_t count)
+{
+    for (uint32_t page = addr / PAGE_SIZE; page <= (addr + count - 1) / PAGE_SIZE; page++)
+        dirty[page] = 1;
+}
@@ -0,0 +1,229 @@
+/*!
+ * @header      REU.h
+ * @author      Dirk W. Hoffmann, www.dirkwhoffmann.de
+ * @copyright   2018 Dirk W. Hoffmann
+ */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * For more information: Commodore 1700/1750 RAM Expansion Module User's Guide
+ *
+ * Register map ($DF00 - $DF0A, repeated every 32 bytes in I/O space 2):
+ *
+ *   $DF00  Status        (IRQ pending, end of block, verify error, size, version)
+ *   $DF01  Command       (execute, autoload, $FF00 trigger disable, transfer type)
+ *   $DF02  C64 base address (low, high)
+ *   $DF04  REU base address (low, high, bank)
+ *   $DF07  Transfer length  (low, high, 0 = 64 KB)
+ *   $DF09  Interrupt mask
+ *   $DF0A  Address control (fix C64 address, fix REU address)
+ */
+
+#ifndef _REU_INC
+#define _REU_INC
+
+#include "Cartridge.h"
+
+/*! @class    REU
+ *  @brief    Commodore RAM Expansion Unit (1700, 1764, 1750, and larger clones)
+ *  @details  The REU moves data between its own RAM and the C64's address space by DMA. While
+ *            a transfer is running, the REU pulls down the DMA line and the CPU is halted. The
+ *            REU transfers one byte per cycle (two for swaps) and pauses while VIC holds the bus.
+ *            Transfers that can't be observed by the rest of the machine are performed in bulk
+ *            when they start. This applies to transfers touching RAM and ROM only, outside of
+ *            the memory bank VIC is currently reading from. The REU still holds the bus for the
+ *            duration of the transfer, so the timing seen by the C64 does not change. All other
+ *            transfers (e.g., into I/O space or screen memory) are executed byte by byte.
+ *            Snapshots only contain the REU pages that have been written since power-up.
+ */
+class REU : public Cartridge {
+
+public:
+
+    //! @brief    Size of a page of REU memory (used to track written memory)
+    static const uint32_t PAGE_SIZE = 0x1000;
+
+private:
+
+    //! @brief    Transfer types (bits 0 and 1 of the command register)
+    typedef enum { STASH = 0, FETCH = 1, SWAP = 2, VERIFY = 3 } TransferType;
+
+    //! @brief    Expansion RAM
+    uint8_t *ram;
+
+    //! @brief    Size of the expansion RAM in bytes (power of two)
+    uint32_t size;
+
+    //! @brief    Mask applied to the REU address counter (19 or 24 bits)
+    uint32_t addrMask;
+
+    //! @brief    Indicates which pages have been written since power-up
+    uint8_t *dirty;
+
+
+    //
+    // Registers
+    //
+
+    //! @brief    Status register (bits 7 - 5)
+    uint8_t status;
+
+    //! @brief    Command register
+    uint8_t command;
+
+    //! @brief    Address and length counters
+    uint16_t c64Addr;
+    uint32_t reuAddr;
+    uint16_t length;
+
+    //! @brief    Values reloaded into the counters if autoload is enabled
+    uint16_t c64Base;
+    uint32_t reuBase;
+    uint16_t lengthBase;
+
+    //! @brief    Interrupt mask register (bits 7 - 5)
+    uint8_t irqMask;
+
+    //! @brief    Address control register (bits 7 and 6)
+    uint8_t addrControl;
+
+
+    //
+    // DMA engine
+    //
+
+    //! @brief    Indicates that a transfer is running
+    bool active;
+
+    //! @brief    Indicates that the running transfer has been performed in bulk
+    bool bulk;
+
+    //! @brief    Remaining bus cycles of a bulk transfer
+    uint32_t dmaCycles;
+
+    //! @brief    Status bits that are set when a bulk transfer ends
+    uint8_t result;
+
+    //! @brief    Swap transfers read in the first and write in the second cycle
+    uint8_t swapPhase;
+
+    //! @brief    Bytes read in the first cycle of a swap
+    uint8_t latchC64;
+    uint8_t latchReu;
+
+public:
+
+    //! @brief    Constructor
+    REU(C64 *c64, unsigned kb = 512);
+
+    //! @brief    Destructor
+    ~REU();
+
+    //! @brief    Returns true if the REU can be built with the specified amount of RAM
+    static bool isSupportedSize(unsigned kb);
+
+    //! @brief    Method from VirtualComponent
+    void reset();
+
+    //! @brief    Method from VirtualComponent
+    size_t stateSize();
+
+    //! @brief    Method from VirtualComponent
+    void loadFromBuffer(uint8_t **buffer);
+
+    //! @brief    Method from VirtualComponent
+    void saveToBuffer(uint8_t **buffer);
+
+    //! @brief    Method from VirtualComponent
+    void dumpState();
+
+    //! @brief    Method from Cartridge
+    CartridgeType getCartridgeType() { return CRT_REU; }
+
+    //! @brief    Returns the size of the expansion RAM in KB
+    unsigned getSizeInKB() { return size / 1024; }
+
+    //! @brief    Returns the number of pages that have been written since power-up
+    unsigned numberOfDirtyPages();
+
+    //! @brief    Reads a byte from expansion RAM (for debugging)
+    uint8_t spy(uint32_t addr) { return ram[addr & (size - 1)]; }
+
+
+    //
+    //! @functiongroup Accessing the registers
+    //
+
+    uint8_t peekIO1(uint16_t addr);
+    uint8_t readIO1(uint16_t addr);
+    uint8_t peekIO2(uint16_t addr);
+    uint8_t readIO2(uint16_t addr);
+    void pokeIO2(uint16_t addr, uint8_t value);
+
+    //! @brief    Returns true if a transfer waits for a write into $FF00
+    bool watchesFF00() { return !active && (command & 0x90) == 0x80; }
+
+    //! @brief    Starts a transfer that waits for a write into $FF00
+    void pokeFF00(uint8_t value);
+
+
+    //
+    //! @functiongroup Performing DMA
+    //
+
+    //! @brief    Method from Cartridge
+    bool hasDMA() { return true; }
+
+    //! @brief    Method from Cartridge (invoked in each cycle while the DMA line is low)
+    void executeDMA();
+
+private:
+
+    //! @brief    Starts the transfer described by the registers
+    void startTransfer();
+
+    //! @brief    Checks if the transfer can be performed in bulk
+    bool canTransferInBulk(uint32_t count);
+
+    /*! @brief    Performs the whole transfer at once
+     *  @return   Number of bus cycles the transfer takes
+     */
+    uint32_t transferInBulk(uint32_t count);
+
+    //! @brief    Transfers a single byte (or the first half of a swap)
+    void transferByte();
+
+    //! @brief    Advances the address counters by the specified number of bytes
+    void advance(uint32_t bytes);
+
+    //! @brief    Ends the transfer and sets the status bits
+    void finishTransfer(uint8_t statusBits);
+
+    //! @brief    Triggers an interrupt if an unmasked status bit is set
+    void updateIrq();
+
+    //! @brief    Writes a byte into expansion RAM
+    void writeRam(uint32_t addr, uint8_t value) {
+        addr &= size - 1; ram[addr] = value; dirty[addr / PAGE_SIZE] = 1; }
+
+    //! @brief    Reads a byte from expansion RAM
+    uint8_t readRam(uint32_t addr) { return ram[addr & (size - 1)]; }
+
+    //! @brief    Marks the pages covering the specified range as written
+    void markDirty(uint32_t addr, uint32_t count);
+};
+
+#endif
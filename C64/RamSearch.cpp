@@ -0,0 +1,181 @@
+/*!
+ * @file        RamSearch.cpp
+ * @author      Dirk W. Hoffmann, www.dirkwhoffmann.de
+ * @copyright   2018 Dirk W. Hoffmann
+ */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "C64Memory.h"
+#include "RamSearch.h"
+
+/*! @brief    Clears the mask entries of all values that violate a condition
+ *  @details  The loops are branch free to let the compiler vectorize them.
+ */
+template <typename T> static void
+narrow(uint8_t *mask, const T *cur, const T *prev, T value, RamSearchCondition condition)
+{
+    const unsigned n = 0x10000;
+
+    switch (condition) {
+
+        case SEARCH_EQUAL:
+            for (unsigned i = 0; i < n; i++) mask[i] &= -(uint8_t)(cur[i] == value);
+            break;
+        case SEARCH_NOT_EQUAL:
+            for (unsigned i = 0; i < n; i++) mask[i] &= -(uint8_t)(cur[i] != value);
+            break;
+        case SEARCH_LESS:
+            for (unsigned i = 0; i < n; i++) mask[i] &= -(uint8_t)(cur[i] < value);
+            break;
+        case SEARCH_GREATER:
+            for (unsigned i = 0; i < n; i++) mask[i] &= -(uint8_t)(cur[i] > value);
+            break;
+        case SEARCH_UNCHANGED:
+            for (unsigned i = 0; i < n; i++) mask[i] &= -(uint8_t)(cur[i] == prev[i]);
+            break;
+        case SEARCH_CHANGED:
+            for (unsigned i = 0; i < n; i++) mask[i] &= -(uint8_t)(cur[i] != prev[i]);
+            break;
+        case SEARCH_INCREASED:
+            for (unsigned i = 0; i < n; i++) mask[i] &= -(uint8_t)(cur[i] > prev[i]);
+            break;
+        case SEARCH_DECREASED:
+            for (unsigned i = 0; i < n; i++) mask[i] &= -(uint8_t)(cur[i] < prev[i]);
+            break;
+        case SEARCH_CHANGED_BY:
+            for (unsigned i = 0; i < n; i++) mask[i] &= -(uint8_t)((T)(cur[i] - prev[i]) == value);
+            break;
+        default:
+            assert(false);
+    }
+}
+
+RamSearch::RamSearch(C64Memory *mem, unsigned width)
+{
+    assert(mem != NULL);
+    assert(width == 1 || width == 2);
+
+    setDescription("RamSearch");
+
+    this->mem = mem;
+    this->width = width;
+    current = (uint8_t *)calloc(0x10001, 1);
+    previous = (uint8_t *)calloc(0x10001, 1);
+    currentWord = NULL;
+    previousWord = NULL;
+    if (width == 2) {
+        currentWord = (uint16_t *)calloc(0x10000, sizeof(uint16_t));
+        previousWord = (uint16_t *)calloc(0x10000, sizeof(uint16_t));
+    }
+    candidate = (uint8_t *)malloc(0x10000);
+    frame = 0;
+    previousFrame = 0;
+    passes = 0;
+    restart();
+
+    mem->addCaptureClient();
+}
+
+RamSearch::~RamSearch()
+{
+    mem->removeCaptureClient();
+
+    free(current);
+    free(previous);
+    free(currentWord);
+    free(previousWord);
+    free(candidate);
+}
+
+void
+RamSearch::restart()
+{
+    memset(candidate, 0xFF, 0x10000);
+    candidates = 0x10000;
+}
+
+bool
+RamSearch::update()
+{
+    // Keep both buffers untouched if there is no new capture
+    uint64_t newFrame = mem->getCapturedFrame();
+    if (newFrame == 0 || newFrame == frame)
+        return false;
+
+    uint8_t *swap = previous; previous = current; current = swap;
+
+    // The emulator may have captured a newer frame in the meantime
+    newFrame = mem->copyCapturedRam(current);
+    current[0x10000] = current[0];
+
+    // Compare against the same values if there is no previous capture
+    if (frame == 0)
+        memcpy(previous, current, 0x10001);
+
+    if (width == 2) {
+        uint16_t *swapWord = previousWord; previousWord = currentWord; currentWord = swapWord;
+        for (unsigned i = 0; i < 0x10000; i++)
+            currentWord[i] = current[i] | (current[i + 1] << 8);
+        if (frame == 0)
+            memcpy(previousWord, currentWord, 0x10000 * sizeof(uint16_t));
+    }
+
+    previousFrame = frame ? frame : newFrame;
+    frame = newFrame;
+    return true;
+}
+
+unsigned
+RamSearch::filter(RamSearchCondition condition, uint16_t value)
+{
+    if (width == 1) {
+        narrow<uint8_t>(candidate, current, previous, (uint8_t)value, condition);
+    } else {
+        narrow<uint16_t>(candidate, currentWord, previousWord, value, condition);
+    }
+
+    unsigned count = 0;
+    for (unsigned i = 0; i < 0x10000; i++)
+        count += candidate[i] & 1;
+
+    candidates = count;
+    passes++;
+    return candidates;
+}
+
+unsigned
+RamSearch::getCandidates(uint16_t *buffer, unsigned max)
+{
+    unsigned count = 0;
+
+    for (unsigned i = 0; i < 0x10000 && count < max; i++) {
+        if (candidate[i])
+            buffer[count++] = (uint16_t)i;
+    }
+    return count;
+}
+
+uint16_t
+RamSearch::getValue(uint16_t addr)
+{
+    return width == 1 ? current[addr] : currentWord[addr];
+}
+
+uint16_t
+RamSearch::getPreviousValue(uint16_t addr)
+{
+    return width == 1 ? previous[addr] : previousWord[addr];
+}
@@ -0,0 +1,132 @@
+/*!
+ * @header      RamSearch.h
+ * @author      Dirk W. Hoffmann, www.dirkwhoffmann.de
+ * @copyright   2018 Dirk W. Hoffmann
+ */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _RAMSEARCH_INC
+#define _RAMSEARCH_INC
+
+#include "VC64Object.h"
+#include "Memory_types.h"
+
+class C64Memory;
+
+/*! @class    RamSearch
+ *  @brief    Narrows down the RAM locations holding a value of interest
+ *  @details  A search starts with all RAM locations being candidates. Each filter pass keeps
+ *            the candidates that satisfy a condition. The values are taken from copies of the
+ *            RAM that the C64 captures at the end of each frame. Hence, the search can run in
+ *            another thread while the emulator keeps running. Values are either bytes or little
+ *            endian words starting at the candidate address. Candidates are stored as a byte
+ *            mask to let the compiler vectorize all filter passes. Any number of searches can
+ *            be active at the same time.
+ */
+class RamSearch : public VC64Object {
+
+private:
+
+    //! @brief    Memory the values are captured from
+    C64Memory *mem;
+
+    //! @brief    Size of a value in bytes (1 or 2)
+    unsigned width;
+
+    //! @brief    Most recently and previously captured RAM
+    /*! @details  Both buffers contain an extra byte mirroring address $0000 to let the
+     *            word at $FFFF wrap around.
+     */
+    uint8_t *current;
+    uint8_t *previous;
+
+    //! @brief    Words starting at each address (word searches only)
+    uint16_t *currentWord;
+    uint16_t *previousWord;
+
+    //! @brief    Candidate mask (0xFF = candidate, 0x00 = ruled out)
+    uint8_t *candidate;
+
+    //! @brief    Number of remaining candidates
+    unsigned candidates;
+
+    //! @brief    Frames the current and the previous values have been captured in
+    uint64_t frame;
+    uint64_t previousFrame;
+
+    //! @brief    Number of performed filter passes
+    uint64_t passes;
+
+public:
+
+    //! @brief    Creates a search for byte (width = 1) or word (width = 2) values
+    RamSearch(C64Memory *mem, unsigned width = 1);
+
+    //! @brief    Destructor
+    ~RamSearch();
+
+
+    //
+    //! @functiongroup Searching
+    //
+
+    //! @brief    Makes all addresses candidates again
+    void restart();
+
+    /*! @brief    Fetches the RAM captured at the end of the most recent frame
+     *  @details  The formerly current values become the previous values.
+     *  @return   false if no frame has been completed since the last update
+     */
+    bool update();
+
+    /*! @brief    Removes all candidates that do not satisfy the specified condition
+     *  @return   The number of remaining candidates
+     */
+    unsigned filter(RamSearchCondition condition, uint16_t value = 0);
+
+
+    //
+    //! @functiongroup Examining the results
+    //
+
+    //! @brief    Returns the value size in bytes
+    unsigned getWidth() { return width; }
+
+    //! @brief    Returns the number of remaining candidates
+    unsigned numCandidates() { return candidates; }
+
+    //! @brief    Returns true if the specified address is still a candidate
+    bool isCandidate(uint16_t addr) { return candidate[addr] != 0; }
+
+    /*! @brief    Writes the remaining candidates into the specified buffer
+     *  @return   The number of written addresses
+     */
+    unsigned getCandidates(uint16_t *buffer, unsigned max);
+
+    //! @brief    Returns the current value at the specified address
+    uint16_t getValue(uint16_t addr);
+
+    //! @brief    Returns the previous value at the specified address
+    uint16_t getPreviousValue(uint16_t addr);
+
+    //! @brief    Returns the frame the current values have been captured in
+    uint64_t getFrame() { return frame; }
+
+    //! @brief    Returns the number of performed filter passes
+    uint64_t getPasses() { return passes; }
+};
+
+#endif
@@ -0,0 +1,309 @@
+/*!
+ * @file        ReverseDebugger.cpp
+ * @author      Dirk W. Hoffmann, www.dirkwhoffmann.de
+ * @copyright   2018 Dirk W. Hoffmann
+ */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "C64.h"
+
+// Range of the checkpoint distance in cycles (a rasterline and about one second)
+static const uint64_t minInterval = 63;
+static const uint64_t maxInterval = 985248;
+
+ReverseDebugger::ReverseDebugger()
+{
+    setDescription("ReverseDebugger");
+    debug(3, "  Creating reverse debugger at address %p...\n", this);
+
+    enabled = false;
+    nextCheckpoint = UINT64_MAX;
+
+    capacity = 64;
+    checkpoint = (Checkpoint *)calloc(capacity, sizeof(Checkpoint));
+    count = 0;
+
+    interval = 20000;
+    budget = 20;
+    latency = 5000;
+
+    lastCheckpointTime = 0;
+    lastCheckpointCycle = 0;
+    runSpeed = 0.0;
+    replaySpeed = 10.0;
+    replayStartTime = 0;
+    overheadTime = 0;
+    elapsedTime = 0;
+    replaying = false;
+}
+
+ReverseDebugger::~ReverseDebugger()
+{
+    deleteCheckpoints();
+    free(checkpoint);
+}
+
+void
+ReverseDebugger::reset()
+{
+    VirtualComponent::reset();
+
+    count = 0;
+    lastCheckpointTime = 0;
+    nextCheckpoint = enabled ? 0 : UINT64_MAX;
+}
+
+void
+ReverseDebugger::loadFromBuffer(uint8_t **buffer)
+{
+    VirtualComponent::loadFromBuffer(buffer);
+
+    // A restored checkpoint keeps the recorded history alive
+    if (replaying)
+        return;
+
+    count = 0;
+    lastCheckpointTime = 0;
+    nextCheckpoint = enabled ? 0 : UINT64_MAX;
+}
+
+void
+ReverseDebugger::dumpState()
+{
+    msg("ReverseDebugger:\n");
+    msg("----------------\n\n");
+    msg("       Enabled : %s\n", enabled ? "yes" : "no");
+    size_t bytes = 0;
+    for (unsigned i = 0; i < capacity; i++) bytes += checkpoint[i].size;
+    msg("   Checkpoints : %d / %d (%zu bytes allocated)\n", count, capacity, bytes);
+    if (count) {
+        msg("         Range : %lld - %lld\n", checkpointCycle(0), checkpointCycle(count - 1));
+    }
+    msg("      Interval : %lld cycles\n", interval);
+    msg("      Overhead : %d / %d per mille\n", getOverhead(), budget);
+    msg("  Replay speed : %.1f cycles / usec\n", replaySpeed);
+    msg("\n");
+}
+
+void
+ReverseDebugger::deleteCheckpoints()
+{
+    for (unsigned i = 0; i < capacity; i++) {
+        free(checkpoint[i].state);
+        checkpoint[i].state = NULL;
+        checkpoint[i].size = 0;
+    }
+    count = 0;
+    lastCheckpointTime = 0;
+}
+
+
+//
+//! @functiongroup Configuring
+//
+
+void
+ReverseDebugger::setEnabled(bool value)
+{
+    if (enabled == value)
+        return;
+
+    enabled = value;
+    if (enabled) {
+        overheadTime = 0;
+        elapsedTime = 0;
+        nextCheckpoint = 0;
+    } else {
+        deleteCheckpoints();
+        nextCheckpoint = UINT64_MAX;
+    }
+}
+
+void
+ReverseDebugger::setCapacity(unsigned value)
+{
+    if (value < 3) {
+        warn("Capacity %d is too small. Using 3 instead.\n", value);
+        value = 3;
+    }
+
+    deleteCheckpoints();
+    free(checkpoint);
+    capacity = value;
+    checkpoint = (Checkpoint *)calloc(capacity, sizeof(Checkpoint));
+    if (enabled) nextCheckpoint = 0;
+}
+
+
+//
+//! @functiongroup Recording checkpoints
+//
+
+void
+ReverseDebugger::takeCheckpoint()
+{
+    if (!enabled || replaying) {
+        nextCheckpoint = enabled ? c64->getCycles() + interval : UINT64_MAX;
+        return;
+    }
+
+    uint64_t start = usec();
+    uint64_t cycle = c64->getCycles();
+
+    // Make room for the new checkpoint
+    discardAfter(cycle);
+    if (count == capacity)
+        thinOut();
+
+    // Cartridges and the REU change the snapshot size. Snapshots are self-describing, so
+    // checkpoints of different sizes can be restored alike.
+    Checkpoint *cp = &checkpoint[count];
+    size_t size = c64->stateSize();
+    if (cp->size < size) {
+        cp->state = (uint8_t *)realloc(cp->state, size);
+        cp->size = size;
+    }
+
+    uint8_t *ptr = cp->state;
+    c64->saveToBuffer(&ptr);
+    cp->cycle = cycle;
+    count++;
+
+    uint64_t end = usec();
+    uint64_t cost = end - start;
+
+    // Measure the speed of the forward execution since the previous checkpoint. Long pauses
+    // (e.g., the emulator has been halted in the debugger) are ignored.
+    if (lastCheckpointTime && cycle > lastCheckpointCycle) {
+
+        uint64_t run = start - lastCheckpointTime;
+        if (run > 0 && run < 2000000) {
+
+            double speed = (double)(cycle - lastCheckpointCycle) / run;
+            runSpeed = runSpeed ? (3 * runSpeed + speed) / 4 : speed;
+            overheadTime += cost;
+            elapsedTime += run + cost;
+
+            // Distance keeping the checkpoint overhead within the budget
+            double affordable = runSpeed * cost * 1000.0 / budget;
+
+            // Distance keeping a reverse step shorter than the latency target. A step
+            // replays up to two intervals (one to find the instruction, one to reach it).
+            double responsive = replaySpeed * latency / 2;
+
+            // Checkpoints are not taken more often than needed
+            double target = MAX(affordable, responsive);
+            target = MAX(target, (double)minInterval);
+            target = MIN(target, (double)maxInterval);
+            interval = (3 * interval + (uint64_t)target) / 4;
+        }
+    }
+
+    lastCheckpointTime = end;
+    lastCheckpointCycle = cycle;
+    nextCheckpoint = cycle + interval;
+}
+
+void
+ReverseDebugger::discardAfter(uint64_t cycle)
+{
+    while (count > 0 && checkpoint[count - 1].cycle > cycle)
+        count--;
+}
+
+void
+ReverseDebugger::removeCheckpoint(unsigned nr)
+{
+    assert(nr < count);
+
+    Checkpoint removed = checkpoint[nr];
+    memmove(&checkpoint[nr], &checkpoint[nr + 1], (capacity - nr - 1) * sizeof(Checkpoint));
+    checkpoint[capacity - 1] = removed;
+    checkpoint[capacity - 1].cycle = 0;
+    count--;
+}
+
+void
+ReverseDebugger::thinOut()
+{
+    assert(count >= 3);
+
+    uint64_t now = checkpoint[count - 1].cycle;
+    unsigned victim = 1;
+    double best = HUGE_VAL;
+
+    for (unsigned i = 1; i < count - 1; i++) {
+        double gap = (double)(checkpoint[i + 1].cycle - checkpoint[i - 1].cycle);
+        double age = (double)(now - checkpoint[i].cycle) + 1;
+        if (gap / age < best) {
+            best = gap / age;
+            victim = i;
+        }
+    }
+    removeCheckpoint(victim);
+}
+
+
+//
+//! @functiongroup Travelling back in time
+//
+
+int
+ReverseDebugger::checkpointBefore(uint64_t cycle)
+{
+    for (int i = (int)count - 1; i >= 0; i--) {
+        if (checkpointCycle(i) < cycle)
+            return i;
+    }
+    return -1;
+}
+
+void
+ReverseDebugger::restore(unsigned nr)
+{
+    assert(nr < count);
+
+    if (!replaying) {
+        replaying = true;
+        replayStartTime = usec();
+    }
+
+    Checkpoint *cp = &checkpoint[nr];
+    uint8_t *ptr = cp->state;
+    c64->loadFromBuffer(&ptr);
+
+    assert(c64->getCycles() == cp->cycle);
+}
+
+void
+ReverseDebugger::endReplay(uint64_t executed)
+{
+    if (!replaying)
+        return;
+
+    replaying = false;
+
+    // Measure the speed of the re-execution
+    uint64_t elapsed = usec() - replayStartTime;
+    if (elapsed > 100 && executed > 0) {
+        replaySpeed = (replaySpeed + (double)executed / elapsed) / 2;
+    }
+
+    // The future has been left behind
+    discardAfter(c64->getCycles());
+    lastCheckpointTime = 0;
+    nextCheckpoint = enabled ? c64->getCycles() + interval : UINT64_MAX;
+}
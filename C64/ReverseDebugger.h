@@ -0,0 +1,222 @@
+/*!
+ * @header      ReverseDebugger.h
+ * @author      Dirk W. Hoffmann, www.dirkwhoffmann.de
+ * @copyright   2018 Dirk W. Hoffmann
+ */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _REVERSEDEBUGGER_INC
+#define _REVERSEDEBUGGER_INC
+
+#include "VirtualComponent.h"
+
+//! @brief    A state of the C64 the emulation can be resumed from
+typedef struct {
+
+    //! @brief    Value of the C64's cycle counter when the checkpoint was taken
+    uint64_t cycle;
+
+    //! @brief    Snapshot data
+    uint8_t *state;
+
+    //! @brief    Allocated size of the snapshot buffer
+    size_t size;
+
+} Checkpoint;
+
+/*! @class    ReverseDebugger
+ *  @brief    Checkpoint recorder enabling the debugger to step backwards
+ *  @details  While enabled, the C64 takes a checkpoint at the end of a rasterline once in a
+ *            while. To go back in time, the C64 restores the most recent checkpoint before the
+ *            target and deterministically executes forward until the target is reached (see
+ *            C64::stepBack() and C64::continueBack()). The distance between two checkpoints is
+ *            tuned while the emulator runs. It is chosen such that the time spent on taking
+ *            checkpoints stays within the overhead budget. Within that bound, checkpoints are
+ *            taken as often as needed to make a reverse step re-execute no more than a few
+ *            milliseconds of emulation. Once all slots are occupied, checkpoints are thinned
+ *            out such that their distance grows with their age. Hence, the recent past is
+ *            covered densely and the history still reaches back to the oldest checkpoint.
+ *  @note     Checkpoints are ordinary snapshots. Components that are not part of snapshots
+ *            (e.g., the virtual drive) do not travel back in time. The snapshot size varies
+ *            with the attached cartridge and the written pages of an REU. Hence, each
+ *            checkpoint has a buffer of its own that grows with the snapshots stored in it.
+ */
+class ReverseDebugger : public VirtualComponent {
+
+public:
+
+    /*! @brief    Cycle in which the next checkpoint is due
+     *  @details  Checked by the C64 at the end of each rasterline. UINT64_MAX if disabled.
+     */
+    uint64_t nextCheckpoint;
+
+private:
+
+    //! @brief    Indicates if checkpoints are recorded
+    bool enabled;
+
+    /*! @brief    Checkpoints sorted by cycle
+     *  @details  The entries beyond the stored checkpoints keep their buffers for reuse.
+     */
+    Checkpoint *checkpoint;
+
+    //! @brief    Maximum number of stored checkpoints
+    unsigned capacity;
+
+    //! @brief    Number of stored checkpoints
+    unsigned count;
+
+    //! @brief    Current checkpoint distance in cycles
+    uint64_t interval;
+
+    //! @brief    Maximum time spent on checkpoints in per mille of the elapsed time
+    unsigned budget;
+
+    //! @brief    Time in microseconds a reverse step should take at most
+    unsigned latency;
+
+    //! @brief    Time when the previous checkpoint was completed (microseconds)
+    uint64_t lastCheckpointTime;
+
+    //! @brief    Cycle of the previous checkpoint
+    uint64_t lastCheckpointCycle;
+
+    //! @brief    Emulated cycles per microsecond of wall clock time in forward execution
+    double runSpeed;
+
+    //! @brief    Emulated cycles per microsecond when re-executing from a checkpoint
+    double replaySpeed;
+
+    //! @brief    Time when the C64 has entered replay mode
+    uint64_t replayStartTime;
+
+    //! @brief    Total time spent on taking checkpoints and total elapsed time (microseconds)
+    uint64_t overheadTime;
+    uint64_t elapsedTime;
+
+    //! @brief    Indicates that the C64 is re-executing from a checkpoint
+    bool replaying;
+
+public:
+
+    //! @brief    Constructor
+    ReverseDebugger();
+
+    //! @brief    Destructor
+    ~ReverseDebugger();
+
+    //! @brief    Method from VirtualComponent
+    void reset();
+
+    /*! @brief    Method from VirtualComponent
+     *  @details  Loading a snapshot from outside makes all checkpoints obsolete.
+     */
+    void loadFromBuffer(uint8_t **buffer);
+
+    //! @brief    Method from VirtualComponent
+    void dumpState();
+
+
+    //
+    //! @functiongroup Configuring
+    //
+
+    //! @brief    Returns true if checkpoints are recorded
+    bool isEnabled() { return enabled; }
+
+    //! @brief    Enables or disables the recording of checkpoints
+    void setEnabled(bool value);
+
+    //! @brief    Returns the maximum number of stored checkpoints
+    unsigned getCapacity() { return capacity; }
+
+    //! @brief    Sets the maximum number of stored checkpoints (deletes all checkpoints)
+    void setCapacity(unsigned value);
+
+    //! @brief    Returns the overhead budget in per mille
+    unsigned getBudget() { return budget; }
+
+    //! @brief    Sets the overhead budget in per mille
+    void setBudget(unsigned value) { budget = MAX(value, 1); }
+
+
+    //
+    //! @functiongroup Recording checkpoints
+    //
+
+    //! @brief    Takes a checkpoint and schedules the next one (called by the C64)
+    void takeCheckpoint();
+
+    /*! @brief    Deletes all checkpoints taken after the specified cycle
+     *  @details  Called when the C64 has travelled back in time.
+     */
+    void discardAfter(uint64_t cycle);
+
+
+    //
+    //! @functiongroup Travelling back in time
+    //
+
+    //! @brief    Returns the number of stored checkpoints
+    unsigned numCheckpoints() { return count; }
+
+    //! @brief    Returns the cycle of a checkpoint (0 = oldest)
+    uint64_t checkpointCycle(unsigned nr) {
+        assert(nr < count); return checkpoint[nr].cycle; }
+
+    //! @brief    Returns the most recent checkpoint taken before the specified cycle (-1 = none)
+    int checkpointBefore(uint64_t cycle);
+
+    /*! @brief    Restores a checkpoint
+     *  @details  The C64 is put into replay mode in which no checkpoints are taken.
+     */
+    void restore(unsigned nr);
+
+    /*! @brief    Leaves replay mode and schedules the next checkpoint
+     *  @param    executed  Number of cycles re-executed since entering replay mode
+     */
+    void endReplay(uint64_t executed);
+
+    //! @brief    Returns true if the C64 is re-executing from a checkpoint
+    bool isReplaying() { return replaying; }
+
+
+    //
+    //! @functiongroup Reporting
+    //
+
+    //! @brief    Returns the current checkpoint distance in cycles
+    uint64_t getInterval() { return interval; }
+
+    //! @brief    Returns the measured share of time spent on checkpoints in per mille
+    unsigned getOverhead() { return elapsedTime ? (unsigned)(1000 * overheadTime / elapsedTime) : 0; }
+
+private:
+
+    //! @brief    Frees all checkpoint buffers
+    void deleteCheckpoints();
+
+    //! @brief    Removes a checkpoint and keeps its buffer for reuse
+    void removeCheckpoint(unsigned nr);
+
+    /*! @brief    Removes the checkpoint that is least valuable for travelling back
+     *  @details  The oldest and the newest checkpoint are never removed. Among the others,
+     *            the one leaving the smallest gap relative to its age is chosen.
+     */
+    void thinOut();
+};
+
+#endif
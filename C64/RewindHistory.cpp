@@ -0,0 +1,477 @@
+/*!
+ * @header      RewindHistory.cpp
+ * @author      Dirk W. Hoffmann, www.dirkwhoffmann.de
+ * @copyright   2018 Dirk W. Hoffmann
+ */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "C64.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+
+//! @brief    Alignment of the index and the records (a multiple of all common page sizes)
+#define REWIND_PAGE 16384ULL
+
+//! @brief    Granularity in which the history file grows
+#define REWIND_GROWTH (64ULL << 20)
+
+//! @brief    Version of the file layout
+#define REWIND_FORMAT 1
+
+//! @brief    A key record is written if the differences exceed this share of the snapshot (1/n)
+#define REWIND_KEY_RATIO 4
+
+//! @brief    Runs of unchanged bytes shorter than this are merged into the surrounding runs
+#define REWIND_MIN_SKIP 8
+
+static const char rewindMagic[] = { 'V', 'C', 'R', 'H' };
+
+static uint64_t
+roundUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+RewindHistory::RewindHistory()
+{
+    setDescription("RewindHistory");
+
+    fd = -1;
+    base = NULL;
+    mapSize = fileSize = dataStart = 0;
+    header = NULL;
+    index = NULL;
+    position = lastFrame = 0;
+    branch = -1;
+    full = false;
+    keyData = NULL;
+    keySize = 0;
+    keyNr = 0;
+}
+
+RewindHistory::~RewindHistory()
+{
+    close();
+}
+
+
+//
+// Opening and closing
+//
+
+bool
+RewindHistory::open(const char *path, uint64_t frame, uint64_t maxSize, uint32_t capacity)
+{
+    assert(path != NULL);
+
+    close();
+
+    if ((fd = ::open(path, O_RDWR | O_CREAT, 0644)) < 0) {
+        warn("Cannot open rewind history %s (%s)\n", path, strerror(errno));
+        return false;
+    }
+
+    // Check if the file contains a history we can continue
+    RewindFileHeader existing;
+    struct stat fileProperties;
+    bool compatible =
+    fstat(fd, &fileProperties) == 0 &&
+    pread(fd, &existing, sizeof(existing), 0) == sizeof(existing) &&
+    memcmp(existing.magic, rewindMagic, sizeof(rewindMagic)) == 0 &&
+    existing.major == V_MAJOR && existing.minor == V_MINOR && existing.subminor == V_SUBMINOR &&
+    existing.format == REWIND_FORMAT && existing.capacity > 0 &&
+    (uint64_t)fileProperties.st_size >=
+    roundUp(REWIND_PAGE + existing.capacity * sizeof(RewindEntry), REWIND_PAGE);
+
+    if (compatible) {
+        fileSize = fileProperties.st_size;
+        capacity = existing.capacity;
+    } else {
+        debug(1, "Creating a new rewind history in %s\n", path);
+        fileSize = 0;
+        if (ftruncate(fd, 0) != 0) {
+            close();
+            return false;
+        }
+    }
+    dataStart = roundUp(REWIND_PAGE + capacity * sizeof(RewindEntry), REWIND_PAGE);
+
+    // Reserve address space up to the size limit. The file is grown on demand.
+    mapSize = roundUp(MAX(maxSize, MAX(fileSize, dataStart + REWIND_GROWTH)), REWIND_PAGE);
+    void *mapping = mmap(NULL, (size_t)mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        warn("Cannot map rewind history %s (%s)\n", path, strerror(errno));
+        close();
+        return false;
+    }
+    base = (uint8_t *)mapping;
+    header = (RewindFileHeader *)base;
+    index = (RewindEntry *)(base + REWIND_PAGE);
+
+    if (compatible) {
+        verify();
+    } else if (!initialize(capacity)) {
+        close();
+        return false;
+    }
+
+    // Continue the emulated time where the history ends
+    position = header->count ? index[header->count - 1].position : 0;
+    lastFrame = frame;
+    branch = -1;
+    full = false;
+
+    debug(1, "Opened rewind history %s (%d snapshots, %llu bytes)\n",
+          path, header->count, dataSize());
+    return true;
+}
+
+bool
+RewindHistory::initialize(uint32_t capacity)
+{
+    if (!grow(dataStart))
+        return false;
+
+    memcpy(header->magic, rewindMagic, sizeof(rewindMagic));
+    header->major = V_MAJOR;
+    header->minor = V_MINOR;
+    header->subminor = V_SUBMINOR;
+    header->format = REWIND_FORMAT;
+    header->capacity = capacity;
+    header->count = 0;
+    header->dataEnd = dataStart;
+    return true;
+}
+
+bool
+RewindHistory::isIntact(unsigned nr)
+{
+    RewindEntry *e = &index[nr];
+
+    if (e->offset < dataStart || e->stored == 0 || e->offset + e->stored > fileSize)
+        return false;
+
+    // Records are stored in order
+    if (nr > 0 && (e->position < index[nr - 1].position ||
+                   e->offset < index[nr - 1].offset + index[nr - 1].stored))
+        return false;
+
+    // Delta records refer to an earlier key record of the same size
+    if (e->key != nr && (e->key > nr || index[e->key].key != e->key ||
+                         index[e->key].size != e->size))
+        return false;
+
+    return checksum(base + e->offset, (size_t)e->stored) == e->checksum;
+}
+
+void
+RewindHistory::verify()
+{
+    unsigned dropped = 0;
+
+    header->count = MIN(header->count, header->capacity);
+
+    // Records are written in order. Hence, only the most recent ones can be incomplete.
+    while (header->count > 0) {
+
+        unsigned last = header->count - 1;
+        if (isIntact(last) && (index[last].key == last || isIntact(index[last].key))) {
+            release(index[last].offset, index[last].stored);
+            release(index[index[last].key].offset, index[index[last].key].stored);
+            break;
+        }
+        header->count--;
+        dropped++;
+    }
+
+    header->dataEnd = header->count ?
+    index[header->count - 1].offset + index[header->count - 1].stored : dataStart;
+
+    if (dropped) {
+        warn("Dropped %d incomplete snapshots from the rewind history\n", dropped);
+    }
+}
+
+void
+RewindHistory::close()
+{
+    if (base) {
+        msync(base, (size_t)MIN(mapSize, fileSize), MS_SYNC);
+        munmap(base, (size_t)mapSize);
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+
+    free(keyData);
+
+    fd = -1;
+    base = NULL;
+    header = NULL;
+    index = NULL;
+    mapSize = fileSize = 0;
+    branch = -1;
+    full = false;
+    keyData = NULL;
+    keySize = 0;
+}
+
+
+//
+// Recording
+//
+
+bool
+RewindHistory::grow(uint64_t end)
+{
+    if (end <= fileSize)
+        return true;
+
+    uint64_t newSize = MIN(roundUp(end, REWIND_GROWTH), mapSize);
+    if (end > newSize || ftruncate(fd, (off_t)newSize) != 0) {
+        return false;
+    }
+
+    fileSize = newSize;
+    return true;
+}
+
+void
+RewindHistory::advance(uint64_t frame)
+{
+    // The frame counter starts over when the C64 is reset
+    position += frame >= lastFrame ? frame - lastFrame : frame;
+    lastFrame = frame;
+}
+
+bool
+RewindHistory::append(const uint8_t *state, size_t size, uint64_t frame, uint64_t cycle)
+{
+    assert(state != NULL);
+
+    if (!isOpen())
+        return false;
+
+    advance(frame);
+
+    // Drop the records of an abandoned branch before overwriting their data
+    if (branch >= 0) {
+        unsigned count = branch + 1;
+        header->count = count;
+        header->dataEnd = index[branch].offset + index[branch].stored;
+        memset(index + count, 0, (header->capacity - count) * sizeof(RewindEntry));
+        if (keyNr >= count) {
+            free(keyData);
+            keyData = NULL;
+        }
+        full = false;
+        branch = -1;
+    }
+
+    unsigned nr = header->count;
+    uint64_t offset = roundUp(header->dataEnd, REWIND_PAGE);
+
+    if (full || nr == header->capacity || !grow(offset + size)) {
+        if (!full) warn("Rewind history is full. Recording stops.\n");
+        full = true;
+        return false;
+    }
+
+    // Store the differences to the key record if they are small enough
+    size_t stored = 0;
+    if (keyData && keySize == size) {
+        stored = encode(keyData, state, size, base + offset, size / REWIND_KEY_RATIO);
+    }
+    if (stored == 0) {
+        memcpy(base + offset, state, size);
+        stored = size;
+        if (keySize != size) {
+            free(keyData);
+            keyData = (uint8_t *)malloc(size);
+            keySize = size;
+        }
+        memcpy(keyData, state, size);
+        keyNr = nr;
+    }
+
+    RewindEntry *e = &index[nr];
+    e->position = position;
+    e->cycle = cycle;
+    e->timestamp = (int64_t)time(NULL);
+    e->offset = offset;
+    e->stored = stored;
+    e->size = size;
+    e->key = keyNr;
+    e->reserved = 0;
+    e->checksum = checksum(base + offset, stored);
+
+    // Commit
+    header->dataEnd = offset + stored;
+    header->count++;
+
+    // Start writing back and remove the record from the resident set
+    msync(base, (size_t)roundUp(REWIND_PAGE + header->count * sizeof(RewindEntry), REWIND_PAGE),
+          MS_ASYNC);
+    release(offset, stored);
+
+    return true;
+}
+
+size_t
+RewindHistory::encode(const uint8_t *key, const uint8_t *data, size_t size,
+                      uint8_t *out, size_t limit)
+{
+    size_t i = 0, written = 0;
+
+    while (i < size) {
+
+        // Skip unchanged bytes (eight at a time where possible)
+        size_t start = i;
+        while (i + 8 <= size && memcmp(key + i, data + i, 8) == 0) i += 8;
+        while (i < size && key[i] == data[i]) i++;
+        if (i == size)
+            break;
+
+        // Find the end of the changed run
+        size_t run = i, last = i;
+        while (i < size && i - last <= REWIND_MIN_SKIP) {
+            if (key[i] != data[i]) last = i;
+            i++;
+        }
+        i = last + 1;
+
+        uint32_t skip = (uint32_t)(run - start), length = (uint32_t)(i - run);
+        if (written + 2 * sizeof(uint32_t) + length > limit)
+            return 0;
+
+        memcpy(out + written, &skip, sizeof(skip));
+        memcpy(out + written + sizeof(skip), &length, sizeof(length));
+        memcpy(out + written + 2 * sizeof(uint32_t), data + run, length);
+        written += 2 * sizeof(uint32_t) + length;
+    }
+
+    // An unchanged snapshot is encoded as a single empty run
+    if (written == 0) {
+        memset(out, 0, 2 * sizeof(uint32_t));
+        written = 2 * sizeof(uint32_t);
+    }
+
+    return written;
+}
+
+void
+RewindHistory::release(uint64_t offset, uint64_t size)
+{
+    uint8_t *start = base + offset;
+    size_t length = (size_t)roundUp(size, REWIND_PAGE);
+
+    msync(start, length, MS_ASYNC);
+
+#ifdef __linux__
+    // Dirty pages of shared file mappings are kept in the page cache
+    madvise(start, length, MADV_DONTNEED);
+#else
+    posix_madvise(start, length, POSIX_MADV_DONTNEED);
+#endif
+}
+
+uint64_t
+RewindHistory::checksum(const uint8_t *data, size_t size)
+{
+    // FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ data[i]) * 0x100000001b3ULL;
+    return hash;
+}
+
+
+//
+// Seeking and restoring
+//
+
+int
+RewindHistory::entryAt(uint64_t pos)
+{
+    // Find the first entry behind the position
+    unsigned lo = 0, hi = numEntries();
+    while (lo < hi) {
+        unsigned mid = lo + (hi - lo) / 2;
+        if (index[mid].position <= pos) lo = mid + 1; else hi = mid;
+    }
+    return (int)lo - 1;
+}
+
+void
+RewindHistory::getData(unsigned nr, uint8_t *buffer)
+{
+    assert(nr < numEntries());
+
+    RewindEntry *e = &index[nr];
+    RewindEntry *k = &index[e->key];
+    memcpy(buffer, base + k->offset, (size_t)k->size);
+
+    // Apply the differences
+    const uint8_t *ptr = base + e->offset, *end = ptr + (e->key == nr ? 0 : e->stored);
+    uint64_t pos = 0;
+    while (ptr < end) {
+        uint32_t skip, length;
+        memcpy(&skip, ptr, sizeof(skip));
+        memcpy(&length, ptr + sizeof(skip), sizeof(length));
+        ptr += 2 * sizeof(uint32_t);
+        pos += skip;
+        assert(pos + length <= e->size);
+        memcpy(buffer + pos, ptr, length);
+        ptr += length;
+        pos += length;
+    }
+
+    release(k->offset, k->stored);
+    release(e->offset, e->stored);
+}
+
+void
+RewindHistory::didRestore(unsigned nr, uint64_t frame)
+{
+    assert(nr < numEntries());
+
+    position = index[nr].position;
+    lastFrame = frame;
+    branch = nr;
+}
+
+void
+RewindHistory::dumpState()
+{
+    msg("RewindHistory:\n");
+    msg("--------------\n\n");
+    if (!isOpen()) {
+        msg("   No history file opened\n\n");
+        return;
+    }
+    msg("       Snapshots : %d (capacity %d)\n", header->count, header->capacity);
+    msg("       Data size : %llu bytes\n", dataSize());
+    msg("  Key record nr. : %d (%s)\n", keyNr, keyData ? "cached" : "not cached");
+    msg("       File size : %llu bytes (limit %llu)\n", fileSize, mapSize);
+    msg("        Position : %llu frames\n", position);
+    msg("          Branch : %d\n", branch);
+    msg("            Full : %s\n", full ? "yes" : "no");
+    if (header->count) {
+        msg("    First record : frame %llu\n", index[0].position);
+        msg("     Last record : frame %llu\n", index[header->count - 1].position);
+    }
+    msg("\n");
+}
@@ -0,0 +1,277 @@
+/*!
+ * @header      RewindHistory.h
+ * @author      Dirk W. Hoffmann, www.dirkwhoffmann.de
+ * @copyright   2018 Dirk W. Hoffmann
+ */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * File layout (all values in host byte order):
+ *
+ *   0                    RewindFileHeader
+ *   16 KB                Index (capacity x RewindEntry, sorted by position)
+ *   dataStart            Records (each record starts on a 16 KB boundary)
+ *
+ * A record either stores a complete snapshot (key record) or the differences to the most
+ * recent key record (delta record). A delta record is encoded as a sequence of runs:
+ *
+ *   uint32_t skip        Number of bytes taken over from the key record
+ *   uint32_t length      Number of bytes that follow and replace the key record's bytes
+ *
+ * A record is committed by writing its data first, then its index entry, and finally the
+ * entry count in the file header. If the emulator crashes, the page cache still holds the
+ * complete file. If the machine crashes, the trailing entries are verified by their checksums
+ * when the file is opened again. Broken entries are dropped.
+ */
+
+#ifndef _REWINDHISTORY_INC
+#define _REWINDHISTORY_INC
+
+#include "VC64Object.h"
+
+//! @brief    File header of a rewind history
+typedef struct {
+
+    //! @brief    Magic bytes ('V','C','R','H')
+    char magic[4];
+
+    //! @brief    Version number of the emulator that has written the snapshots
+    uint8_t major;
+    uint8_t minor;
+    uint8_t subminor;
+
+    //! @brief    Version of the file layout
+    uint8_t format;
+
+    //! @brief    Number of index slots
+    uint32_t capacity;
+
+    //! @brief    Number of committed entries
+    uint32_t count;
+
+    //! @brief    File offset of the first byte behind the most recent record
+    uint64_t dataEnd;
+
+} RewindFileHeader;
+
+//! @brief    Index entry of a rewind history
+typedef struct {
+
+    //! @brief    Emulated time in frames, counted from the creation of the history
+    uint64_t position;
+
+    //! @brief    Value of the C64's cycle counter when the snapshot was taken
+    uint64_t cycle;
+
+    //! @brief    Date and time of snapshot creation
+    int64_t timestamp;
+
+    //! @brief    File offset and size of the record
+    uint64_t offset;
+    uint64_t stored;
+
+    //! @brief    Size of the snapshot data
+    uint64_t size;
+
+    //! @brief    Key record the differences refer to (equals the entry's own number for keys)
+    uint32_t key;
+
+    //! @brief    Unused
+    uint32_t reserved;
+
+    //! @brief    FNV-1a hash over the record
+    uint64_t checksum;
+
+} RewindEntry;
+
+/*! @class    RewindHistory
+ *  @brief    Append-only snapshot file that rewinding can go back to
+ *  @details  While the history is open, each auto-saved snapshot is appended to a memory-mapped
+ *            file. Most of a snapshot remains unchanged for a long time (e.g., the disk in the
+ *            VC1541), so most records only store the differences to the latest key record.
+ *            Snapshots are located by their position in emulated time. Since positions never
+ *            decrease, a position is looked up by a binary search in the index.
+ *            Opening a history only maps the file and verifies the most recent record. Hence,
+ *            hours of recordings are available instantly. Pages are handed back to the
+ *            operating system once a record has been written or restored, so the resident
+ *            memory does not grow with the length of the history.
+ *            Restoring a snapshot and continuing from there starts a new branch. All records
+ *            behind the restored one are dropped when the next snapshot is appended.
+ */
+class RewindHistory : public VC64Object {
+
+public:
+
+    //! @brief    Default number of index slots (about 54 hours at one snapshot per 3 seconds)
+    static const uint32_t DEFAULT_CAPACITY = 65536;
+
+    //! @brief    Default size limit of the history file in bytes
+    static const uint64_t DEFAULT_MAX_SIZE = 16ULL << 30;
+
+private:
+
+    //! @brief    File descriptor of the history file (-1 = closed)
+    int fd;
+
+    //! @brief    Start of the memory mapping
+    uint8_t *base;
+
+    //! @brief    Size of the memory mapping (reserved up to the size limit)
+    uint64_t mapSize;
+
+    //! @brief    Current size of the history file
+    uint64_t fileSize;
+
+    //! @brief    Mapped file header and index
+    RewindFileHeader *header;
+    RewindEntry *index;
+
+    //! @brief    File offset of the first record
+    uint64_t dataStart;
+
+    //! @brief    Emulated time in frames (the position of the next record is derived from it)
+    uint64_t position;
+
+    //! @brief    Frame counter of the C64 when the position has been updated the last time
+    uint64_t lastFrame;
+
+    //! @brief    Entry the C64 has been restored from (-1 = none since the last append)
+    int branch;
+
+    //! @brief    Copy of the most recent key record's snapshot data (NULL = none)
+    uint8_t *keyData;
+    size_t keySize;
+
+    //! @brief    Entry of the most recent key record
+    unsigned keyNr;
+
+    //! @brief    Indicates that the file has reached its size limit or capacity
+    bool full;
+
+public:
+
+    //! @brief    Constructor
+    RewindHistory();
+
+    //! @brief    Destructor
+    ~RewindHistory();
+
+
+    //
+    //! @functiongroup Opening and closing
+    //
+
+    /*! @brief    Opens a history file
+     *  @details  If the file does not exist or has been written by a different emulator
+     *            version, a new history is created.
+     *  @param    frame     Current value of the C64's frame counter
+     *  @param    maxSize   Size limit of the file in bytes
+     *  @param    capacity  Number of index slots (only used if a new history is created)
+     */
+    bool open(const char *path, uint64_t frame,
+              uint64_t maxSize = DEFAULT_MAX_SIZE, uint32_t capacity = DEFAULT_CAPACITY);
+
+    //! @brief    Flushes and closes the history file
+    void close();
+
+    //! @brief    Returns true if a history file is open
+    bool isOpen() { return base != NULL; }
+
+    //! @brief    Returns true if no more snapshots can be appended
+    bool isFull() { return full; }
+
+
+    //
+    //! @functiongroup Recording
+    //
+
+    /*! @brief    Appends a snapshot
+     *  @param    state  Snapshot data (as written by C64::saveToBuffer())
+     *  @param    frame  Current value of the C64's frame counter
+     *  @param    cycle  Current value of the C64's cycle counter
+     *  @return   false, if the history is closed or full
+     */
+    bool append(const uint8_t *state, size_t size, uint64_t frame, uint64_t cycle);
+
+
+    //
+    //! @functiongroup Seeking and restoring
+    //
+
+    //! @brief    Returns the number of stored snapshots
+    unsigned numEntries() { return header ? header->count : 0; }
+
+    //! @brief    Returns an index entry (0 = oldest)
+    RewindEntry getEntry(unsigned nr) { assert(nr < numEntries()); return index[nr]; }
+
+    //! @brief    Returns the current position in emulated frames
+    uint64_t getPosition() { return position; }
+
+    //! @brief    Returns the number of bytes occupied by snapshot data
+    uint64_t dataSize() { return header ? header->dataEnd - dataStart : 0; }
+
+    /*! @brief    Returns the most recent entry at or before a position (-1 = none)
+     *  @details  Performs a binary search in the index.
+     */
+    int entryAt(uint64_t position);
+
+    //! @brief    Returns the size of the snapshot data of an entry
+    size_t getSize(unsigned nr) { assert(nr < numEntries()); return (size_t)index[nr].size; }
+
+    /*! @brief    Reconstructs the snapshot data of an entry
+     *  @param    buffer  Buffer of at least getSize(nr) bytes
+     */
+    void getData(unsigned nr, uint8_t *buffer);
+
+    /*! @brief    Informs the history that the C64 has been restored from an entry
+     *  @param    frame  Value of the C64's frame counter after restoring
+     */
+    void didRestore(unsigned nr, uint64_t frame);
+
+    //! @brief    Prints the state of the history
+    void dumpState();
+
+private:
+
+    //! @brief    Writes the header of an empty history into the opened file
+    bool initialize(uint32_t capacity);
+
+    //! @brief    Drops the trailing entries that have not been written completely
+    void verify();
+
+    //! @brief    Checks if an entry refers to a completely written record
+    bool isIntact(unsigned nr);
+
+    /*! @brief    Encodes the differences between a snapshot and the key record
+     *  @return   Number of written bytes or 0, if the encoding would exceed the limit
+     */
+    static size_t encode(const uint8_t *key, const uint8_t *data, size_t size,
+                         uint8_t *out, size_t limit);
+
+    //! @brief    Grows the file such that it covers the specified offset
+    bool grow(uint64_t end);
+
+    //! @brief    Advances the position to the specified frame
+    void advance(uint64_t frame);
+
+    //! @brief    Hands the pages of a file range back to the operating system
+    void release(uint64_t offset, uint64_t size);
+
+    //! @brief    Computes the checksum of a record
+    static uint64_t checksum(const uint8_t *data, size_t size);
+};
+
+#endif
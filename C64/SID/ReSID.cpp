@@ -24,6 +24,8 @@ ReSID::ReSID()
 	debug(3, "  Creating ReSID at address %p...\n", this);
 
     sid = new reSID::SID();
+    clockedCycles = 0;
+    producedSamples = 0;
     
     // Register snapshot items
     SnapshotItem items[] = {
@@ -120,6 +122,7 @@ ReSID::setSampleRate(uint32_t value)
     reSID::sampling_method method = sid->sampling;
     double rate = (double)value;
     
+    sampleRate = value;
     sid->set_sampling_parameters(frequency, method, rate);
     
     debug("Changing sample rate to %d\n", value);
@@ -147,7 +150,8 @@ ReSID::setSamplingMethod(SamplingMethod value)
           (method == reSID::SAMPLE_FAST) ? "SAMPLE_FAST" :
           (method == reSID::SAMPLE_INTERPOLATE) ? "SAMPLE_INTERPOLATE" :
           (method == reSID::SAMPLE_RESAMPLE) ? "SAMPLE_RESAMPLE" :
-          (method == reSID::SAMPLE_RESAMPLE_FASTMEM) ? "SAMPLE_RESAMPLE_FASTMEM" : "?");
+          (method == reSID::SAMPLE_RESAMPLE_FASTMEM) ? "SAMPLE_RESAMPLE_FASTMEM" :
+          (method == reSID::SAMPLE_DECIMATE) ? "SAMPLE_DECIMATE" : "?");
 }
 
 void
@@ -160,7 +164,15 @@ ReSID::loadFromBuffer(uint8_t **buffer)
 void
 ReSID::saveToBuffer(uint8_t **buffer)
 {
+    // read_state() reads the registers $19 to $1C which alters the data bus.
+    // Restore it to keep snapshots free of side effects.
+    reSID::reg8 busValue = sid->bus_value;
+    reSID::cycle_count busValueTtl = sid->bus_value_ttl;
     st = sid->read_state();
+    sid->bus_value = busValue;
+    sid->bus_value_ttl = busValueTtl;
+    st.bus_value = busValue;
+    st.bus_value_ttl = busValueTtl;
     VirtualComponent::saveToBuffer(buffer);
 }
 
@@ -191,9 +203,11 @@ ReSID::execute(uint64_t elapsedCycles)
     int bufindex = 0;
     
     // Let reSID compute some sound samples
+    clockedCycles += elapsedCycles;
     while (delta_t) {
         bufindex += sid->clock(delta_t, buf + bufindex, buflength - bufindex);
     }
+    producedSamples += bufindex;
     
     // Write samples into ringbuffer
     if (bufindex) {
@@ -201,6 +215,136 @@ ReSID::execute(uint64_t elapsedCycles)
     }
 }
 
+size_t
+ReSID::render(uint64_t cycles, short *buffer, size_t capacity)
+{
+    // Clock reSID in a single call like execute() does to get identical results
+    reSID::cycle_count delta_t = (reSID::cycle_count)MIN(cycles, (uint64_t)INT32_MAX);
+    reSID::cycle_count total = delta_t;
+    size_t count = 0;
+    
+    while (delta_t && count < capacity) {
+        count += sid->clock(delta_t, buffer + count, (int)(capacity - count));
+    }
+    
+    // reSID doesn't clock at all if there is no room for a sample
+    if (delta_t) {
+        short spare;
+        if (sid->clock(delta_t, &spare, 1)) {
+            warn("Sample buffer overflow\n");
+        }
+    }
+    
+    clockedCycles += total - delta_t;
+    producedSamples += count;
+    return count;
+}
+
+unsigned
+ReSID::getHistoryLength()
+{
+    switch (sid->sampling) {
+            
+        case reSID::SAMPLE_RESAMPLE:
+        case reSID::SAMPLE_RESAMPLE_FASTMEM:
+            return sid->fir_N + 2;
+            
+        case reSID::SAMPLE_DECIMATE:
+        {
+            unsigned length = sid->fir_N + 2;
+            for (int i = 0; i < sid->halfband_stages; i++) {
+                length += sid->halfband_N[i];
+            }
+            return length;
+        }
+            
+        default:
+            return 0;
+    }
+}
+
+void
+ReSID::getState(ReSIDState &state, short *history)
+{
+    for (unsigned i = 0; i < 3; i++) {
+        state.voice[i] = sid->voice[i];
+    }
+    state.filter = sid->filter;
+    state.extfilt = sid->extfilt;
+    
+    state.busValue = sid->bus_value;
+    state.busValueTtl = sid->bus_value_ttl;
+    state.writePipeline = sid->write_pipeline;
+    state.writeAddress = sid->write_address;
+    
+    state.sampleOffset = sid->sample_offset;
+    state.sampleIndex = sid->sample_index;
+    state.samplePrev = sid->sample_prev;
+    state.sampleNow = sid->sample_now;
+    state.halfbandPhase = sid->halfband_phase;
+    
+    // Save the most recent ring buffer entries (oldest first)
+    unsigned length = getHistoryLength();
+    for (int i = 0; i < sid->halfband_stages; i++) {
+        
+        short *ring = sid->halfband_sample + i * reSID::SID::HALFBAND_RINGSIZE * 2;
+        unsigned N = sid->halfband_N[i];
+        length -= N;
+        for (unsigned j = 0; j < N; j++) {
+            *history++ = ring[(sid->halfband_index[i] - N + j) & reSID::SID::HALFBAND_RINGMASK];
+        }
+    }
+    for (unsigned i = 0; i < length; i++) {
+        history[i] = sid->sample[(sid->sample_index - length + i) & reSID::SID::RINGMASK];
+    }
+}
+
+void
+ReSID::setState(const ReSIDState &state, const short *history)
+{
+    for (unsigned i = 0; i < 3; i++) {
+        sid->voice[i] = state.voice[i];
+    }
+    sid->filter = state.filter;
+    sid->extfilt = state.extfilt;
+    
+    // Fix up pointers into the original object and into the wave tables
+    sid->voice[0].set_sync_source(&sid->voice[2]);
+    sid->voice[1].set_sync_source(&sid->voice[0]);
+    sid->voice[2].set_sync_source(&sid->voice[1]);
+    for (unsigned i = 0; i < 3; i++) {
+        sid->voice[i].set_chip_model(sid->sid_model);
+    }
+    
+    sid->bus_value = state.busValue;
+    sid->bus_value_ttl = state.busValueTtl;
+    sid->write_pipeline = state.writePipeline;
+    sid->write_address = state.writeAddress;
+    
+    sid->sample_offset = state.sampleOffset;
+    sid->sample_index = state.sampleIndex;
+    sid->sample_prev = state.samplePrev;
+    sid->sample_now = state.sampleNow;
+    sid->halfband_phase = state.halfbandPhase;
+    
+    // Restore the ring buffer entries (including the mirrored upper half)
+    unsigned length = getHistoryLength();
+    for (int i = 0; i < sid->halfband_stages; i++) {
+        
+        short *ring = sid->halfband_sample + i * reSID::SID::HALFBAND_RINGSIZE * 2;
+        unsigned N = sid->halfband_N[i];
+        length -= N;
+        for (unsigned j = 0; j < N; j++) {
+            int index = (sid->halfband_index[i] - N + j) & reSID::SID::HALFBAND_RINGMASK;
+            ring[index] = ring[index + reSID::SID::HALFBAND_RINGSIZE] = *history++;
+        }
+    }
+    for (unsigned i = 0; i < length; i++) {
+        int index = (sid->sample_index - length + i) & reSID::SID::RINGMASK;
+        sid->sample[index] = sid->sample[index + reSID::SID::RINGSIZE] = history[i];
+    }
+}
+
 void
 ReSID::dumpState()
 {
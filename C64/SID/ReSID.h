@@ -27,6 +27,31 @@
 #include "VirtualComponent.h"
 #include "resid/sid.h"
 
+/*! @brief    Complete state of a reSID instance
+ *  @details  In contrast to reSID::SID::State, this structure comprises everything that affects
+ *            future audio output, including all pipelines, the filter integrators, and the
+ *            state of the sampling stage. The ring buffers used by the resampling methods are
+ *            stored separately (see ReSID::getHistoryLength()). The structure may contain
+ *            stale pointers which are fixed up when the state is restored.
+ */
+struct ReSIDState {
+    
+    reSID::Voice voice[3];
+    reSID::Filter filter;
+    reSID::ExternalFilter extfilt;
+    
+    reSID::reg8 busValue;
+    reSID::cycle_count busValueTtl;
+    reSID::cycle_count writePipeline;
+    reSID::reg8 writeAddress;
+    
+    reSID::cycle_count sampleOffset;
+    int sampleIndex;
+    short samplePrev;
+    short sampleNow;
+    int halfbandPhase;
+};
+
 class ReSID : public VirtualComponent {
 
 private:
@@ -43,6 +68,12 @@ private:
     //! @brief   Switches filter emulation on or off.
     bool emulateFilter;
     
+    //! @brief   Number of cycles reSID has been clocked since creation
+    uint64_t clockedCycles;
+    
+    //! @brief   Number of sound samples reSID has produced since creation
+    uint64_t producedSamples;
+    
 public:
 		
     //! Pointer to bridge object
@@ -78,6 +109,36 @@ public:
      */
     void execute(uint64_t cycles);
 	
+    /*! @brief   Runs reSID for the specified amount of cycles
+     *  @details In contrast to execute(), the sound samples are written into the provided
+     *           buffer. The function is used for rendering audio offline.
+     *  @return  Number of written samples
+     */
+    size_t render(uint64_t cycles, short *buffer, size_t capacity);
+    
+    //! Returns the number of cycles reSID has been clocked since creation
+    uint64_t getClockedCycles() { return clockedCycles; }
+    
+    //! Returns the number of sound samples reSID has produced since creation
+    uint64_t getProducedSamples() { return producedSamples; }
+    
+    
+    // Saving and restoring the complete state
+    
+    /*! @brief   Returns the number of ring buffer samples belonging to the state
+     *  @details The resampling methods convolve the most recent samples of the
+     *           ring buffer. The decimation method additionally convolves the most
+     *           recent samples of each half-band stage, which are appended. All other
+     *           methods don't need the ring buffer at all.
+     */
+    unsigned getHistoryLength();
+    
+    //! Saves the complete state. history must hold getHistoryLength() samples
+    void getState(ReSIDState &state, short *history);
+    
+    //! Restores the complete state. The configuration must match the saved one.
+    void setState(const ReSIDState &state, const short *history);
+    
 
     // Configuring
     
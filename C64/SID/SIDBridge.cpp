@@ -42,6 +42,7 @@ SIDBridge::SIDBridge()
     registerSnapshotItems(items, sizeof(items));
     
     useReSID = true;
+    capture = NULL;
 }
 
 SIDBridge::~SIDBridge()
@@ -57,6 +58,9 @@ SIDBridge::reset()
     resid.reset();
     fastsid.reset();
     
+    // reSID has changed its state without a register write
+    if (capture) capture->recordCheckpoint(&resid);
+    
     volume = 100000;
     targetVolume = 100000;
 }
@@ -66,14 +70,45 @@ SIDBridge::loadFromBuffer(uint8_t **buffer)
 {
     VirtualComponent::loadFromBuffer(buffer);
     clearRingbuffer();
+    
+    // reSID has changed its state without a register write
+    if (capture) capture->recordCheckpoint(&resid);
 }
 
 void 
 SIDBridge::setReSID(bool enable)
 {
+    if (!enable) stopCapture();
     useReSID = enable;
 }
 
+bool
+SIDBridge::startCapture(SIDCapture *target)
+{
+    assert(target != NULL);
+    
+    if (!useReSID) {
+        warn("Register writes can only be captured with ReSID\n");
+        return false;
+    }
+    
+    stopCapture();
+    executeUntil(c64->getCycles());
+    target->begin(&resid);
+    capture = target;
+    return true;
+}
+
+void
+SIDBridge::stopCapture()
+{
+    if (capture) {
+        executeUntil(c64->getCycles());
+        capture->end(&resid);
+        capture = NULL;
+    }
+}
+
 void 
 SIDBridge::dumpState()
 {
@@ -136,6 +171,8 @@ SIDBridge::poke(uint16_t addr, uint8_t value)
     // Keep both SID implementations up to date
     resid.poke(addr, value);
     fastsid.poke(addr, value);
+    
+    if (capture) capture->recordWrite(&resid, addr, value);
 }
 
 void
@@ -161,6 +198,7 @@ SIDBridge::execute(uint64_t numCycles)
     
     if (useReSID) {
         resid.execute(numCycles);
+        if (capture) capture->update(&resid);
     } else {
         fastsid.execute(numCycles);
     }
@@ -191,6 +229,7 @@ SIDBridge::getAudioFilter()
 void 
 SIDBridge::setAudioFilter(bool value)
 {
+    stopCapture();
     resid.setAudioFilter(value);
     fastsid.setAudioFilter(value);
 }
@@ -205,6 +244,7 @@ SIDBridge::getSamplingMethod()
 void
 SIDBridge::setSamplingMethod(SamplingMethod value)
 {
+    stopCapture();
     // Option is ReSID only
     resid.setSamplingMethod(value);
 }
@@ -222,6 +262,7 @@ SIDBridge::getChipModel()
 void 
 SIDBridge::setChipModel(SIDChipModel model)
 {
+    stopCapture();
     if (model != MOS_6581 && model != MOS_8580) {
         warn("Unknown chip model (%d). Using  MOS8580\n", model);
         model = MOS_8580;
@@ -244,6 +285,7 @@ SIDBridge::getSampleRate()
 void 
 SIDBridge::setSampleRate(uint32_t rate)
 {
+    stopCapture();
     resid.setSampleRate(rate);
     fastsid.setSampleRate(rate);
 }
@@ -261,6 +303,7 @@ SIDBridge::getClockFrequency()
 void 
 SIDBridge::setClockFrequency(uint32_t frequency)
 {
+    stopCapture();
     resid.setClockFrequency(frequency);
     fastsid.setClockFrequency(frequency);
 }
@@ -24,6 +24,7 @@
 #include "VirtualComponent.h"
 #include "FastSID.h"
 #include "ReSID.h"
+#include "SIDCapture.h"
 #include "SID_types.h"
 
 class SIDBridge : public VirtualComponent {
@@ -44,6 +45,11 @@ private:
     //! @brief    Current clock cycle since power up
     uint64_t cycles;
     
+    /*! @brief    Capture that records all reSID register writes
+     *  @details  NULL if no capture is running.
+     */
+    SIDCapture *capture;
+    
 private:
     
     //
@@ -162,6 +168,23 @@ public:
 	//! @brief    Sets the clock frequency.
 	void setClockFrequency(uint32_t frequency);	
 
+    //
+    // Capturing register writes
+    //
+    
+    /*! @brief    Starts recording reSID register writes into the provided capture
+     *  @details  The capture is stopped automatically if the SID is reconfigured.
+     *  @return   false if ReSID is not the selected SID implementation
+     */
+    bool startCapture(SIDCapture *target);
+    
+    //! @brief    Stops recording
+    void stopCapture();
+    
+    //! @brief    Returns true if register writes are recorded
+    bool isCapturing() { return capture != NULL; }
+    
+    
     //
     // Running the device
     //
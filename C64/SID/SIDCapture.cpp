@@ -0,0 +1,379 @@
+/*
+ * (C) 2018 Dirk W. Hoffmann. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "C64.h"
+
+static const char captureMagic[8] = { 'V', 'C', '6', '4', 'S', 'I', 'D', 0 };
+
+SIDCapture::SIDCapture()
+{
+    setDescription("SIDCapture");
+
+    checkpoints = NULL;
+    checkpointCapacity = 0;
+    events = NULL;
+    eventCapacity = 0;
+    history = NULL;
+    historyCapacity = 0;
+    checkpointInterval = PAL_CYCLES_PER_SECOND;
+
+    clear();
+}
+
+SIDCapture::~SIDCapture()
+{
+    free(checkpoints);
+    free(events);
+    free(history);
+}
+
+void
+SIDCapture::clear()
+{
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, captureMagic, sizeof(header.magic));
+    header.stateSize = sizeof(ReSIDState);
+}
+
+template <class T> bool
+SIDCapture::reserve(T **array, uint64_t *capacity, uint64_t size)
+{
+    if (size <= *capacity)
+        return true;
+
+    uint64_t newCapacity = MAX(size, MAX(2 * *capacity, (uint64_t)1024));
+    T *newArray = (T *)realloc(*array, newCapacity * sizeof(T));
+    if (newArray == NULL) {
+        warn("Out of memory\n");
+        return false;
+    }
+
+    *array = newArray;
+    *capacity = newCapacity;
+    return true;
+}
+
+
+//
+//! @functiongroup Recording
+//
+
+void
+SIDCapture::setCheckpointInterval(uint64_t cycles)
+{
+    // Event offsets are stored in 32 bit
+    checkpointInterval = MAX(MIN(cycles, (uint64_t)INT32_MAX), (uint64_t)1);
+}
+
+void
+SIDCapture::begin(ReSID *sid)
+{
+    clear();
+
+    header.chipModel = sid->getChipModel();
+    header.clockFrequency = sid->getClockFrequency();
+    header.sampleRate = sid->getSampleRate();
+    header.samplingMethod = sid->getSamplingMethod();
+    header.audioFilter = sid->getAudioFilter();
+    header.historyLength = sid->getHistoryLength();
+
+    recordCheckpoint(sid);
+}
+
+void
+SIDCapture::recordEvent(ReSID *sid, uint8_t addr, uint8_t value)
+{
+    assert(header.numCheckpoints > 0);
+
+    // Start a new segment if the offset doesn't fit
+    if (sid->getClockedCycles() - lastCheckpoint().cycle > INT32_MAX)
+        recordCheckpoint(sid);
+
+    if (!reserve(&events, &eventCapacity, header.numEvents + 1))
+        return;
+
+    SIDEvent &e = events[header.numEvents++];
+    e.offset = (uint32_t)(sid->getClockedCycles() - lastCheckpoint().cycle);
+    e.addr = addr;
+    e.value = value;
+}
+
+void
+SIDCapture::recordWrite(ReSID *sid, uint8_t addr, uint8_t value)
+{
+    assert(addr != SID_CLOCK_BOUNDARY);
+
+    // A write marks a clock boundary by itself
+    if (header.numEvents > lastCheckpoint().firstEvent) {
+        SIDEvent &e = events[header.numEvents - 1];
+        if (e.addr == SID_CLOCK_BOUNDARY &&
+            e.offset == sid->getClockedCycles() - lastCheckpoint().cycle) {
+            header.numEvents--;
+        }
+    }
+
+    recordEvent(sid, addr, value);
+}
+
+void
+SIDCapture::recordBoundary(ReSID *sid)
+{
+    uint64_t offset = sid->getClockedCycles() - lastCheckpoint().cycle;
+
+    // Skip the boundary if nothing has been executed since the last event
+    if (offset == 0)
+        return;
+    if (header.numEvents > lastCheckpoint().firstEvent &&
+        events[header.numEvents - 1].offset == offset)
+        return;
+
+    recordEvent(sid, SID_CLOCK_BOUNDARY, 0);
+}
+
+void
+SIDCapture::recordCheckpoint(ReSID *sid)
+{
+    uint64_t historyOffset = header.numCheckpoints * header.historyLength;
+
+    if (!reserve(&checkpoints, &checkpointCapacity, header.numCheckpoints + 1) ||
+        !reserve(&history, &historyCapacity, historyOffset + header.historyLength))
+        return;
+
+    SIDCheckpoint &cp = checkpoints[header.numCheckpoints++];
+    cp.cycle = sid->getClockedCycles();
+    cp.sample = sid->getProducedSamples();
+    cp.firstEvent = header.numEvents;
+    cp.historyOffset = historyOffset;
+    sid->getState(cp.state, history + historyOffset);
+}
+
+void
+SIDCapture::end(ReSID *sid)
+{
+    recordCheckpoint(sid);
+
+    debug(1, "Recorded %llu cycles, %llu events, %llu checkpoints\n",
+          numCycles(), numEvents(), numCheckpoints());
+}
+
+
+//
+//! @functiongroup Accessing the recorded data
+//
+
+uint64_t
+SIDCapture::numCycles()
+{
+    return header.numCheckpoints ? lastCheckpoint().cycle - checkpoints[0].cycle : 0;
+}
+
+uint64_t
+SIDCapture::numSamples()
+{
+    return header.numCheckpoints ? lastCheckpoint().sample - checkpoints[0].sample : 0;
+}
+
+
+//
+//! @functiongroup Loading and saving
+//
+
+bool
+SIDCapture::writeToFile(const char *filename)
+{
+    bool success = false;
+    FILE *file;
+
+    assert(filename != NULL);
+    if (!(file = fopen(filename, "w"))) {
+        return false;
+    }
+
+    uint64_t historySize = header.numCheckpoints * header.historyLength;
+    success =
+    fwrite(&header, sizeof(header), 1, file) == 1 &&
+    fwrite(checkpoints, sizeof(SIDCheckpoint), header.numCheckpoints, file) == header.numCheckpoints &&
+    fwrite(events, sizeof(SIDEvent), header.numEvents, file) == header.numEvents &&
+    fwrite(history, sizeof(short), historySize, file) == historySize;
+
+    fclose(file);
+    return success;
+}
+
+bool
+SIDCapture::readFromFile(const char *filename)
+{
+    bool success = false;
+    SIDCaptureHeader h;
+    uint64_t historySize;
+    FILE *file;
+
+    assert(filename != NULL);
+    if (!(file = fopen(filename, "r"))) {
+        return false;
+    }
+
+    // Check header
+    if (fread(&h, sizeof(h), 1, file) != 1 ||
+        memcmp(h.magic, captureMagic, sizeof(h.magic)) != 0 ||
+        h.stateSize != sizeof(ReSIDState)) {
+        warn("%s is not a compatible SID capture\n", filename);
+        goto exit;
+    }
+
+    // Read data
+    clear();
+    historySize = h.numCheckpoints * h.historyLength;
+    if (!reserve(&checkpoints, &checkpointCapacity, h.numCheckpoints) ||
+        !reserve(&events, &eventCapacity, h.numEvents) ||
+        !reserve(&history, &historyCapacity, historySize)) {
+        goto exit;
+    }
+    if (fread(checkpoints, sizeof(SIDCheckpoint), h.numCheckpoints, file) != h.numCheckpoints ||
+        fread(events, sizeof(SIDEvent), h.numEvents, file) != h.numEvents ||
+        fread(history, sizeof(short), historySize, file) != historySize) {
+        goto exit;
+    }
+
+    header = h;
+    success = true;
+
+exit:
+
+    fclose(file);
+    return success;
+}
+
+
+//
+//! @functiongroup Rendering
+//
+
+ReSID *
+SIDCapture::createReSID()
+{
+    ReSID *sid = new ReSID();
+
+    sid->setChipModel((SIDChipModel)header.chipModel);
+    sid->setAudioFilter(header.audioFilter);
+    sid->setSamplingMethod((SamplingMethod)header.samplingMethod);
+    sid->setSampleRate(header.sampleRate);
+    sid->setClockFrequency(header.clockFrequency);
+
+    assert(sid->getHistoryLength() == header.historyLength);
+    return sid;
+}
+
+bool
+SIDCapture::renderSegment(ReSID *sid, uint64_t nr, short *buffer)
+{
+    assert(nr + 1 < header.numCheckpoints);
+
+    SIDCheckpoint &cp = checkpoints[nr];
+    SIDCheckpoint &next = checkpoints[nr + 1];
+    short *out = buffer + (cp.sample - checkpoints[0].sample);
+    size_t capacity = next.sample - cp.sample;
+    size_t count = 0;
+    uint64_t cycle = cp.cycle;
+
+    sid->setState(cp.state, history + cp.historyOffset);
+
+    // Replay all events of this segment
+    for (uint64_t i = cp.firstEvent; i < next.firstEvent; i++) {
+
+        uint64_t target = cp.cycle + events[i].offset;
+        count += sid->render(target - cycle, out + count, capacity - count);
+        cycle = target;
+        if (events[i].addr != SID_CLOCK_BOUNDARY)
+            sid->poke(events[i].addr, events[i].value);
+    }
+    count += sid->render(next.cycle - cycle, out + count, capacity - count);
+
+    return count == capacity;
+}
+
+//! @brief    Work shared among all rendering threads
+typedef struct {
+    SIDCapture *capture;
+    short *buffer;
+    uint64_t segments;
+    uint64_t nextSegment;
+    bool success;
+    pthread_mutex_t lock;
+} SIDRenderJob;
+
+static void *
+renderThread(void *data)
+{
+    SIDRenderJob *job = (SIDRenderJob *)data;
+    ReSID *sid = job->capture->createReSID();
+    bool success = true;
+
+    while (1) {
+
+        // Grab the next segment
+        pthread_mutex_lock(&job->lock);
+        uint64_t nr = job->nextSegment++;
+        pthread_mutex_unlock(&job->lock);
+
+        if (nr >= job->segments)
+            break;
+
+        success &= job->capture->renderSegment(sid, nr, job->buffer);
+    }
+
+    pthread_mutex_lock(&job->lock);
+    job->success &= success;
+    pthread_mutex_unlock(&job->lock);
+
+    delete sid;
+    return NULL;
+}
+
+bool
+SIDCapture::render(short *buffer, unsigned threads)
+{
+    if (header.numCheckpoints < 2)
+        return true;
+
+    if (threads == 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cores > 0 ? (unsigned)cores : 1;
+    }
+
+    SIDRenderJob job;
+    job.capture = this;
+    job.buffer = buffer;
+    job.segments = header.numCheckpoints - 1;
+    job.nextSegment = 0;
+    job.success = true;
+    pthread_mutex_init(&job.lock, NULL);
+
+    threads = (unsigned)MIN((uint64_t)threads, job.segments);
+    pthread_t *thread = new pthread_t[threads];
+    for (unsigned i = 0; i < threads; i++) {
+        pthread_create(&thread[i], NULL, renderThread, &job);
+    }
+    for (unsigned i = 0; i < threads; i++) {
+        pthread_join(thread[i], NULL);
+    }
+    delete [] thread;
+
+    pthread_mutex_destroy(&job.lock);
+    return job.success;
+}
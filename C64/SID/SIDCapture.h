@@ -0,0 +1,214 @@
+/*!
+ * @header      SIDCapture.h
+ * @author      Dirk W. Hoffmann, www.dirkwhoffmann.de
+ * @brief       Declares SIDCapture class
+ */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _SIDCAPTURE_INC
+#define _SIDCAPTURE_INC
+
+#include "VC64Object.h"
+#include "ReSID.h"
+
+//! @brief    Register address of events that only mark a clock boundary
+#define SID_CLOCK_BOUNDARY 0xFF
+
+/*! @brief    A register write or a clock boundary, relative to the preceding checkpoint
+ *  @details  reSID's filter integrates over the cycles passed in a single clock() call.
+ *            Hence, the output depends on how the cycles are split up into calls and all
+ *            boundaries have to be replayed to reproduce the output exactly.
+ */
+typedef struct {
+    uint32_t offset;
+    uint8_t addr;
+    uint8_t value;
+} SIDEvent;
+
+//! @brief    A restore point of the SID stream
+typedef struct {
+
+    //! @brief    reSID cycle and number of produced samples at this point
+    uint64_t cycle;
+    uint64_t sample;
+
+    //! @brief    Index of the first event after this point
+    uint64_t firstEvent;
+
+    //! @brief    Position of the ring buffer history in the history pool
+    uint64_t historyOffset;
+
+    //! @brief    Complete reSID state
+    ReSIDState state;
+
+} SIDCheckpoint;
+
+//! @brief    Configuration of the recorded reSID instance
+typedef struct {
+
+    char magic[8];
+    uint32_t stateSize;
+    uint32_t chipModel;
+    uint32_t clockFrequency;
+    uint32_t sampleRate;
+    uint32_t samplingMethod;
+    uint32_t audioFilter;
+    uint32_t historyLength;
+    uint64_t numCheckpoints;
+    uint64_t numEvents;
+
+} SIDCaptureHeader;
+
+/*! @class    SIDCapture
+ *  @brief    Recorded stream of SID register writes
+ *  @details  While recording, every register write is stored together with the reSID cycle
+ *            it occurred in. The same is done for the end of each execution slice of reSID.
+ *            In regular intervals, and whenever the state of reSID changes by
+ *            other means (reset, snapshot restore), the complete reSID state is stored as a
+ *            checkpoint. Because each segment between two checkpoints can be replayed on its
+ *            own, the stream can be rendered to audio on multiple cores. The rendered samples
+ *            are identical to the ones reSID produced while recording.
+ *  @note     Checkpoints are stored in the binary layout of ReSIDState. Capture files can
+ *            only be read by the build that has written them.
+ */
+class SIDCapture : public VC64Object {
+
+private:
+
+    //! @brief    Configuration of the recorded reSID instance
+    SIDCaptureHeader header;
+
+    //! @brief    Checkpoints and their storage capacity
+    SIDCheckpoint *checkpoints;
+    uint64_t checkpointCapacity;
+
+    //! @brief    Recorded events and their storage capacity
+    SIDEvent *events;
+    uint64_t eventCapacity;
+
+    //! @brief    Ring buffer contents of all checkpoints and its storage capacity
+    short *history;
+    uint64_t historyCapacity;
+
+    //! @brief    Minimum number of cycles between two regular checkpoints
+    uint64_t checkpointInterval;
+
+public:
+
+    //! @brief    Constructor
+    SIDCapture();
+
+    //! @brief    Destructor
+    ~SIDCapture();
+
+    //! @brief    Deletes all recorded data
+    void clear();
+
+
+    //
+    //! @functiongroup Recording
+    //
+
+    //! @brief    Sets the minimum number of cycles between two regular checkpoints
+    void setCheckpointInterval(uint64_t cycles);
+
+    //! @brief    Starts a new recording. Stores the configuration and the first checkpoint
+    void begin(ReSID *sid);
+
+    //! @brief    Records a register write that has been passed to reSID
+    void recordWrite(ReSID *sid, uint8_t addr, uint8_t value);
+    
+    //! @brief    Records the end of an execution slice
+    void recordBoundary(ReSID *sid);
+
+    //! @brief    Stores the current reSID state as a checkpoint
+    void recordCheckpoint(ReSID *sid);
+
+    /*! @brief    Needs to be called after reSID has been executed
+     *  @details  Stores a checkpoint if the regular interval has elapsed. Otherwise, the
+     *            end of the execution slice is recorded.
+     */
+    void update(ReSID *sid) {
+        if (sid->getClockedCycles() - lastCheckpoint().cycle >= checkpointInterval)
+            recordCheckpoint(sid);
+        else
+            recordBoundary(sid);
+    }
+
+    //! @brief    Finishes the recording with a final checkpoint
+    void end(ReSID *sid);
+
+
+    //
+    //! @functiongroup Accessing the recorded data
+    //
+
+    //! @brief    Returns the number of checkpoints
+    uint64_t numCheckpoints() { return header.numCheckpoints; }
+
+    //! @brief    Returns the number of recorded events
+    uint64_t numEvents() { return header.numEvents; }
+
+    //! @brief    Returns the number of recorded cycles
+    uint64_t numCycles();
+
+    //! @brief    Returns the number of sound samples covered by the recording
+    uint64_t numSamples();
+
+    //! @brief    Returns the most recently stored checkpoint
+    SIDCheckpoint &lastCheckpoint() { return checkpoints[header.numCheckpoints - 1]; }
+
+
+    //
+    //! @functiongroup Loading and saving
+    //
+
+    //! @brief    Writes the capture into a file
+    bool writeToFile(const char *filename);
+
+    //! @brief    Reads a capture from a file
+    bool readFromFile(const char *filename);
+
+
+    //
+    //! @functiongroup Rendering
+    //
+
+    /*! @brief    Renders the recorded stream into a buffer of numSamples() samples
+     *  @details  The segments between two checkpoints are distributed among the specified
+     *            number of threads. If threads is 0, one thread per core is used.
+     *  @return   true if all segments have been rendered completely
+     */
+    bool render(short *buffer, unsigned threads = 0);
+
+    //! @brief    Creates a reSID instance with the recorded configuration
+    ReSID *createReSID();
+
+    /*! @brief    Renders a single segment with the provided reSID instance
+     *  @param    buffer  Start of the buffer holding the whole stream
+     */
+    bool renderSegment(ReSID *sid, uint64_t nr, short *buffer);
+
+private:
+
+    //! @brief    Adds an event at the current reSID cycle
+    void recordEvent(ReSID *sid, uint8_t addr, uint8_t value);
+
+    //! @brief    Makes room for one more element in a growing array
+    template <class T> bool reserve(T **array, uint64_t *capacity, uint64_t size);
+};
+
+#endif
@@ -23,7 +23,8 @@ typedef enum {
     SID_SAMPLE_FAST,
     SID_SAMPLE_INTERPOLATE,
     SID_SAMPLE_RESAMPLE,
-    SID_SAMPLE_RESAMPLE_FASTMEM
+    SID_SAMPLE_RESAMPLE_FASTMEM,
+    SID_SAMPLE_DECIMATE
 } SamplingMethod;
 
 /*! @brief    SID info
@@ -47,6 +47,10 @@ SID::SID()
   fir_beta = 0;
   fir_f_cycles_per_sample = 0;
   fir_filter_scale = 0;
+  halfband_fir = 0;
+  halfband_sample = 0;
+  halfband_stages = 0;
+  halfband_phase = 0;
 
   sid_model = MOS6581;
   voice[0].set_sync_source(&voice[2]);
@@ -70,6 +74,8 @@ SID::~SID()
 {
   delete[] sample;
   delete[] fir;
+  delete[] halfband_fir;
+  delete[] halfband_sample;
 }
 
 
@@ -419,6 +425,9 @@ void SID::write_state(const State& state)
     voice[i].envelope.hold_zero = state.hold_zero[i];
     voice[i].envelope.envelope_pipeline = state.envelope_pipeline[i];
   }
+
+  // The sampled ENV3 value is stored in the read only register.
+  voice[2].envelope.env3 = state.sid_register[0x1c];
 }
 
 
@@ -508,12 +517,16 @@ double SID::I0(double x)
 // E.g. for a 44.1kHz sampling rate the end of passband frequency is limited
 // to slightly below 20kHz. This constraint ensures that the FIR table is
 // not overfilled.
+//
+// For decimation, the same constraints apply. The FIR tables are built for
+// the output rate of the last half-band stage instead of the clock frequency.
 // ----------------------------------------------------------------------------
 bool SID::set_sampling_parameters(double clock_freq, sampling_method method,
                         double sample_freq, double pass_freq, double filter_scale)
 {
   // Check resampling constraints.
-  if (method == SAMPLE_RESAMPLE || method == SAMPLE_RESAMPLE_FASTMEM)
+  if (method == SAMPLE_RESAMPLE || method == SAMPLE_RESAMPLE_FASTMEM ||
+      method == SAMPLE_DECIMATE)
   {
     // Check whether the sample ring buffer would overfill.
     if (FIR_N*clock_freq/sample_freq >= RINGSIZE) {
@@ -550,8 +563,19 @@ bool SID::set_sampling_parameters(double clock_freq, sampling_method method,
   sample_prev = 0;
   sample_now = 0;
 
+  // Half-band initialization is only necessary for decimation.
+  if (method != SAMPLE_DECIMATE)
+  {
+    delete[] halfband_fir;
+    delete[] halfband_sample;
+    halfband_fir = 0;
+    halfband_sample = 0;
+    halfband_stages = 0;
+  }
+
   // FIR initialization is only necessary for resampling.
-  if (method != SAMPLE_RESAMPLE && method != SAMPLE_RESAMPLE_FASTMEM)
+  if (method != SAMPLE_RESAMPLE && method != SAMPLE_RESAMPLE_FASTMEM &&
+      method != SAMPLE_DECIMATE)
   {
     delete[] sample;
     delete[] fir;
@@ -570,6 +594,12 @@ bool SID::set_sampling_parameters(double clock_freq, sampling_method method,
   }
   sample_index = 0;
 
+  // The FIR tables resample the output of the last half-band stage.
+  if (method == SAMPLE_DECIMATE) {
+    set_halfband_parameters(clock_freq, sample_freq, pass_freq);
+    clock_freq /= 1 << halfband_stages;
+  }
+
   const double pi = 3.1415926535897932385;
 
   // 16 bits -> -96dB stopband attenuation.
@@ -602,8 +632,8 @@ bool SID::set_sampling_parameters(double clock_freq, sampling_method method,
 
   // We clamp the filter table resolution to 2^n, making the fixed point
   // sample_offset a whole multiple of the filter table resolution.
-  int res = method == SAMPLE_RESAMPLE ?
-    FIR_RES : FIR_RES_FASTMEM;
+  int res = method == SAMPLE_RESAMPLE_FASTMEM ?
+    FIR_RES_FASTMEM : FIR_RES;
   int n = (int)ceil(log(res/f_cycles_per_sample)/log(2.0f));
   int fir_RES_new = 1 << n;
 
@@ -644,6 +674,108 @@ bool SID::set_sampling_parameters(double clock_freq, sampling_method method,
 }
 
 
+// ----------------------------------------------------------------------------
+// Setting of half-band decimation parameters.
+//
+// Each stage halves the sample rate. Everything above sample_freq - pass_freq
+// must end up in the stopband of the FIR tables, which is where all aliases
+// of the final resampling step are mapped to. Thus, a stage running at f
+// passes everything up to sample_freq - pass_freq, and stops everything
+// above f/2 - (sample_freq - pass_freq), which would otherwise be aliased
+// below sample_freq - pass_freq. This transition band is symmetric around
+// f/4, so the ideal filter is a half-band filter. Its impulse response is
+// zero at every second tap except the center tap.
+//
+// The transition band is wide in the first stages, and gets narrower with
+// each stage, while the FIR tables get shorter. The number of stages is
+// chosen to minimize the number of multiplications per second.
+// ----------------------------------------------------------------------------
+void SID::set_halfband_parameters(double clock_freq, double sample_freq,
+                                  double pass_freq)
+{
+  const double pi = 3.1415926535897932385;
+
+  // 16 bits -> -96dB stopband attenuation (like the FIR tables).
+  const double A = -20*log10(1.0/(1 << 16));
+  const double beta = 0.1102*(A - 8.7);
+  const double I0beta = I0(beta);
+
+  // End of the passband of the half-band filters.
+  double p = sample_freq - pass_freq;
+
+  // Order of the FIR tables (see set_sampling_parameters()).
+  double fir_dw = (1 - 2*pass_freq/sample_freq)*pi*2;
+  int fir_order = int((A - 7.95)/(2.285*fir_dw) + 0.5);
+
+  // Filter order of each possible stage.
+  int order[HALFBAND_STAGES];
+
+  // Multiplications per second in the half-band stages and in total.
+  double halfband_cost = 0;
+  double best = 0;
+
+  halfband_stages = 0;
+  for (int stages = 0; ; stages++) {
+    double f = clock_freq/(1 << stages);
+
+    double cost = halfband_cost + 2*(fir_order*f/sample_freq + 1)*sample_freq;
+    if (!stages || cost < best) {
+      best = cost;
+      halfband_stages = stages;
+    }
+
+    // Check whether the output of another stage could still be resampled.
+    if (stages == HALFBAND_STAGES || f/2 < sample_freq || f <= 4*p) {
+      break;
+    }
+
+    // The filter order is rounded up to 4*k + 2, making the outermost taps
+    // odd taps. The filter length is 4*k + 3.
+    double dw = (1 - 4*p/f)*pi;
+    int N = int((A - 7.95)/(2.285*dw) + 0.5);
+    N = ((N + 1) & ~3) + 2;
+    if (N >= HALFBAND_RINGSIZE) {
+      break;
+    }
+
+    order[stages] = N;
+    halfband_cost += ((N + 2)/4 + 1)*f/2;
+  }
+  halfband_phase = 0;
+
+  // Allocate coefficients and sample buffers.
+  if (!halfband_fir) {
+    halfband_fir = new short[HALFBAND_STAGES*HALFBAND_RINGSIZE];
+  }
+  if (!halfband_sample) {
+    halfband_sample = new short[HALFBAND_STAGES*HALFBAND_RINGSIZE*2];
+  }
+  // Clear sample buffers.
+  for (int j = 0; j < HALFBAND_STAGES*HALFBAND_RINGSIZE*2; j++) {
+    halfband_sample[j] = 0;
+  }
+
+  for (int i = 0; i < halfband_stages; i++) {
+    int N = order[i];
+
+    halfband_N[i] = N + 1;
+    halfband_index[i] = 0;
+    halfband_center[i] = 1 << (FIR_SHIFT - 1);
+
+    // Calculate the odd taps, starting with the outermost one. This is the
+    // sinc function with cutoff frequency f/4, weighted by the Kaiser window.
+    short* fir_start = halfband_fir + i*HALFBAND_RINGSIZE;
+    for (int j = 0; j < (N + 2)/4; j++) {
+      int k = N/2 - 2*j;
+      double temp = double(k)/(N/2);
+      double Kaiser = I0(beta*sqrt(1 - temp*temp))/I0beta;
+      double sinc = sin(pi*k/2)/(pi*k);
+      fir_start[j] = (short)round((1 << FIR_SHIFT)*sinc*Kaiser);
+    }
+  }
+}
+
+
 // ----------------------------------------------------------------------------
 // Adjustment of SID sampling frequency.
 //
@@ -782,6 +914,8 @@ int SID::clock(cycle_count& delta_t, short* buf, int n, int interleave)
     return clock_resample(delta_t, buf, n, interleave);
   case SAMPLE_RESAMPLE_FASTMEM:
     return clock_resample_fastmem(delta_t, buf, n, interleave);
+  case SAMPLE_DECIMATE:
+    return clock_decimate(delta_t, buf, n, interleave);
   }
 }
 
@@ -1024,4 +1158,90 @@ int SID::clock_resample_fastmem(cycle_count& delta_t, short* buf, int n, int int
   return s;
 }
 
+
+// ----------------------------------------------------------------------------
+// SID clocking with audio sampling - cycle based with multistage decimation.
+//
+// This yields the same quality as clock_resample(). Instead of convolving
+// the output of every cycle with a single long filter, the output is passed
+// through a cascade of half-band filters first (see decimate()). Each stage
+// halves the sample rate, so the FIR tables are applied to a signal at less
+// than twice the sample frequency. For a sample frequency of 44.1kHz, this
+// reduces the filter length from ~ 1400 to ~ 90, and adds ~ 6 multiplications
+// per cycle in the half-band stages.
+// ----------------------------------------------------------------------------
+int SID::clock_decimate(cycle_count& delta_t, short* buf, int n, int interleave)
+{
+  int s;
+
+  for (s = 0; s < n; s++) {
+    cycle_count next_sample_offset = sample_offset + cycles_per_sample;
+    cycle_count delta_t_sample = next_sample_offset >> FIXP_SHIFT;
+
+    if (delta_t_sample > delta_t) {
+      delta_t_sample = delta_t;
+    }
+
+    for (int i = 0; i < delta_t_sample; i++) {
+      clock();
+      decimate(output());
+    }
+
+    if ((delta_t -= delta_t_sample) == 0) {
+      sample_offset -= delta_t_sample << FIXP_SHIFT;
+      break;
+    }
+
+    sample_offset = next_sample_offset & FIXP_MASK;
+
+    // The position of the output sample is measured in samples of the last
+    // half-band stage, starting at the most recent one.
+    cycle_count offset =
+      ((halfband_phase << FIXP_SHIFT) + sample_offset) >> halfband_stages;
+
+    int fir_offset = offset*fir_RES >> FIXP_SHIFT;
+    int fir_offset_rmd = offset*fir_RES & FIXP_MASK;
+    short* fir_start = fir + fir_offset*fir_N;
+    short* sample_start = sample + sample_index - fir_N - 1 + RINGSIZE;
+
+    // Convolution with filter impulse response.
+    int v1 = 0;
+    for (int j = 0; j < fir_N; j++) {
+      v1 += sample_start[j]*fir_start[j];
+    }
+
+    // Use next FIR table, wrap around to first FIR table using
+    // next sample.
+    if (unlikely(++fir_offset == fir_RES)) {
+      fir_offset = 0;
+      ++sample_start;
+    }
+    fir_start = fir + fir_offset*fir_N;
+
+    // Convolution with filter impulse response.
+    int v2 = 0;
+    for (int k = 0; k < fir_N; k++) {
+      v2 += sample_start[k]*fir_start[k];
+    }
+
+    // Linear interpolation.
+    int v = v1 + (fir_offset_rmd*(v2 - v1) >> FIXP_SHIFT);
+
+    v >>= FIR_SHIFT;
+
+    // Saturated arithmetics to guard against 16 bit sample overflow.
+    const int half = 1 << 15;
+    if (v >= half) {
+      v = half - 1;
+    }
+    else if (v < -half) {
+      v = -half;
+    }
+
+    buf[s*interleave] = v;
+  }
+
+  return s;
+}
+
 } // namespace reSID
@@ -104,6 +104,10 @@ public:
   int clock_interpolate(cycle_count& delta_t, short* buf, int n, int interleave);
   int clock_resample(cycle_count& delta_t, short* buf, int n, int interleave);
   int clock_resample_fastmem(cycle_count& delta_t, short* buf, int n, int interleave);
+  int clock_decimate(cycle_count& delta_t, short* buf, int n, int interleave);
+  void decimate(short output);
+  void set_halfband_parameters(double clock_freq, double sample_freq,
+  double pass_freq);
   void write();
 
   chip_model sid_model;
@@ -141,6 +145,14 @@ public:
     RINGSIZE = 1 << 14,
     RINGMASK = RINGSIZE - 1,
 
+    // Half-band decimation constants.
+    // Each stage halves the sample rate, so 6 stages are sufficient for
+    // resampling from ~ 1MHz down to ~ 8kHz. A stage is only used if its
+    // filter fits into the ring buffer.
+    HALFBAND_STAGES = 8,
+    HALFBAND_RINGSIZE = 1 << 8,
+    HALFBAND_RINGMASK = HALFBAND_RINGSIZE - 1,
+
     // Fixed point constants (16.16 bits).
     FIXP_SHIFT = 16,
     FIXP_MASK = 0xffff
@@ -163,6 +175,24 @@ public:
 
   // FIR_RES filter tables (FIR_N*FIR_RES).
   short* fir;
+
+  // Half-band decimation stages (SAMPLE_DECIMATE).
+  // Stage i runs at clock_freq/2^i and feeds every second output sample
+  // into the next stage. The last stage feeds the sample ring buffer above,
+  // which is resampled by the FIR tables. halfband_phase counts the cycles
+  // since the last stage has produced a sample.
+  int halfband_stages;
+  int halfband_phase;
+  int halfband_N[HALFBAND_STAGES];
+  int halfband_index[HALFBAND_STAGES];
+
+  // Coefficients of the odd taps of each stage (HALFBAND_RINGSIZE per
+  // stage). The even taps are zero, except for the center tap.
+  short* halfband_fir;
+  short halfband_center[HALFBAND_STAGES];
+
+  // Ring buffers with overflow for contiguous storage, one per stage.
+  short* halfband_sample;
 };
 
 
@@ -229,6 +259,59 @@ void SID::clock()
   }
 }
 
+
+// ----------------------------------------------------------------------------
+// Half-band decimation - 1 cycle.
+//
+// The output of the cycle is passed down the half-band stages until a stage
+// has consumed an odd number of samples. Since the half-band filters are
+// symmetric and every second tap is zero, a stage output takes only about
+// a quarter of the filter length in multiplications.
+// ----------------------------------------------------------------------------
+RESID_INLINE
+void SID::decimate(short output)
+{
+  int v = output;
+  int phase = halfband_phase = (halfband_phase + 1) & ((1 << halfband_stages) - 1);
+
+  for (int i = 0; i < halfband_stages; i++, phase >>= 1) {
+    short* ring = halfband_sample + i*HALFBAND_RINGSIZE*2;
+    int index = halfband_index[i];
+    ring[index] = ring[index + HALFBAND_RINGSIZE] = v;
+    halfband_index[i] = (index + 1) & HALFBAND_RINGMASK;
+
+    // Every second sample is dropped.
+    if (phase & 1) {
+      return;
+    }
+
+    int N = halfband_N[i];
+    short* sample_end = ring + index + HALFBAND_RINGSIZE;
+    short* sample_start = sample_end - N + 1;
+    short* fir_start = halfband_fir + i*HALFBAND_RINGSIZE;
+
+    // Convolution with filter impulse response.
+    v = sample_start[N/2]*halfband_center[i];
+    for (int j = 0; j < (N + 1)/4; j++) {
+      v += (sample_start[2*j] + sample_end[-2*j])*fir_start[j];
+    }
+
+    v = (v + (1 << (FIR_SHIFT - 1))) >> FIR_SHIFT;
+
+    // Saturated arithmetics to guard against 16 bit sample overflow.
+    const int half = 1 << 15;
+    if (v >= half) {
+      v = half - 1;
+    }
+    else if (v < -half) {
+      v = -half;
+    }
+  }
+
+  sample[sample_index] = sample[sample_index + RINGSIZE] = v;
+  ++sample_index &= RINGMASK;
+}
+
 #endif // RESID_INLINING || defined(RESID_SID_CC)
 
 } // namespace reSID
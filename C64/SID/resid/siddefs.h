@@ -75,7 +75,8 @@ enum sampling_method {
     SAMPLE_FAST, 
     SAMPLE_INTERPOLATE,
     SAMPLE_RESAMPLE, 
-    SAMPLE_RESAMPLE_FASTMEM 
+    SAMPLE_RESAMPLE_FASTMEM,
+    SAMPLE_DECIMATE
 };
 
 } // namespace reSID
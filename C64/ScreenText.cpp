@@ -0,0 +1,489 @@
+/*!
+ * @file        ScreenText.cpp
+ * @author      Dirk W. Hoffmann, www.dirkwhoffmann.de
+ * @copyright   2018 Dirk W. Hoffmann
+ */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "C64.h"
+
+// Unicode characters of screen codes $40 - $7F in the uppercase / graphics character set.
+// Block and line graphics are mapped to the closest characters of the "Symbols for Legacy
+// Computing" block.
+static const uint32_t graphics[64] = {
+    0x2500, 0x2660, 0x1FB72, 0x1FB78, 0x1FB77, 0x1FB76, 0x1FB7A, 0x1FB71,
+    0x1FB74, 0x256E, 0x2570, 0x256F, 0x1FB7C, 0x2572, 0x2571, 0x1FB7D,
+    0x1FB7E, 0x25CF, 0x1FB7B, 0x2665, 0x1FB70, 0x256D, 0x2573, 0x25CB,
+    0x2663, 0x1FB75, 0x2666, 0x253C, 0x1FB8C, 0x2502, 0x03C0, 0x25E5,
+    0x0020, 0x258C, 0x2584, 0x2594, 0x2581, 0x258F, 0x2592, 0x2595,
+    0x1FB8F, 0x25E4, 0x1FB87, 0x251C, 0x2597, 0x2514, 0x2510, 0x2582,
+    0x250C, 0x2534, 0x252C, 0x2524, 0x258E, 0x258D, 0x1FB88, 0x1FB82,
+    0x1FB83, 0x2583, 0x1FB7F, 0x2596, 0x259D, 0x2518, 0x2598, 0x259A
+};
+
+/*! @brief    Translates a screen code ($00 - $7F) into Unicode
+ *  @param    lowercase  Selects the lowercase / uppercase character set
+ */
+static uint32_t
+screenCodeToUnicode(uint8_t code, bool lowercase)
+{
+    assert(code < 0x80);
+
+    if (code == 0x00) return '@';
+    if (code <= 0x1A) return (lowercase ? 'a' : 'A') + code - 1;
+    if (code < 0x20) {
+        static const uint32_t special[5] = { '[', 0x00A3, ']', 0x2191, 0x2190 };
+        return special[code - 0x1B];
+    }
+    if (code < 0x40) return code;
+
+    if (lowercase) {
+        if (code >= 0x41 && code <= 0x5A) return 'A' + code - 0x41;
+        switch (code) {
+            case 0x5E: return 0x1FB95;
+            case 0x5F: return 0x1FB98;
+            case 0x69: return 0x1FB99;
+            case 0x7A: return 0x2713;
+        }
+    }
+    return graphics[code - 0x40];
+}
+
+ScreenText::ScreenText()
+{
+    setDescription("ScreenText");
+    debug(3, "  Creating screen text decoder at address %p...\n", this);
+
+    userGlyphs = 0;
+    romFingerprint = 0;
+    memset(glyphKey, 0, sizeof(glyphKey));
+    memset(watched, 0, sizeof(watched));
+    found = false;
+    stopRequest = false;
+
+    for (unsigned i = 0; i < ROWS * COLUMNS; i++) {
+        text[i] = ' ';
+        color[i] = 0;
+        screenCode[i] = 0x20;
+        reversed[i] = false;
+    }
+    background = 0;
+    textMode = false;
+    unknownGlyphs = 0;
+}
+
+void
+ScreenText::reset()
+{
+    VirtualComponent::reset();
+
+    for (unsigned i = 0; i < ROWS * COLUMNS; i++) {
+        text[i] = ' ';
+        color[i] = 0;
+        screenCode[i] = 0x20;
+        reversed[i] = false;
+    }
+    background = 0;
+    textMode = false;
+    unknownGlyphs = 0;
+    found = false;
+    stopRequest = false;
+}
+
+void
+ScreenText::dumpState()
+{
+    char row[4 * COLUMNS + 1];
+
+    msg("ScreenText:\n");
+    msg("-----------\n\n");
+    msg("     Text mode : %s\n", textMode ? "yes" : "no");
+    msg("Unknown glyphs : %d\n", unknownGlyphs);
+    msg("   User glyphs : %d\n", userGlyphs);
+    msg("      Watching : %s\n", isWatching() ? "yes" : "no");
+    msg("\n");
+    for (unsigned i = 0; i < ROWS; i++) {
+        getRow(i, row, sizeof(row));
+        msg("%s\n", row);
+    }
+    msg("\n");
+}
+
+
+//
+//! @functiongroup Decoding the screen
+//
+
+bool
+ScreenText::update()
+{
+    VIC *vic = &c64->vic;
+    DisplayMode mode = vic->getDisplayMode();
+
+    background = vic->getBackgroundColor() & 0x0F;
+    unknownGlyphs = 0;
+    textMode =
+    mode == STANDARD_TEXT || mode == MULTICOLOR_TEXT || mode == EXTENDED_BACKGROUND_COLOR;
+
+    if (!textMode) {
+        for (unsigned i = 0; i < ROWS * COLUMNS; i++) {
+            text[i] = ' ';
+            color[i] = 0;
+            screenCode[i] = 0x20;
+            reversed[i] = false;
+        }
+        return false;
+    }
+
+    bool ecm = (mode == EXTENDED_BACKGROUND_COLOR);
+    uint16_t matrix = vic->getScreenMemoryAddr();
+    uint16_t chars = vic->getCharacterMemoryAddr();
+
+    // VIC sees the character ROM at $1000 - $1FFF in banks 0 and 2
+    bool rom =
+    !c64->getUltimax() && (vic->getMemoryBankAddr() & 0x4000) == 0 && (chars & 0x3000) == 0x1000;
+    bool lowercase = (chars & 0x0800) != 0;
+
+    // Glyphs are decoded once per screen code
+    uint32_t decoded[256];
+    bool inverse[256];
+    bool known[256];
+    memset(known, 0, sizeof(known));
+
+    if (!rom)
+        updateGlyphTable();
+
+    for (unsigned i = 0; i < ROWS * COLUMNS; i++) {
+
+        uint8_t code = vic->memSpyAccess((matrix + i) & 0x3FFF);
+        uint8_t glyph = ecm ? (code & 0x3F) : code;
+
+        screenCode[i] = code;
+        color[i] = c64->mem.colorRam[i] & 0x0F;
+
+        if (!known[glyph]) {
+
+            known[glyph] = true;
+
+            if (rom) {
+
+                decoded[glyph] = screenCodeToUnicode(glyph & 0x7F, lowercase);
+                inverse[glyph] = (glyph & 0x80) != 0;
+
+            } else {
+
+                uint64_t key = 0;
+                for (unsigned j = 0; j < 8; j++)
+                    key = (key << 8) | vic->memSpyAccess(chars + 8 * glyph + j);
+
+                inverse[glyph] = false;
+                if (key == 0) {
+                    decoded[glyph] = ' ';
+                } else if (key == UINT64_MAX) {
+                    decoded[glyph] = ' ';
+                    inverse[glyph] = true;
+                } else if ((decoded[glyph] = lookupGlyph(key)) == UNKNOWN) {
+                    if ((decoded[glyph] = lookupGlyph(~key)) != UNKNOWN)
+                        inverse[glyph] = true;
+                }
+            }
+        }
+
+        text[i] = decoded[glyph];
+        reversed[i] = inverse[glyph];
+        if (text[i] == UNKNOWN) unknownGlyphs++;
+    }
+
+    return true;
+}
+
+size_t
+ScreenText::getRow(unsigned row, char *buffer, size_t size)
+{
+    assert(row < ROWS);
+    assert(buffer != NULL && size > 0);
+
+    uint32_t *chars = &text[row * COLUMNS];
+    unsigned length = COLUMNS;
+    while (length > 0 && chars[length - 1] == ' ')
+        length--;
+
+    size_t pos = 0;
+    for (unsigned i = 0; i < length; i++)
+        pos = encodeUtf8(chars[i], buffer, pos, size);
+
+    buffer[pos] = 0;
+    return pos;
+}
+
+size_t
+ScreenText::getText(char *buffer, size_t size)
+{
+    assert(buffer != NULL && size > 0);
+
+    size_t pos = 0;
+    for (unsigned i = 0; i < ROWS; i++) {
+        if (i > 0 && pos + 1 < size)
+            buffer[pos++] = '\n';
+        pos += getRow(i, buffer + pos, size - pos);
+    }
+    return pos;
+}
+
+bool
+ScreenText::find(const char *utf8, unsigned *row, unsigned *column)
+{
+    uint32_t needle[COLUMNS + 1];
+    unsigned length = decodeUtf8(utf8, needle, COLUMNS);
+
+    if (length == 0)
+        return false;
+
+    for (unsigned i = 0; i < ROWS; i++) {
+        uint32_t *chars = &text[i * COLUMNS];
+        for (unsigned j = 0; j + length <= COLUMNS; j++) {
+            if (memcmp(chars + j, needle, length * sizeof(uint32_t)) == 0) {
+                if (row) *row = i;
+                if (column) *column = j;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+
+//
+//! @functiongroup Managing glyphs
+//
+
+void
+ScreenText::defineGlyph(const uint8_t *bitmap, uint32_t unicode)
+{
+    assert(bitmap != NULL);
+
+    uint64_t key = 0;
+    for (unsigned i = 0; i < 8; i++)
+        key = (key << 8) | bitmap[i];
+
+    // Redefining a glyph replaces the old definition
+    for (unsigned i = 0; i < userGlyphs; i++) {
+        if (userKey[i] == key) {
+            userChar[i] = unicode;
+            romFingerprint = 0;
+            return;
+        }
+    }
+
+    if (userGlyphs == MAX_USER_GLYPHS) {
+        warn("Can't define more than %d glyphs.\n", MAX_USER_GLYPHS);
+        return;
+    }
+
+    userKey[userGlyphs] = key;
+    userChar[userGlyphs] = unicode;
+    userGlyphs++;
+    romFingerprint = 0;
+}
+
+void
+ScreenText::deleteGlyphs()
+{
+    userGlyphs = 0;
+    romFingerprint = 0;
+}
+
+void
+ScreenText::updateGlyphTable()
+{
+    uint8_t *charRom = &c64->mem.rom[0xD000];
+
+    // FNV-1a hash over the character ROM (never 0)
+    uint64_t fingerprint = 0xcbf29ce484222325;
+    for (unsigned i = 0; i < 0x1000; i++)
+        fingerprint = (fingerprint ^ charRom[i]) * 0x100000001b3;
+    fingerprint |= 1;
+
+    if (fingerprint == romFingerprint)
+        return;
+
+    debug(2, "Rebuilding glyph table\n");
+    memset(glyphKey, 0, sizeof(glyphKey));
+
+    // User defined glyphs take precedence
+    for (unsigned i = 0; i < userGlyphs; i++)
+        insertGlyph(userKey[i], userChar[i], true);
+
+    // If a glyph appears twice, the uppercase character set wins
+    for (unsigned set = 0; set < 2; set++) {
+        for (unsigned code = 0; code < 0x80; code++) {
+
+            uint64_t key = 0;
+            for (unsigned j = 0; j < 8; j++)
+                key = (key << 8) | charRom[set * 0x800 + code * 8 + j];
+
+            insertGlyph(key, screenCodeToUnicode(code, set == 1), false);
+        }
+    }
+
+    romFingerprint = fingerprint;
+}
+
+void
+ScreenText::insertGlyph(uint64_t key, uint32_t unicode, bool replace)
+{
+    // Blank glyphs are handled by the decoder directly
+    if (key == 0 || key == UINT64_MAX)
+        return;
+
+    unsigned slot = (unsigned)((key * 0x9E3779B97F4A7C15) >> 53) & (GLYPH_SLOTS - 1);
+    for (unsigned i = 0; i < GLYPH_SLOTS; i++, slot = (slot + 1) & (GLYPH_SLOTS - 1)) {
+
+        if (glyphKey[slot] == 0) {
+            glyphKey[slot] = key;
+            glyphChar[slot] = unicode;
+            return;
+        }
+        if (glyphKey[slot] == key) {
+            if (replace) glyphChar[slot] = unicode;
+            return;
+        }
+    }
+    warn("Glyph table is full.\n");
+}
+
+uint32_t
+ScreenText::lookupGlyph(uint64_t key)
+{
+    unsigned slot = (unsigned)((key * 0x9E3779B97F4A7C15) >> 53) & (GLYPH_SLOTS - 1);
+    for (unsigned i = 0; i < GLYPH_SLOTS; i++, slot = (slot + 1) & (GLYPH_SLOTS - 1)) {
+
+        if (glyphKey[slot] == key)
+            return glyphChar[slot];
+        if (glyphKey[slot] == 0)
+            break;
+    }
+    return UNKNOWN;
+}
+
+
+//
+//! @functiongroup Watching the screen
+//
+
+void
+ScreenText::watch(const char *utf8)
+{
+    watched[0] = 0;
+    found = false;
+    stopRequest = false;
+
+    if (utf8 != NULL && decodeUtf8(utf8, watched, COLUMNS) == 0) {
+        warn("Can't watch for an empty string.\n");
+    }
+}
+
+void
+ScreenText::checkWatch()
+{
+    assert(isWatching());
+
+    update();
+
+    unsigned length = 0;
+    while (watched[length]) length++;
+
+    for (unsigned i = 0; i < ROWS; i++) {
+        uint32_t *chars = &text[i * COLUMNS];
+        for (unsigned j = 0; j + length <= COLUMNS; j++) {
+            if (memcmp(chars + j, watched, length * sizeof(uint32_t)) == 0) {
+
+                debug(2, "Watched text found in row %d, column %d\n", i, j);
+                watched[0] = 0;
+                found = true;
+                stopRequest = true;
+                return;
+            }
+        }
+    }
+}
+
+
+//
+//! @functiongroup Converting strings
+//
+
+unsigned
+ScreenText::decodeUtf8(const char *src, uint32_t *dst, unsigned max)
+{
+    assert(src != NULL && dst != NULL);
+
+    const uint8_t *s = (const uint8_t *)src;
+    unsigned count = 0;
+
+    while (*s && count < max) {
+
+        uint32_t c = *s++;
+        unsigned follow = 0;
+
+        if (c >= 0xF0) { c &= 0x07; follow = 3; }
+        else if (c >= 0xE0) { c &= 0x0F; follow = 2; }
+        else if (c >= 0xC0) { c &= 0x1F; follow = 1; }
+        else if (c >= 0x80) { c = UNKNOWN; }
+
+        for (; follow > 0; follow--) {
+            if ((*s & 0xC0) != 0x80) { c = UNKNOWN; break; }
+            c = (c << 6) | (*s++ & 0x3F);
+        }
+        dst[count++] = c;
+    }
+
+    dst[count] = 0;
+    return count;
+}
+
+size_t
+ScreenText::encodeUtf8(uint32_t c, char *dst, size_t pos, size_t size)
+{
+    char bytes[4];
+    size_t length;
+
+    if (c < 0x80) {
+        bytes[0] = (char)c; length = 1;
+    } else if (c < 0x800) {
+        bytes[0] = (char)(0xC0 | (c >> 6));
+        bytes[1] = (char)(0x80 | (c & 0x3F));
+        length = 2;
+    } else if (c < 0x10000) {
+        bytes[0] = (char)(0xE0 | (c >> 12));
+        bytes[1] = (char)(0x80 | ((c >> 6) & 0x3F));
+        bytes[2] = (char)(0x80 | (c & 0x3F));
+        length = 3;
+    } else {
+        bytes[0] = (char)(0xF0 | (c >> 18));
+        bytes[1] = (char)(0x80 | ((c >> 12) & 0x3F));
+        bytes[2] = (char)(0x80 | ((c >> 6) & 0x3F));
+        bytes[3] = (char)(0x80 | (c & 0x3F));
+        length = 4;
+    }
+
+    // Characters that don't fit are dropped
+    if (pos + length >= size)
+        return pos;
+
+    memcpy(dst + pos, bytes, length);
+    return pos + length;
+}
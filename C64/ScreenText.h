@@ -0,0 +1,205 @@
+/*!
+ * @header      ScreenText.h
+ * @author      Dirk W. Hoffmann, www.dirkwhoffmann.de
+ * @copyright   2018 Dirk W. Hoffmann
+ */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _SCREENTEXT_INC
+#define _SCREENTEXT_INC
+
+#include "VirtualComponent.h"
+
+/*! @class    ScreenText
+ *  @brief    Decodes the text screen into Unicode characters
+ *  @details  The decoder reads the video matrix and the character set the same way VIC does.
+ *            If the character set is taken from the character ROM, screen codes are translated
+ *            by a table. Otherwise, the glyphs are looked up in a hash table which maps the eight
+ *            bytes of a glyph to a Unicode character. The table is filled with all glyphs of the
+ *            character ROM and any number of user defined glyphs. Hence, custom character sets
+ *            that reuse ROM glyphs are decoded without further ado.
+ *            The C64 can watch the screen for a text. The screen is checked at the end of each
+ *            frame and the execution thread stops as soon as the text shows up.
+ */
+class ScreenText : public VirtualComponent {
+
+public:
+
+    //! @brief    Size of the text screen
+    static const unsigned ROWS = 25;
+    static const unsigned COLUMNS = 40;
+
+    //! @brief    Unicode character reported for unknown glyphs
+    static const uint32_t UNKNOWN = 0xFFFD;
+
+private:
+
+    //! @brief    Size of the glyph hash table (power of two)
+    static const unsigned GLYPH_SLOTS = 2048;
+
+    //! @brief    Maximum number of user defined glyphs
+    static const unsigned MAX_USER_GLYPHS = 512;
+
+    //! @brief    Decoded characters, colors, and screen codes
+    uint32_t text[ROWS * COLUMNS];
+    uint8_t color[ROWS * COLUMNS];
+    uint8_t screenCode[ROWS * COLUMNS];
+
+    //! @brief    Indicates which characters are displayed in reverse
+    bool reversed[ROWS * COLUMNS];
+
+    //! @brief    Background color of the decoded screen
+    uint8_t background;
+
+    //! @brief    Indicates that VIC has been in a text mode when the screen was decoded
+    bool textMode;
+
+    //! @brief    Number of glyphs that could not be decoded
+    unsigned unknownGlyphs;
+
+    //! @brief    Glyph hash table (a key of 0 marks an empty slot)
+    uint64_t glyphKey[GLYPH_SLOTS];
+    uint32_t glyphChar[GLYPH_SLOTS];
+
+    //! @brief    User defined glyphs (inserted before the ROM glyphs)
+    uint64_t userKey[MAX_USER_GLYPHS];
+    uint32_t userChar[MAX_USER_GLYPHS];
+    unsigned userGlyphs;
+
+    //! @brief    Fingerprint of the character ROM the hash table has been built from
+    uint64_t romFingerprint;
+
+    //! @brief    Watched text (UTF-32, zero terminated) or empty if nothing is watched
+    uint32_t watched[COLUMNS + 1];
+
+    //! @brief    Indicates that the watched text has shown up
+    bool found;
+
+    //! @brief    Asks the execution thread to stop (cleared when read)
+    bool stopRequest;
+
+public:
+
+    //! @brief    Constructor
+    ScreenText();
+
+    //! @brief    Method from VirtualComponent
+    void reset();
+
+    //! @brief    Method from VirtualComponent
+    void dumpState();
+
+
+    //
+    //! @functiongroup Decoding the screen
+    //
+
+    /*! @brief    Decodes the current screen
+     *  @return   false if VIC is in a bitmap mode (the screen is decoded as empty)
+     */
+    bool update();
+
+    //! @brief    Returns true if VIC has been in a text mode during the last update
+    bool isTextMode() { return textMode; }
+
+    //! @brief    Returns the Unicode character at the specified position
+    uint32_t getChar(unsigned row, unsigned column) {
+        assert(row < ROWS && column < COLUMNS); return text[row * COLUMNS + column]; }
+
+    //! @brief    Returns the character color (0 - 15) at the specified position
+    uint8_t getColor(unsigned row, unsigned column) {
+        assert(row < ROWS && column < COLUMNS); return color[row * COLUMNS + column]; }
+
+    //! @brief    Returns the screen code at the specified position
+    uint8_t getScreenCode(unsigned row, unsigned column) {
+        assert(row < ROWS && column < COLUMNS); return screenCode[row * COLUMNS + column]; }
+
+    //! @brief    Returns true if the character at the specified position is displayed in reverse
+    bool isReversed(unsigned row, unsigned column) {
+        assert(row < ROWS && column < COLUMNS); return reversed[row * COLUMNS + column]; }
+
+    //! @brief    Returns the background color (0 - 15)
+    uint8_t getBackgroundColor() { return background; }
+
+    //! @brief    Returns the number of glyphs that could not be decoded in the last update
+    unsigned getUnknownGlyphs() { return unknownGlyphs; }
+
+    /*! @brief    Writes a row as UTF-8 string without trailing spaces
+     *  @return   Length of the string (the buffer holds at most size - 1 bytes plus terminator)
+     */
+    size_t getRow(unsigned row, char *buffer, size_t size);
+
+    //! @brief    Writes all rows as UTF-8 string, separated by newlines
+    size_t getText(char *buffer, size_t size);
+
+    /*! @brief    Searches the decoded screen for a UTF-8 string
+     *  @details  The string must fit into a single row.
+     *  @return   true if found. row and column receive the position of the first match.
+     */
+    bool find(const char *text, unsigned *row = NULL, unsigned *column = NULL);
+
+
+    //
+    //! @functiongroup Managing glyphs
+    //
+
+    /*! @brief    Assigns a Unicode character to a glyph of a custom character set
+     *  @param    bitmap    Eight bytes as stored in character memory
+     */
+    void defineGlyph(const uint8_t *bitmap, uint32_t unicode);
+
+    //! @brief    Removes all user defined glyphs
+    void deleteGlyphs();
+
+
+    //
+    //! @functiongroup Watching the screen
+    //
+
+    //! @brief    Starts watching the screen for a UTF-8 string (NULL stops watching)
+    void watch(const char *text);
+
+    //! @brief    Returns true if a text is watched
+    bool isWatching() { return watched[0] != 0; }
+
+    //! @brief    Returns true if the watched text has shown up
+    bool textFound() { return found; }
+
+    //! @brief    Decodes the screen and checks for the watched text (called at the end of a frame)
+    void checkWatch();
+
+    //! @brief    Returns true once if the execution thread should stop
+    bool stopRequested() { bool result = stopRequest; stopRequest = false; return result; }
+
+private:
+
+    //! @brief    Rebuilds the glyph hash table if the character ROM has changed
+    void updateGlyphTable();
+
+    //! @brief    Inserts a glyph into the hash table (existing entries are kept)
+    void insertGlyph(uint64_t key, uint32_t unicode, bool replace);
+
+    //! @brief    Looks up a glyph (UNKNOWN if not present)
+    uint32_t lookupGlyph(uint64_t key);
+
+    //! @brief    Converts a UTF-8 string into UTF-32
+    static unsigned decodeUtf8(const char *src, uint32_t *dst, unsigned max);
+
+    //! @brief    Appends a Unicode character in UTF-8 encoding
+    static size_t encodeUtf8(uint32_t unicode, char *dst, size_t pos, size_t size);
+};
+
+#endif
@@ -0,0 +1,316 @@
+/*!
+ * @header      ThreadPlacement.cpp
+ * @author      Dirk W. Hoffmann, www.dirkwhoffmann.de
+ * @copyright   2018 Dirk W. Hoffmann
+ */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ThreadPlacement.h"
+#include <sys/resource.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+//
+// Processor topology (discovered once, shared by all instances)
+//
+
+static pthread_once_t topologyOnce = PTHREAD_ONCE_INIT;
+static unsigned topologyCpus;
+static int topologyCore[MAX_CPUS];
+static int topologyPackage[MAX_CPUS];
+
+//! @brief    Reads a single integer from a sysfs file
+static int
+readTopologyValue(unsigned cpu, const char *name)
+{
+    char path[128];
+    int value = -1;
+
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/%s", cpu, name);
+    FILE *file = fopen(path, "r");
+    if (file) {
+        if (fscanf(file, "%d", &value) != 1) value = -1;
+        fclose(file);
+    }
+    return value;
+}
+
+static void
+discoverTopology()
+{
+    long cpus = sysconf(_SC_NPROCESSORS_CONF);
+    topologyCpus = cpus > 0 ? MIN((unsigned)cpus, MAX_CPUS) : 1;
+
+    for (unsigned i = 0; i < topologyCpus; i++) {
+        topologyCore[i] = readTopologyValue(i, "core_id");
+        topologyPackage[i] = readTopologyValue(i, "physical_package_id");
+    }
+}
+
+ThreadPlacement::ThreadPlacement()
+{
+    setDescription("ThreadPlacement");
+
+    cpuSetClear(policy.cpus);
+    policy.realtime = false;
+    policy.priority = 0;
+    policySet = false;
+    pending = false;
+    sampling = false;
+    resetStatistics();
+}
+
+
+//
+// Discovering the topology
+//
+
+unsigned
+ThreadPlacement::numCpus()
+{
+    pthread_once(&topologyOnce, discoverTopology);
+    return topologyCpus;
+}
+
+int
+ThreadPlacement::coreOf(unsigned cpu)
+{
+    return cpu < numCpus() ? topologyCore[cpu] : -1;
+}
+
+int
+ThreadPlacement::packageOf(unsigned cpu)
+{
+    return cpu < numCpus() ? topologyPackage[cpu] : -1;
+}
+
+unsigned
+ThreadPlacement::cpuForThread(const CpuSet &set, unsigned nr, bool siblings)
+{
+    unsigned cpu[MAX_CPUS], key[MAX_CPUS][3];
+    unsigned count = 0;
+
+    // Collect the candidates. Processors with an unknown topology form cores of their own.
+    for (unsigned i = 0; i < numCpus(); i++) {
+        if (cpuSetIsEmpty(set) || cpuSetHas(set, i)) {
+            cpu[count] = i;
+            key[count][0] = packageOf(i) < 0 ? 0 : packageOf(i);
+            key[count][1] = coreOf(i) < 0 ? MAX_CPUS + i : coreOf(i);
+            key[count][2] = i;
+            count++;
+        }
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    // Order by package and core (insertion sort, the lists are short)
+    for (unsigned i = 1; i < count; i++) {
+        for (unsigned j = i; j > 0 && memcmp(key[j - 1], key[j], sizeof(key[j])) > 0; j--) {
+            unsigned tmp[3];
+            memcpy(tmp, key[j], sizeof(tmp));
+            memcpy(key[j], key[j - 1], sizeof(tmp));
+            memcpy(key[j - 1], tmp, sizeof(tmp));
+        }
+    }
+
+    if (!siblings) {
+
+        // Rank each processor by its position inside its core and order by rank
+        for (unsigned i = 0; i < count; i++) {
+            bool sameCore = i > 0 && key[i][0] == key[i - 1][0] && key[i][1] == key[i - 1][1];
+            cpu[i] = key[i][2];
+            key[i][2] = sameCore ? key[i - 1][2] + 1 : 0;
+        }
+        for (unsigned i = 0; i < count; i++) {
+            key[i][0] = key[i][2]; key[i][1] = i; key[i][2] = cpu[i];
+        }
+        for (unsigned i = 1; i < count; i++) {
+            for (unsigned j = i; j > 0 && memcmp(key[j - 1], key[j], 2 * sizeof(unsigned)) > 0; j--) {
+                unsigned tmp[3];
+                memcpy(tmp, key[j], sizeof(tmp));
+                memcpy(key[j], key[j - 1], sizeof(tmp));
+                memcpy(key[j - 1], tmp, sizeof(tmp));
+            }
+        }
+    }
+
+    return key[nr % count][2];
+}
+
+ThreadPolicy
+ThreadPlacement::policyForThread(const ThreadPolicy &group, unsigned nr, bool siblings)
+{
+    ThreadPolicy result = group;
+
+    cpuSetClear(result.cpus);
+    cpuSetAdd(result.cpus, cpuForThread(group.cpus, nr, siblings));
+    return result;
+}
+
+
+//
+// Applying policies
+//
+
+bool
+ThreadPlacement::applyToCurrentThread(const ThreadPolicy &policy)
+{
+    bool success = true;
+    struct sched_param param;
+
+#ifdef __linux__
+
+    // An empty set releases the thread from previous restrictions
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    for (unsigned i = 0; i < numCpus(); i++) {
+        if (cpuSetIsEmpty(policy.cpus) || cpuSetHas(policy.cpus, i)) CPU_SET(i, &mask);
+    }
+    success &= pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) == 0;
+
+    if (policy.realtime) {
+        param.sched_priority = policy.priority;
+        success &= pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+    } else {
+        param.sched_priority = 0;
+        success &= pthread_setschedparam(pthread_self(), SCHED_OTHER, &param) == 0;
+        success &= setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), policy.priority) == 0;
+    }
+
+#elif defined(__APPLE__)
+
+    // Threads sharing an affinity tag are placed on processors sharing a cache
+    thread_affinity_policy_data_t affinity = { THREAD_AFFINITY_TAG_NULL };
+    for (unsigned i = 0; i < MAX_CPUS; i++) {
+        if (cpuSetHas(policy.cpus, i)) { affinity.affinity_tag = i + 1; break; }
+    }
+    success &= thread_policy_set(pthread_mach_thread_np(pthread_self()),
+                                 THREAD_AFFINITY_POLICY, (thread_policy_t)&affinity,
+                                 THREAD_AFFINITY_POLICY_COUNT) == KERN_SUCCESS;
+
+    // Nice values are not supported per thread
+    if (policy.realtime) {
+        param.sched_priority = policy.priority;
+        success &= pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+    } else {
+        success &= policy.priority == 0;
+    }
+
+#else
+
+    success = cpuSetIsEmpty(policy.cpus) && !policy.realtime && policy.priority == 0;
+
+#endif
+
+    return success;
+}
+
+void
+ThreadPlacement::setPolicy(const ThreadPolicy &value)
+{
+    policy = value;
+    policySet = true;
+    pending = true;
+}
+
+void
+ThreadPlacement::apply()
+{
+    pending = false;
+    
+    // Leave the inherited placement alone unless a policy has been requested
+    if (!policySet)
+        return;
+    
+    if (!applyToCurrentThread(policy)) {
+        warn("Thread policy has been rejected by the operating system\n");
+    }
+
+    // The counters of the new placement start from scratch
+    resetStatistics();
+}
+
+
+//
+// Monitoring the placement
+//
+
+void
+ThreadPlacement::sample()
+{
+    pthread_t self = pthread_self();
+    int cpu = -1;
+    long involuntary = 0, voluntary = 0;
+
+#ifdef __linux__
+    struct rusage usage;
+    if (getrusage(RUSAGE_THREAD, &usage) == 0) {
+        involuntary = usage.ru_nivcsw;
+        voluntary = usage.ru_nvcsw;
+    }
+    cpu = sched_getcpu();
+#endif
+
+    // A different thread starts a new baseline
+    if (stats.samples && pthread_equal(self, sampler)) {
+        stats.involuntarySwitches += involuntary - lastInvoluntary;
+        stats.voluntarySwitches += voluntary - lastVoluntary;
+        if (cpu != stats.cpu) stats.migrations++;
+    }
+    if (cpu >= 0 && !cpuSetIsEmpty(policy.cpus) && !cpuSetHas(policy.cpus, cpu)) {
+        stats.misplacedSamples++;
+    }
+
+    sampler = self;
+    lastInvoluntary = involuntary;
+    lastVoluntary = voluntary;
+    stats.cpu = cpu;
+    stats.samples++;
+}
+
+void
+ThreadPlacement::resetStatistics()
+{
+    memset(&stats, 0, sizeof(stats));
+    stats.cpu = -1;
+    lastInvoluntary = lastVoluntary = 0;
+}
+
+void
+ThreadPlacement::dumpState()
+{
+    msg("ThreadPlacement:\n");
+    msg("----------------\n\n");
+    msg("      Processors : ");
+    if (cpuSetIsEmpty(policy.cpus)) {
+        msg("any");
+    } else {
+        for (unsigned i = 0; i < MAX_CPUS; i++)
+            if (cpuSetHas(policy.cpus, i)) msg("%d ", i);
+    }
+    msg("\n");
+    msg("      Scheduling : %s, priority %d\n", policy.realtime ? "real-time" : "normal", policy.priority);
+    msg("         Samples : %llu\n", stats.samples);
+    msg("      Migrations : %llu\n", stats.migrations);
+    msg("       Misplaced : %llu\n", stats.misplacedSamples);
+    msg("Involuntary csw. : %llu\n", stats.involuntarySwitches);
+    msg("  Voluntary csw. : %llu\n", stats.voluntarySwitches);
+    msg("  Last processor : %d\n", stats.cpu);
+    msg("\n");
+}
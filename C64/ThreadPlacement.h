@@ -0,0 +1,228 @@
+/*!
+ * @header      ThreadPlacement.h
+ * @author      Dirk W. Hoffmann, www.dirkwhoffmann.de
+ * @copyright   2018 Dirk W. Hoffmann
+ */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _THREADPLACEMENT_INC
+#define _THREADPLACEMENT_INC
+
+#include "VC64Object.h"
+
+//! @brief    Maximum number of logical processors that can be addressed
+#define MAX_CPUS 256
+
+//! @brief    Set of logical processors (bit n = processor n)
+typedef struct {
+    uint64_t bits[MAX_CPUS / 64];
+} CpuSet;
+
+//! @brief    Removes all processors from a set
+inline void cpuSetClear(CpuSet &set) { memset(&set, 0, sizeof(set)); }
+
+//! @brief    Adds a processor to a set
+inline void cpuSetAdd(CpuSet &set, unsigned cpu) {
+    if (cpu < MAX_CPUS) set.bits[cpu / 64] |= (uint64_t)1 << (cpu % 64); }
+
+//! @brief    Returns true if a processor belongs to a set
+inline bool cpuSetHas(const CpuSet &set, unsigned cpu) {
+    return cpu < MAX_CPUS && (set.bits[cpu / 64] & ((uint64_t)1 << (cpu % 64))); }
+
+//! @brief    Returns true if a set contains no processor
+inline bool cpuSetIsEmpty(const CpuSet &set) {
+    for (unsigned i = 0; i < MAX_CPUS / 64; i++) if (set.bits[i]) return false;
+    return true;
+}
+
+//! @brief    Placement policy of a thread
+typedef struct {
+
+    //! @brief    Processors the thread may run on (empty = no restriction)
+    CpuSet cpus;
+
+    //! @brief    Requests a real-time scheduling class (SCHED_FIFO)
+    bool realtime;
+
+    /*! @brief    Priority of the thread
+     *  @details  Real-time threads: 1 (lowest) ... 99 (highest).
+     *            Other threads: nice value, -20 (highest) ... 19 (lowest), 0 = default.
+     */
+    int priority;
+
+} ThreadPolicy;
+
+//! @brief    Scheduling statistics of the thread(s) emulating a single machine
+typedef struct {
+
+    //! @brief    Number of samples taken (one per emulated frame)
+    uint64_t samples;
+
+    /*! @brief    Number of processor changes between two samples
+     *  @details  This is a lower bound. Multiple migrations between two samples count once.
+     */
+    uint64_t migrations;
+
+    //! @brief    Number of samples taken on a processor outside of the policy's set
+    uint64_t misplacedSamples;
+
+    //! @brief    Context switches caused by the scheduler (time slice expired, preemption)
+    uint64_t involuntarySwitches;
+
+    //! @brief    Context switches caused by the thread itself (sleeping, waiting for locks)
+    uint64_t voluntarySwitches;
+
+    //! @brief    Processor of the most recent sample (-1 = unknown)
+    int cpu;
+
+} ThreadStatistics;
+
+/*! @class    ThreadPlacement
+ *  @brief    Places threads on the processors of the host and monitors their placement
+ *  @details  The static functions discover the processor topology and apply placement
+ *            policies to the calling thread. A policy is always applied by the thread it
+ *            refers to, because some settings (e.g., the nice value on Linux) can only be
+ *            changed that way. Each C64 owns an instance that stores the policy of its
+ *            execution thread and the scheduling statistics of the threads emulating it.
+ *            Processor sets are supported on Linux only. On macOS, they are passed to the
+ *            scheduler as an affinity hint (threads with the same first processor share an
+ *            affinity tag and are placed on processors sharing a cache).
+ */
+class ThreadPlacement : public VC64Object {
+
+private:
+
+    //! @brief    Policy of the execution thread
+    ThreadPolicy policy;
+
+    /*! @brief    Indicates that a policy has been set
+     *  @details  As long as no policy has been set, the execution thread keeps the placement it
+     *            has inherited (e.g., from taskset, a cpuset, or nice).
+     */
+    bool policySet;
+
+    //! @brief    Indicates that the policy has changed and has to be applied again
+    bool pending;
+
+    //! @brief    Indicates that scheduling statistics are collected
+    bool sampling;
+
+    //! @brief    Scheduling statistics
+    ThreadStatistics stats;
+
+    //! @brief    Thread that has taken the most recent sample
+    pthread_t sampler;
+
+    //! @brief    Context switch counters of the sampling thread at the most recent sample
+    long lastInvoluntary;
+    long lastVoluntary;
+
+public:
+
+    //! @brief    Constructor
+    ThreadPlacement();
+
+
+    //
+    //! @functiongroup Discovering the topology
+    //
+
+    //! @brief    Returns the number of logical processors (limited to MAX_CPUS)
+    static unsigned numCpus();
+
+    //! @brief    Returns the physical core of a logical processor (-1 = unknown)
+    static int coreOf(unsigned cpu);
+
+    //! @brief    Returns the package (socket) of a logical processor (-1 = unknown)
+    static int packageOf(unsigned cpu);
+
+    /*! @brief    Distributes co-operating threads among processors
+     *  @details  The processors of the specified set are ordered by package and core, so that
+     *            consecutive threads stay on the same socket. If siblings is true, the SMT
+     *            siblings of a core are filled before the next core is used. Otherwise, each
+     *            core gets a thread before a second thread is placed on the same core.
+     *  @param    set       Processors to choose from (empty = all processors)
+     *  @param    nr        Number of the thread
+     *  @param    siblings  Prefer SMT siblings
+     *  @return   Processor of the thread
+     */
+    static unsigned cpuForThread(const CpuSet &set, unsigned nr, bool siblings);
+
+    /*! @brief    Derives the policy of a co-operating thread from a group policy
+     *  @details  The thread is pinned to the processor chosen by cpuForThread().
+     */
+    static ThreadPolicy policyForThread(const ThreadPolicy &group, unsigned nr, bool siblings);
+
+
+    //
+    //! @functiongroup Applying policies
+    //
+
+    /*! @brief    Applies a policy to the calling thread
+     *  @return   false, if a setting has been rejected by the operating system
+     *            (e.g., a real-time class without the required privileges)
+     */
+    static bool applyToCurrentThread(const ThreadPolicy &policy);
+
+    //! @brief    Returns true if a policy has been set
+    bool hasPolicy() { return policySet; }
+
+    //! @brief    Returns the policy of the execution thread
+    ThreadPolicy getPolicy() { return policy; }
+
+    /*! @brief    Sets the policy of the execution thread
+     *  @details  The policy is applied by the execution thread when it starts or, if it is
+     *            already running, at the beginning of the next frame.
+     */
+    void setPolicy(const ThreadPolicy &value);
+
+    //! @brief    Applies the policy if it has changed (called by the execution thread)
+    void applyIfPending() { if (pending) apply(); }
+
+    /*! @brief    Applies the policy to the calling thread
+     *  @details  Does nothing if no policy has been set.
+     */
+    void apply();
+
+
+    //
+    //! @functiongroup Monitoring the placement
+    //
+
+    //! @brief    Returns true if scheduling statistics are collected
+    bool isSampling() { return sampling; }
+
+    //! @brief    Enables or disables the collection of scheduling statistics
+    void setSampling(bool value) { sampling = value; }
+
+    /*! @brief    Samples the processor and the context switch counters of the calling thread
+     *  @details  Invoked once per frame by the thread emulating the machine if sampling is
+     *            enabled. If the machine is emulated by a different thread than before (e.g.,
+     *            in a worker pool), the counters of the new thread are taken as a new baseline.
+     */
+    void sample();
+
+    //! @brief    Returns the scheduling statistics
+    ThreadStatistics getStatistics() { return stats; }
+
+    //! @brief    Resets the scheduling statistics
+    void resetStatistics();
+
+    //! @brief    Prints the policy and the scheduling statistics
+    void dumpState();
+};
+
+#endif
@@ -25,7 +25,6 @@ VC1541::VC1541()
 	
 	// Configure CPU
 	cpu.setDescription("1541CPU");
-    cpu.chipModel = MOS_6502;
     
     // Register sub components
     VirtualComponent *subcomponents[] = { &mem, &cpu, &via1, &via2, &disk, NULL };
@@ -76,6 +75,10 @@ VC1541::reset()
     
     cpu.setPC(0xEAA0);
     halftrack = 41;
+    
+    pendingCycles = 0;
+    nextHeadEvent = 1;
+    predictable = false;
 }
 
 void
@@ -84,9 +87,11 @@ VC1541::resetDisk()
     debug (3, "Resetting disk in VC1541...\n");
     
     // Disk properties
+    rescheduleHead();
     disk.clearDisk();
     diskInserted = false;
     diskPartiallyInserted = false;
+    rescheduleHead();
 }
 
 void
@@ -114,10 +119,35 @@ VC1541::dumpState()
 	msg("   Head position : Track %d, Bit offset %d\n", halftrack, bitoffset);
 	msg("            SYNC : %d\n", sync);
     msg("       Read mode : %s\n", readMode() ? "YES" : "NO");
+    unsigned distance;
+    const SectorHeader *header = disk.nextSectorHeader(halftrack, bitoffset, &distance);
+    if (header)
+        msg("     Next header : Track %d, Sector %d (%d bits ahead)\n",
+            header->track, header->sector, distance);
+    msg("  Skipped cycles : %d (next byte ready event in cycle %d)\n",
+        pendingCycles, nextHeadEvent);
 	msg("\n");
     mem.dumpState();
 }
 
+void
+VC1541::loadFromBuffer(uint8_t **buffer)
+{
+    VirtualComponent::loadFromBuffer(buffer);
+    
+    // Snapshots never contain pending cycles
+    pendingCycles = 0;
+    nextHeadEvent = 1;
+    predictable = false;
+}
+
+void
+VC1541::saveToBuffer(uint8_t **buffer)
+{
+    updateHead();
+    VirtualComponent::saveToBuffer(buffer);
+}
+
 void
 VC1541::powerUp() {
 
@@ -137,16 +167,164 @@ VC1541::executeOneCycle() {
     if (!rotating)
         return result;
     
+    // Skip the drive head until the next byte ready event can happen
+    if (++pendingCycles < nextHeadEvent)
+        return result;
+    
+    advanceHead(pendingCycles - 1);
+    executeHeadCycle();
+    pendingCycles = 0;
+    nextHeadEvent = cyclesUntilByteReady();
+    
+    return result;
+}
+
+void
+VC1541::updateHead()
+{
+    advanceHead(pendingCycles);
+    nextHeadEvent = nextHeadEvent > pendingCycles ? nextHeadEvent - pendingCycles : 1;
+    pendingCycles = 0;
+}
+
+void
+VC1541::rescheduleHead()
+{
+    updateHead();
+    nextHeadEvent = 1;
+    predictable = false;
+}
+
+void
+VC1541::executeHeadCycle()
+{
     // Wait until next bit is ready
     if (bitReadyTimer > 0) {
         bitReadyTimer -= 16;
-        return result;
+        return;
     }
     
     // Bit is ready
     executeBitReady();
+}
+
+bool
+VC1541::headIsPredictable()
+{
+    unsigned length = disk.length.halftrack[halftrack];
     
-    return result;
+    if (!readMode() || bitReadyTimer <= -16 || byteReadyCounter > 7 ||
+        length < 16 || bitoffset >= length)
+        return false;
+    
+    // The shift register must contain the most recently read bits of the current halftrack
+    uint16_t recent = disk.readBitsFromHalftrack(halftrack, bitoffset + length - 10, 10);
+    return (read_shiftreg & 0x3FF) == recent && sync == (recent == 0x3FF);
+}
+
+unsigned
+VC1541::cyclesForBits(unsigned bits)
+{
+    if (bits == 0)
+        return 0;
+    
+    // Each cycle either decrements the timer or reads a bit. Reading a bit restarts the timer.
+    int timer = bitReadyTimer + (int)(bits - 1) * cyclesPerBit[zone];
+    return bits + (timer > 0 ? (timer + 15) / 16 : 0);
+}
+
+unsigned
+VC1541::bitsInCycles(unsigned cycles)
+{
+    int estimate = (16 * (int)cycles - bitReadyTimer + cyclesPerBit[zone]) / (16 + cyclesPerBit[zone]);
+    unsigned bits = estimate > 0 ? estimate : 0;
+    
+    while (bits > 0 && cyclesForBits(bits) > cycles)
+        bits--;
+    while (cyclesForBits(bits + 1) <= cycles)
+        bits++;
+    
+    return bits;
+}
+
+unsigned
+VC1541::cyclesUntilByteReady()
+{
+    if (!predictable && !(predictable = headIsPredictable()))
+        return 1;
+    
+    // Without a byte ready line, the drive head is only processed when it is observed
+    if (!via2.CA2())
+        return cyclesForBits(MAX_HEAD_LOOKAHEAD);
+    
+    unsigned length = disk.length.halftrack[halftrack];
+    unsigned counter = byteReadyCounter;
+    bool inSync = sync;
+    
+    // Walk from SYNC mark to SYNC mark. Bytes are only signaled outside of SYNC marks.
+    for (unsigned bits = 0; bits < MAX_HEAD_LOOKAHEAD; ) {
+        
+        unsigned offset = (bitoffset + bits) % length;
+        
+        if (inSync) {
+            
+            unsigned distance = disk.distanceToSyncEnd(halftrack, offset);
+            if (distance == UINT_MAX)
+                break;
+            
+            // Reading the first bit behind a SYNC mark clears the counter
+            bits += distance + 1;
+            counter = 1;
+            inSync = false;
+            
+        } else {
+            
+            unsigned distance = disk.distanceToSync(halftrack, offset);
+            
+            // The byte is ready when the counter reaches 7
+            if ((7 - counter) % 8 < distance)
+                return cyclesForBits(bits + (7 - counter) % 8 + 1);
+            
+            bits += distance + 1;
+            counter = (counter + distance + 1) % 8;
+            inSync = true;
+        }
+    }
+    
+    return cyclesForBits(MAX_HEAD_LOOKAHEAD);
+}
+
+void
+VC1541::advanceHead(unsigned cycles)
+{
+    if (cycles <= MIN_HEAD_SKIP) {
+        while (cycles--) executeHeadCycle();
+        return;
+    }
+    
+    assert(headIsPredictable());
+    
+    unsigned bits = bitsInCycles(cycles);
+    bitReadyTimer += (int)bits * cyclesPerBit[zone] - 16 * (int)(cycles - bits);
+    if (bits == 0)
+        return;
+    
+    // Shift in the bits
+    unsigned length = disk.length.halftrack[halftrack];
+    unsigned last = (bitoffset + bits - 1) % length;
+    if (bits >= 16) {
+        read_shiftreg = disk.readBitsFromHalftrack(halftrack, last + length - 15, 16);
+    } else {
+        read_shiftreg = (read_shiftreg << bits) | disk.readBitsFromHalftrack(halftrack, bitoffset, bits);
+    }
+    write_shiftreg = bits < 8 ? write_shiftreg << bits : 0;
+    sync = (read_shiftreg & 0x3FF) == 0x3FF;
+    
+    // The counter is cleared when the SYNC signal drops
+    unsigned distance = disk.distanceFromSyncEnd(halftrack, last);
+    byteReadyCounter = distance < bits ? (distance + 1) % 8 : (byteReadyCounter + bits) % 8;
+    
+    bitoffset = (last + 1) % length;
 }
 
 void
@@ -223,6 +401,10 @@ VC1541::byteReady(uint8_t byte)
 void
 VC1541::byteReady()
 {
+    // The SO pin modifies the processor state behind the back of a parked CPU
+    if (cpu.inIdleLoop())
+        cpu.leaveIdleLoop();
+    
     cpu.setV(1);
 }
 
@@ -232,6 +414,7 @@ VC1541::setZone(uint8_t z)
     assert (z <= 3);
     
     if (z != zone) {
+        rescheduleHead();
         debug(3, "Switching from disk zone %d to disk zone %d\n", zone, z);
         zone = z;
     }
@@ -252,6 +435,7 @@ VC1541::setRedLED(bool b)
 void
 VC1541::setRotating(bool b)
 {
+    rescheduleHead();
     if (!rotating && b) {
         rotating = true;
         c64->putMessage(MSG_VC1541_MOTOR_ON);
@@ -264,6 +448,7 @@ VC1541::setRotating(bool b)
 void
 VC1541::moveHeadUp()
 {
+    rescheduleHead();
     if (halftrack < 84) {
 
         float position = (float)bitoffset / (float)disk.length.halftrack[halftrack];
@@ -287,6 +472,7 @@ VC1541::moveHeadUp()
 void
 VC1541::moveHeadDown()
 {
+    rescheduleHead();
     if (halftrack > 1) {
         float position = (float)bitoffset / (float)disk.length.halftrack[halftrack];
         halftrack--;
@@ -313,6 +499,8 @@ VC1541::insertDisk(Archive *a)
 
     D64Archive *converted;
     
+    rescheduleHead();
+    
     switch (a->type()) {
             
         case D64_CONTAINER:
@@ -342,6 +530,7 @@ VC1541::insertDisk(Archive *a)
     }
     
     diskInserted = true;
+    rescheduleHead();
     c64->putMessage(MSG_VC1541_DISK);
     if (sendSoundMessages)
         c64->putMessage(MSG_VC1541_DISK_SOUND);
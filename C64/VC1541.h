@@ -42,7 +42,7 @@ public:
 	IEC *iec;
 
 	//! @brief    CPU of the virtual drive (6502)
-	CPU cpu;
+	VC1541CPU cpu;
 	
 	//! @brief    Memory of the virtual drive
 	VC1541Memory mem;
@@ -76,6 +76,11 @@ public:
     //! @brief    Dump current state into logfile
     void dumpState();
 
+    //! @brief    Restores the drive from a snapshot
+    void loadFromBuffer(uint8_t **buffer);
+
+    //! @brief    Saves the drive to a snapshot
+    void saveToBuffer(uint8_t **buffer);
     
 private:
     
@@ -192,8 +197,24 @@ public:
      */
     bool executeOneCycle();
 
+    /*! @brief    Applies all pending cycles to the drive head
+     *  @details  Has to be called before the state of the drive head is observed.
+     */
+    void updateHead();
+    
+    /*! @brief    Applies all pending cycles and discards the scheduled byte ready event
+     *  @details  Has to be called before anything changes that affects the bits passing the
+     *            drive head or the byte ready line.
+     */
+    void rescheduleHead();
+    
 private:
     
+    /*! @brief    Helper method for executeOneCycle
+     *  @details  Method is executed in every cycle the drive head is not skipped
+     */
+    void executeHeadCycle();
+    
     /*! @brief    Helper method for executeOneCycle
      *  @details  Method is executed whenever a single bit is ready
      */
@@ -321,7 +342,52 @@ private:
      *            is reset.
      */
     bool sync;
-            
+    
+    //! @brief    Number of bits the drive head is skipped ahead at most
+    static const unsigned MAX_HEAD_LOOKAHEAD = 2048;
+    
+    //! @brief    Number of cycles up to which skipping the drive head is slower than stepping it
+    static const unsigned MIN_HEAD_SKIP = 16;
+    
+    /*! @brief    Number of cycles that have not been applied to the drive head yet
+     *  @details  In read mode, most bits pass the drive head without any observable effect. They are
+     *            not processed one by one. Instead, the drive head is moved ahead in a single step
+     *            when the next byte ready event is due or when the head is observed from the outside.
+     *            This is done analytically with the help of the disk's SYNC index.
+     */
+    unsigned pendingCycles;
+    
+    /*! @brief    Pending cycle in which the drive head needs to be processed again
+     *  @details  The next byte ready event does not happen before this cycle.
+     */
+    unsigned nextHeadEvent;
+    
+    /*! @brief    Indicates that the state of the drive head follows from the bits on disk
+     *  @details  Once true, the flag remains valid until rescheduleHead() is called.
+     */
+    bool predictable;
+    
+    //! @brief    Returns true if the state of the drive head follows from the bits on disk
+    bool headIsPredictable();
+    
+    //! @brief    Returns the number of cycles until the specified number of bits has been read
+    unsigned cyclesForBits(unsigned bits);
+    
+    //! @brief    Returns the number of bits that are read in the specified number of cycles
+    unsigned bitsInCycles(unsigned cycles);
+    
+    /*! @brief    Computes the pending cycle of the next byte ready event
+     *  @details  A smaller value is returned if the event is further away than MAX_HEAD_LOOKAHEAD
+     *            bits. 1 is returned if the head state can't be predicted (e.g., in write mode).
+     */
+    unsigned cyclesUntilByteReady();
+    
+    /*! @brief    Moves the drive head ahead by the specified number of cycles
+     *  @details  Has the same effect as executing executeHeadCycle() for each cycle. No byte
+     *            ready event must be due inside the skipped range.
+     */
+    void advanceHead(unsigned cycles);
+    
 public:
 
     //! @brief    Returns true iff drive is currently in read mode
@@ -335,6 +401,7 @@ public:
 
     //! @brief    Sets the current halftrack position of the drive head
     void setHalftrack(Halftrack ht) {
+        rescheduleHead();
         if (isHalftrackNumber(ht)) halftrack = ht;
     }
 
@@ -346,6 +413,7 @@ public:
 
     //! @brief    Sets bit position of the read/write head inside the current track
     void setBitOffset(uint16_t offset) {
+        rescheduleHead();
         if (hasDisk() && disk.isValidDiskPositon(halftrack, offset)) bitoffset = offset;
     }
 
@@ -356,7 +424,7 @@ public:
     void moveHeadDown();
 
     //! @brief    Returns the current value of the sync signal
-    bool getSync() { return sync; }
+    bool getSync() { updateHead(); return sync; }
 
     //! @brief    Returns the current track zone (0 to 3)
     bool getZone() { return zone; }
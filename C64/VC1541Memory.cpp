@@ -33,6 +33,7 @@ VC1541Memory::VC1541Memory()
     registerSnapshotItems(items, sizeof(items));
 
 	romFile = NULL;
+    traced = false;
 }
 
 VC1541Memory::~VC1541Memory()
@@ -97,29 +98,17 @@ VC1541Memory::readIO(uint16_t addr)
 }
 
 uint8_t 
-VC1541Memory::peek(uint16_t addr)
-{
-    if (addr >= 0x8000) {
-        
-        // 0xC000 - 0xFFFF : ROM
-        // 0x8000 - 0xBFFF : ROM (repeated)
-        return mem[addr | 0xC000];
-        
-    } else {
-        
-        // Map to range 0x0000 - 0x1FFF
-        addr &= 0x1FFF;
-        
-        // 0x0000 - 0x07FF : RAM
-        // 0x0800 - 0x17FF : unmapped
-        // 0x1800 - 0x1BFF : VIA 1 (repeats every 16 bytes)
-        // 0x1C00 - 0x1FFF : VIA 2 (repeats every 16 bytes)
-        return
-        (addr < 0x0800) ? mem[addr] :
-        (addr < 0x1800) ? addr >> 8 :
-        (addr < 0x1C00) ? floppy->via1.peek(addr & 0xF) :
-        floppy->via2.peek(addr & 0xF);
-    }
+VC1541Memory::peekIO(uint16_t addr)
+{
+    assert(addr >= 0x0800 && addr <= 0x1FFF);
+    
+    // 0x0800 - 0x17FF : unmapped
+    // 0x1800 - 0x1BFF : VIA 1 (repeats every 16 bytes)
+    // 0x1C00 - 0x1FFF : VIA 2 (repeats every 16 bytes)
+    return
+    (addr < 0x1800) ? addr >> 8 :
+    (addr < 0x1C00) ? floppy->via1.peek(addr & 0xF) :
+    floppy->via2.peek(addr & 0xF);
 }
      
 uint8_t
@@ -152,7 +141,7 @@ VC1541Memory::pokeRom(uint16_t addr, uint8_t value)
 }
 
 void 
-VC1541Memory::poke(uint16_t addr, uint8_t value)
+VC1541Memory::pokeIO(uint16_t addr, uint8_t value)
 {
     if (addr >= 0x8000) { // ROM
         return;
@@ -161,11 +150,6 @@ VC1541Memory::poke(uint16_t addr, uint8_t value)
     // Map to range 0x0000 - 0x1FFF
     addr &= 0x1FFF;
     
-    if (addr < 0x0800) { // RAM
-        mem[addr] = value;
-        return;
-    }
-    
     if (addr >= 0x1C00) { // VIA 2
         floppy->via2.poke(addr & 0xF, value);
         return;
@@ -177,3 +161,50 @@ VC1541Memory::poke(uint16_t addr, uint8_t value)
     }
 }
 
+
+//
+//! @functiongroup Recording memory accesses
+//
+
+uint8_t
+VC1541Memory::peekTraced(uint16_t addr)
+{
+    if (heatmap.isInstrumented(addr)) {
+        if (floppy->cpu.atBeginningOfNewCommand())
+            heatmap.recordExecution(addr, c64->getCycles());
+        else
+            heatmap.recordRead(addr, c64->getCycles());
+    }
+    
+    if (addr >= 0x8000) return mem[addr | 0xC000];
+    if ((addr & 0x1FFF) < 0x0800) return mem[addr & 0x07FF];
+    return peekIO(addr & 0x1FFF);
+}
+
+void
+VC1541Memory::pokeTraced(uint16_t addr, uint8_t value)
+{
+    if (heatmap.isInstrumented(addr))
+        heatmap.recordWrite(addr, c64->getCycles());
+    
+    if (addr < 0x8000 && (addr & 0x1FFF) < 0x0800) mem[addr & 0x07FF] = value;
+    else pokeIO(addr, value);
+}
+
+void
+VC1541Memory::enableHeatmap(uint16_t banks)
+{
+    c64->suspend();
+    heatmap.enable(banks);
+    traced = heatmap.isEnabled();
+    c64->resume();
+}
+
+void
+VC1541Memory::disableHeatmap()
+{
+    c64->suspend();
+    traced = false;
+    heatmap.disable();
+    c64->resume();
+}
@@ -22,12 +22,13 @@
 #define _VC1541MEMORY_INC
 
 #include "Memory.h"
+#include "Heatmap.h"
 
 class VC1541;
 
 /*! @brief    This class represents the RAM and ROM of a virtual VC1541 floopy disk drive.
  */
-class VC1541Memory : public Memory {
+class VC1541Memory final : public Memory {
 
 public:
     
@@ -82,13 +83,74 @@ public:
     uint8_t readRom(uint16_t addr) { return mem[addr]; }
 	uint8_t peekIO(uint16_t addr);
     uint8_t readIO(uint16_t addr);
-	uint8_t peek(uint16_t addr);
     uint8_t spy(uint16_t addr);
 
+    /*! @brief    Peeks a byte from memory.
+     *  @details  ROM and RAM accesses are served inline. Accesses to the I/O space
+     *            are delegated to peekIO().
+     */
+	uint8_t peek(uint16_t addr) {
+        if (traced) return peekTraced(addr);
+        if (addr >= 0x8000) return mem[addr | 0xC000];
+        if ((addr & 0x1FFF) < 0x0800) return mem[addr & 0x07FF];
+        return peekIO(addr & 0x1FFF);
+    }
+
+    //! @brief    Returns true if the specified memory cell is RAM or ROM
+    bool isStatic(uint16_t addr) {
+        if (traced && heatmap.isInstrumented(addr)) return false;
+        return addr >= 0x8000 || (addr & 0x1FFF) < 0x0800; }
+    
+    //! @brief    Returns true if the specified memory cell is a pollable I/O register
+    bool isPollable(uint16_t) { return false; }
+    
+    //! @brief    Returns true if a CPU write to the specified address goes to RAM
+    bool isRamTarget(uint16_t addr) {
+        if (traced && heatmap.isInstrumented(addr)) return false;
+        return addr < 0x8000 && (addr & 0x1FFF) < 0x0800; }
+    
 	void pokeRam(uint16_t addr, uint8_t value);                  
 	void pokeRom(uint16_t addr, uint8_t value);             
-	// void pokeIO(uint16_t addr, uint8_t value);
-	void poke(uint16_t addr, uint8_t value);
+	void pokeIO(uint16_t addr, uint8_t value);
+    
+    /*! @brief    Pokes a byte into memory.
+     *  @details  RAM accesses are served inline. All other accesses are delegated to pokeIO().
+     */
+	void poke(uint16_t addr, uint8_t value) {
+        if (traced) { pokeTraced(addr, value); return; }
+        if (addr < 0x8000 && (addr & 0x1FFF) < 0x0800) mem[addr & 0x07FF] = value;
+        else pokeIO(addr, value);
+    }
+
+
+    //
+    //! @functiongroup Recording memory accesses
+    //
+
+    //! @brief    Access statistics of the drive CPU
+    Heatmap heatmap;
+
+private:
+
+    /*! @brief    Indicates that the heatmap is enabled
+     *  @details  The drive has no lookup tables. Hence, a disabled heatmap costs a single
+     *            branch in peek() and poke().
+     */
+    bool traced;
+
+    //! @brief    Records the access if the bank is instrumented and peeks the byte
+    uint8_t peekTraced(uint16_t addr);
+
+    //! @brief    Records the access if the bank is instrumented and pokes the byte
+    void pokeTraced(uint16_t addr, uint8_t value);
+
+public:
+
+    //! @brief    Starts recording CPU accesses in the specified banks (bit n = bank n)
+    void enableHeatmap(uint16_t banks);
+
+    //! @brief    Stops recording CPU accesses and frees the heatmap
+    void disableHeatmap();
 };
 
 #endif
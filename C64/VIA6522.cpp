@@ -865,6 +865,16 @@ VIA2::portAexternal()
     return ira;
 }
 
+void
+VIA2::poke(uint16_t addr, uint8_t value)
+{
+    // The PCR selects the read/write mode and enables the byte ready line (CA2)
+    if (addr == 0xC)
+        c64->floppy.rescheduleHead();
+    
+    VIA6522::poke(addr, value);
+}
+
 uint8_t
 VIA2::portBexternal()
 {
@@ -430,6 +430,7 @@ public:
     uint8_t portAexternal();
     uint8_t portBexternal();
     void updatePB();
+    void poke(uint16_t addr, uint8_t value);
 };
 
 #endif
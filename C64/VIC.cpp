@@ -33,6 +33,11 @@ VIC::VIC()
 	markIRQLines = false;
 	markDMALines = false;
     
+    // Statistics
+    BAchargedUntilCycle = 0;
+    badLineCycles = 0;
+    spriteDmaCycles = 0;
+    
     // Assign default color scheme
     setColorScheme(VICE);
     
@@ -279,6 +284,33 @@ uint8_t VIC::memAccess(uint16_t addr)
     return dataBus;
 }
 
+uint8_t VIC::memSpyAccess(uint16_t addr)
+{
+    assert((addr & 0xC000) == 0); /* 14 bit address */
+    
+    uint16_t a = bankAddr | addr;
+    
+    if (!c64->getUltimax()) {
+        switch (a >> 12) {
+            case 0x9:
+            case 0x1:
+                return c64->mem.rom[0xC000 + addr];
+            default:
+                return c64->mem.ram[a];
+        }
+    }
+    
+    switch (a >> 12) {
+        case 0xF:
+        case 0xB:
+        case 0x7:
+        case 0x3:
+            return c64->expansionport.read(a | 0xF000);
+        default:
+            return c64->mem.ram[a];
+    }
+}
+
 uint8_t VIC::memIdleAccess()
 {
     return memAccess(0x3FFF);
@@ -810,13 +842,33 @@ VIC::getScreenGeometry()
 void
 VIC::setBAlow(uint8_t value)
 {
-    if (!BAlow && value)
-        BAwentLowAtCycle = c64->getCycles();
+    if (!BAlow && value) {
+        BAwentLowAtCycle = BAchargedUntilCycle = c64->getCycles();
+    } else if (BAlow && !value && c64->getRasterTiming()) {
+        chargeBAlow();
+    }
     
     BAlow = value;
     c64->cpu.setRDY(value == 0);
 }
 
+void
+VIC::chargeBAlow()
+{
+    uint64_t cycle = c64->getCycles();
+    uint8_t rasterlineCycle = c64->getRasterlineCycle();
+    
+    // Skip bogus phases (e.g., after a snapshot has been restored)
+    if (cycle > BAchargedUntilCycle) {
+        if (rasterlineCycle >= 12 && rasterlineCycle <= 55) {
+            badLineCycles += cycle - BAchargedUntilCycle;
+        } else {
+            spriteDmaCycles += cycle - BAchargedUntilCycle;
+        }
+    }
+    BAchargedUntilCycle = cycle;
+}
+
 bool
 VIC::BApulledDownForAtLeastThreeCycles()
 {
@@ -1066,6 +1118,10 @@ VIC::endRasterline()
         pixelEngine.markLine(PixelEngine::WHITE);
     if (markDMALines && badLineCondition)
         pixelEngine.markLine(PixelEngine::RED);
+    
+    // Account BA low cycles in the rasterline they belong to
+    if (BAlow && c64->getRasterTiming())
+        chargeBAlow();
 
     /*
     if (c64->rasterline == 51 && !vblank) {
@@ -1788,6 +1844,7 @@ VIC::cycle55()
 
     // Phi2.3 VC/RC logic
     // Phi2.4 BA logic
+    if (BAlow && c64->getRasterTiming()) chargeBAlow(); // Bad line phase may continue as sprite DMA phase
     if (isPAL()) {
         setBAlow(spriteDmaOnOff & SPR0);
     } else {
@@ -165,6 +165,15 @@ public:
     //! @brief    Remember at which cycle BA line has been pulled down
     uint64_t BAwentLowAtCycle;
     
+    //! @brief    First cycle of the current BA low phase that has not been accounted yet
+    uint64_t BAchargedUntilCycle;
+    
+    //! @brief    Total number of cycles with BA pulled down by bad lines
+    uint64_t badLineCycles;
+    
+    //! @brief    Total number of cycles with BA pulled down by sprite DMA
+    uint64_t spriteDmaCycles;
+    
     //! @brief    Increases the X counter by 8
     inline void countX() { xCounter += 8; }
     
@@ -467,6 +476,18 @@ public:
 	//! @brief    Returns the screen buffer that is currently stable.
     void *screenBuffer() { return pixelEngine.screenBuffer(); }
 
+	//! @brief    Returns the dirty rasterline map of the stable screen buffer.
+    uint64_t *screenBufferDirtyLines() { return pixelEngine.screenBufferDirtyLines(); }
+
+	//! @brief    Returns the frame stamp of the stable screen buffer.
+    uint64_t screenBufferFrame() { return pixelEngine.screenBufferFrame(); }
+
+	//! @brief    Returns the total number of cycles with BA pulled down by bad lines.
+    uint64_t getBadLineCycles() { return badLineCycles; }
+
+	//! @brief    Returns the total number of cycles with BA pulled down by sprite DMA.
+    uint64_t getSpriteDmaCycles() { return spriteDmaCycles; }
+
 	//! @brief    Restores the initial state.
 	void reset();
 		
@@ -566,6 +587,11 @@ public:
      */
 	void setCharacterMemoryAddr(uint16_t addr);
     
+    /*! @brief    Same as memAccess, but without side effects
+     *  @details  Returns the value VIC would see at the specified address in the current bank.
+     */
+    uint8_t memSpyAccess(uint16_t addr);
+    
 private:
     
 	//! @brief    Peek fallthrough
@@ -702,6 +728,13 @@ private:
     
     //! @brief    Set BA line
     void setBAlow(uint8_t value);
+    
+    /*! @brief    Accounts the cycles of the current BA low phase
+     *  @details  Cycles are charged to the bad line counter if the phase ends (or is split) in
+     *            the bad line area (cycles 12 to 55) and to the sprite DMA counter otherwise.
+     *            Only called if raster time is accounted.
+     */
+    void chargeBAlow();
 	
 	/*! @brief    Trigger a VIC interrupt
 	 *  @details  VIC interrupts can be triggered from multiple sources.
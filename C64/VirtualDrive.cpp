@@ -0,0 +1,1026 @@
+/*
+ * (C) 2018 Dirk W. Hoffmann. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "C64.h"
+#include <dirent.h>
+
+// Protocol timing in cycles. The values leave enough headroom for the Kernal
+// routines being delayed by bad lines and sprite DMA.
+static const uint64_t eoiTimeout = 200;     // Listener: Missing clock signal indicating EOI
+static const uint64_t eoiAckTime = 60;      // Listener: Duration of the EOI acknowledge
+static const uint64_t turnaroundTime = 80;  // Talker: Delay after taking over the clock line
+static const uint64_t byteDelay = 40;       // Talker: Delay before a byte is sent
+static const uint64_t bitSetupTime = 80;    // Talker: Clock low phase
+static const uint64_t bitValidTime = 80;    // Talker: Clock high phase
+
+//! @brief    A file as seen by the virtual drive
+typedef struct {
+    uint8_t name[17];   // PETSCII, zero terminated
+    char type[6];       // File type as shown in directory listings
+    unsigned blocks;
+    int item;           // Item number in the D64 archive
+    char *path;         // Path of the host file
+} VirtualDriveFile;
+
+//! @brief    Converts a host file name character to PETSCII
+static uint8_t
+petsciiFromAscii(char c)
+{
+    if (c >= 'a' && c <= 'z') return (uint8_t)(c - 'a' + 0x41);
+    if (c >= 0x20 && c <= 0x5D) return (uint8_t)c;
+    return '?';
+}
+
+//! @brief    Converts a PETSCII file name character to a host file name character
+static char
+asciiFromPetscii(uint8_t c)
+{
+    if (c >= 0x41 && c <= 0x5A) return (char)(c - 0x41 + 'a');
+    if (c >= 0xC1 && c <= 0xDA) return (char)(c - 0xC1 + 'A');
+    if (c == '/' || c == ':' || c < 0x20 || c > 0x5D) return '_';
+    return (char)c;
+}
+
+//! @brief    Matches a PETSCII file name against a pattern with wildcards
+static bool
+matches(const uint8_t *pattern, const uint8_t *name)
+{
+    for (; *pattern; pattern++, name++) {
+        if (*pattern == '*') return true;
+        if (*name == 0) return false;
+        if (*pattern != '?' && *pattern != *name) return false;
+    }
+    return *name == 0;
+}
+
+static int
+compareFiles(const void *a, const void *b)
+{
+    return strcmp((const char *)((VirtualDriveFile *)a)->name,
+                  (const char *)((VirtualDriveFile *)b)->name);
+}
+
+//! @brief    Collects all files of a D64 archive or a host directory
+static unsigned
+scanFiles(D64Archive *disk, const char *directory, VirtualDriveFile *files, unsigned max)
+{
+    unsigned count = 0;
+
+    if (disk) {
+
+        for (int i = 0; i < disk->getNumberOfItems() && count < max; i++) {
+
+            VirtualDriveFile *f = &files[count++];
+            const char *name = disk->getNameOfItem(i);
+            strncpy((char *)f->name, name ? name : "", 16);
+            f->name[16] = 0;
+            strncpy(f->type, disk->getTypeOfItem(i), 5);
+            f->type[5] = 0;
+            f->blocks = (unsigned)disk->getSizeOfItemInBlocks(i);
+            f->item = i;
+            f->path = NULL;
+        }
+    }
+
+    if (directory) {
+
+        DIR *dir = opendir(directory);
+        struct dirent *entry;
+        struct stat st;
+
+        while (dir && (entry = readdir(dir)) != NULL && count < max) {
+
+            if (entry->d_name[0] == '.')
+                continue;
+
+            size_t length = strlen(directory) + strlen(entry->d_name) + 2;
+            char *path = (char *)malloc(length);
+            snprintf(path, length, "%s/%s", directory, entry->d_name);
+            if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+                free(path);
+                continue;
+            }
+
+            // Hide the extension of program and sequential files
+            VirtualDriveFile *f = &files[count++];
+            char *ext = strrchr(entry->d_name, '.');
+            size_t nameLength = strlen(entry->d_name);
+            strcpy(f->type, "PRG");
+            if (ext && strcasecmp(ext, ".prg") == 0) {
+                nameLength = ext - entry->d_name;
+            } else if (ext && strcasecmp(ext, ".seq") == 0) {
+                nameLength = ext - entry->d_name;
+                strcpy(f->type, "SEQ");
+            }
+
+            unsigned i;
+            for (i = 0; i < nameLength && i < 16; i++)
+                f->name[i] = petsciiFromAscii(entry->d_name[i]);
+            f->name[i] = 0;
+            f->blocks = (unsigned)MIN((st.st_size + 253) / 254, 0xFFFF);
+            f->item = -1;
+            f->path = path;
+        }
+        if (dir)
+            closedir(dir);
+
+        qsort(files, count, sizeof(VirtualDriveFile), compareFiles);
+    }
+
+    return count;
+}
+
+static void
+freeFiles(VirtualDriveFile *files, unsigned count)
+{
+    for (unsigned i = 0; i < count; i++)
+        free(files[i].path);
+}
+
+VirtualDrive::VirtualDrive()
+{
+    setDescription("VirtualDrive");
+    debug(3, "  Creating virtual drive at address %p...\n", this);
+
+    // The virtual drive doesn't contribute to snapshots
+    active = false;
+    deviceNr = 8;
+    disk = NULL;
+    directory = NULL;
+    memset(channel, 0, sizeof(channel));
+}
+
+VirtualDrive::~VirtualDrive()
+{
+    debug(3, "  Releasing virtual drive...\n");
+
+    for (uint8_t i = 0; i < 16; i++)
+        closeChannel(i);
+    unmount();
+}
+
+void
+VirtualDrive::reset()
+{
+    VirtualComponent::reset();
+
+    for (uint8_t i = 0; i < 16; i++) {
+        free(channel[i].buffer);
+        free(channel[i].path);
+    }
+    memset(channel, 0, sizeof(channel));
+
+    wakeUpCycle = UINT64_MAX;
+    clockOut = false;
+    dataOut = false;
+    state = VD_IDLE;
+    lastClock = true;
+    byte = 0;
+    bitCount = 0;
+    eoi = false;
+    atnMode = false;
+    listening = false;
+    talking = false;
+    secondary = 0;
+    opening = false;
+    inputLength = 0;
+    setStatus(73, "CBM DOS V2.6 1541");
+}
+
+void
+VirtualDrive::loadFromBuffer(uint8_t **buffer)
+{
+    VirtualComponent::loadFromBuffer(buffer);
+
+    // The protocol state is lost. Start over with all lines released.
+    reset();
+}
+
+void
+VirtualDrive::dumpState()
+{
+    msg("Virtual drive\n");
+    msg("-------------\n");
+    msg("\n");
+    msg("        Active : %s\n", active ? "yes" : "no");
+    msg("        Medium : %s\n", disk ? "D64 archive" : directory ? directory : "none");
+    msg("         State : %d\n", state);
+    msg("   Clock, data : %s %s\n", clockOut ? "pulled" : "released", dataOut ? "pulled" : "released");
+    msg("   ATN, listen, talk : %d %d %d\n", atnMode, listening, talking);
+    msg("     Secondary : %d\n", secondary);
+    msg(" Open channels :");
+    for (unsigned i = 0; i < 16; i++)
+        if (channel[i].open) msg(" %d", i);
+    msg("\n");
+    msg("        Status : %s\n", status);
+    msg("\n");
+}
+
+
+//
+// Configuring the device
+//
+
+void
+VirtualDrive::setActive(bool value)
+{
+    if (value == active)
+        return;
+
+    c64->suspend();
+
+    active = value;
+    reset();
+
+    // Start the real drive from scratch when it returns to the bus
+    if (!active)
+        c64->floppy.reset();
+
+    c64->selectExecutionLoop();
+    c64->iec.updateIecLines();
+    c64->resume();
+}
+
+bool
+VirtualDrive::mountArchive(Archive *archive)
+{
+    D64Archive *copy;
+
+    if (archive == NULL)
+        return false;
+
+    if (archive->type() == D64_CONTAINER) {
+
+        size_t length = archive->writeToBuffer(NULL);
+        uint8_t *buffer = (uint8_t *)malloc(length);
+        if (buffer == NULL)
+            return false;
+        archive->writeToBuffer(buffer);
+        copy = D64Archive::makeD64ArchiveWithBuffer(buffer, length);
+        free(buffer);
+
+    } else {
+
+        copy = D64Archive::makeD64ArchiveWithAnyArchive(archive);
+    }
+
+    if (copy == NULL)
+        return false;
+
+    c64->suspend();
+    unmount();
+    disk = copy;
+    setStatus(0, " OK");
+    c64->resume();
+
+    return true;
+}
+
+bool
+VirtualDrive::mountDirectory(const char *path)
+{
+    struct stat st;
+
+    if (path == NULL || stat(path, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        warn("Cannot mount %s\n", path ? path : "(null)");
+        return false;
+    }
+
+    c64->suspend();
+    unmount();
+    directory = strdup(path);
+    setStatus(0, " OK");
+    c64->resume();
+
+    return true;
+}
+
+void
+VirtualDrive::unmount()
+{
+    delete disk;
+    disk = NULL;
+    free(directory);
+    directory = NULL;
+}
+
+
+//
+// Talking to the IEC bus
+//
+
+void
+VirtualDrive::setLines(bool clock, bool data)
+{
+    if (clock != clockOut || data != dataOut) {
+        clockOut = clock;
+        dataOut = data;
+        c64->iec.updateIecLines();
+    }
+}
+
+void
+VirtualDrive::wakeUpIn(uint64_t cycles)
+{
+    wakeUpCycle = c64->getCycles() + cycles;
+}
+
+void
+VirtualDrive::execute()
+{
+    while (step());
+
+    // Cancel the timer if it hasn't been consumed or rescheduled
+    if (wakeUpCycle <= c64->getCycles())
+        wakeUpCycle = UINT64_MAX;
+}
+
+bool
+VirtualDrive::step()
+{
+    bool atn = c64->iec.getAtnLine();
+    bool clock = c64->iec.getClockLine();
+    bool data = c64->iec.getDataLine();
+    bool timeout = c64->getCycles() >= wakeUpCycle;
+
+    // ATN interrupts everything. All devices have to listen.
+    if (!atn && !atnMode) {
+        atnMode = true;
+        wakeUpCycle = UINT64_MAX;
+        setLines(false, true);
+        state = VD_RX_WAIT_CLK_LOW;
+        return true;
+    }
+    if (atn && atnMode) {
+        atnMode = false;
+        wakeUpCycle = UINT64_MAX;
+        releaseAtn();
+        return true;
+    }
+
+    switch (state) {
+
+        case VD_IDLE:
+        case VD_TX_DEAD:
+            return false;
+
+        //
+        // Listener
+        //
+
+        case VD_RX_WAIT_CLK_LOW:
+            if (clock) return false;
+            state = VD_RX_WAIT_READY;
+            return true;
+
+        case VD_RX_WAIT_READY:
+            if (!clock) return false;
+
+            // Talker is ready to send. Signal that we are ready for data.
+            setLines(false, false);
+            eoi = false;
+            wakeUpIn(eoiTimeout);
+            state = VD_RX_WAIT_START;
+            return true;
+
+        case VD_RX_WAIT_START:
+            if (!clock) {
+                wakeUpCycle = UINT64_MAX;
+                byte = 0;
+                bitCount = 0;
+                lastClock = false;
+                state = VD_RX_BITS;
+                return true;
+            }
+            if (!timeout || eoi || atnMode) return false;
+
+            // The talker keeps quiet, i.e., the next byte is the last one
+            eoi = true;
+            setLines(false, true);
+            wakeUpIn(eoiAckTime);
+            state = VD_RX_EOI_ACK;
+            return true;
+
+        case VD_RX_EOI_ACK:
+            if (!timeout) return false;
+            wakeUpCycle = UINT64_MAX;
+            setLines(false, false);
+            state = VD_RX_WAIT_START;
+            return true;
+
+        case VD_RX_BITS:
+            if (clock == lastClock) return false;
+            lastClock = clock;
+
+            // Bits are valid on the rising edge of the clock line (LSB first)
+            if (clock) {
+                byte = (byte >> 1) | (data ? 0x80 : 0x00);
+                bitCount++;
+                return true;
+            }
+            if (bitCount < 8) return true;
+
+            // Acknowledge the frame
+            setLines(false, true);
+            state = VD_RX_WAIT_CLK_LOW;
+            if (atnMode) processCommand(byte); else processData(byte);
+            return true;
+
+        //
+        // Talker
+        //
+
+        case VD_TX_TURNAROUND:
+            if (!clock) return false;
+
+            // Take over the clock line
+            setLines(true, false);
+            wakeUpIn(turnaroundTime);
+            state = VD_TX_READY;
+            return true;
+
+        case VD_TX_READY:
+            if (!timeout) return false;
+            wakeUpCycle = UINT64_MAX;
+
+            // If there is nothing to send, the listener runs into a timeout
+            if (!peekByte(&byte, &eoi)) {
+                setLines(false, false);
+                state = VD_TX_DEAD;
+                return true;
+            }
+
+            // Signal that we are ready to send
+            setLines(false, false);
+            state = VD_TX_WAIT_LISTENER;
+            return true;
+
+        case VD_TX_WAIT_LISTENER:
+            if (!data) return false;
+            if (eoi) {
+                state = VD_TX_EOI_WAIT_LOW;
+                return true;
+            }
+            wakeUpIn(byteDelay);
+            state = VD_TX_START;
+            return true;
+
+        case VD_TX_EOI_WAIT_LOW:
+            if (data) return false;
+            state = VD_TX_EOI_WAIT_HIGH;
+            return true;
+
+        case VD_TX_EOI_WAIT_HIGH:
+            if (!data) return false;
+            wakeUpIn(byteDelay);
+            state = VD_TX_START;
+            return true;
+
+        case VD_TX_START:
+            if (!timeout) return false;
+            bitCount = 0;
+            setLines(true, !(byte & 0x01));
+            wakeUpIn(bitSetupTime);
+            state = VD_TX_BIT_HIGH;
+            return true;
+
+        case VD_TX_BIT_HIGH:
+            if (!timeout) return false;
+            setLines(false, dataOut);
+            wakeUpIn(bitValidTime);
+            state = VD_TX_BIT_LOW;
+            return true;
+
+        case VD_TX_BIT_LOW:
+            if (!timeout) return false;
+            if (++bitCount < 8) {
+                setLines(true, !((byte >> bitCount) & 0x01));
+                wakeUpIn(bitSetupTime);
+                state = VD_TX_BIT_HIGH;
+                return true;
+            }
+            wakeUpCycle = UINT64_MAX;
+            setLines(true, false);
+            state = VD_TX_WAIT_ACK;
+            return true;
+
+        case VD_TX_WAIT_ACK:
+            if (data) return false;
+            consumeByte();
+            wakeUpIn(byteDelay);
+            state = VD_TX_READY;
+            return true;
+    }
+
+    return false;
+}
+
+void
+VirtualDrive::releaseAtn()
+{
+    if (!listening && !talking) {
+        setLines(false, false);
+        state = VD_IDLE;
+        return;
+    }
+
+    if (talking) {
+
+        // The C64 hands over the clock line
+        state = VD_TX_TURNAROUND;
+        return;
+    }
+
+    // Keep holding the data line until the talker is ready to send
+    state = VD_RX_WAIT_CLK_LOW;
+}
+
+void
+VirtualDrive::processCommand(uint8_t command)
+{
+    debug(2, "ATN command %02X\n", command);
+
+    switch (command & 0xF0) {
+
+        case 0x20: // LISTEN
+        case 0x30:
+
+            if (command == 0x3F) {
+                if (listening) unlisten();
+                listening = false;
+            } else if ((command & 0x1F) == deviceNr) {
+                listening = true;
+                talking = false;
+                opening = false;
+                inputLength = 0;
+            } else {
+                if (listening) unlisten();
+                listening = false;
+            }
+            break;
+
+        case 0x40: // TALK
+        case 0x50:
+
+            if (command == 0x5F) {
+                talking = false;
+            } else if ((command & 0x1F) == deviceNr) {
+                if (listening) unlisten();
+                listening = false;
+                talking = true;
+                secondary = 0;
+            } else {
+                talking = false;
+            }
+            break;
+
+        case 0x60: // DATA
+
+            if (!listening && !talking) break;
+            secondary = command & 0x0F;
+            break;
+
+        case 0xE0: // CLOSE
+
+            if (!listening) break;
+            closeChannel(command & 0x0F);
+            break;
+
+        case 0xF0: // OPEN
+
+            if (!listening) break;
+            secondary = command & 0x0F;
+            opening = true;
+            inputLength = 0;
+            break;
+    }
+}
+
+void
+VirtualDrive::processData(uint8_t data)
+{
+    if (!listening)
+        return;
+
+    // File names and drive commands are collected in the input buffer
+    if (opening || secondary == 15) {
+        if (inputLength < sizeof(input))
+            input[inputLength++] = data;
+        return;
+    }
+
+    VirtualDriveChannel *c = &channel[secondary];
+    if (c->open && c->write)
+        (void)appendToChannel(c, data);
+}
+
+void
+VirtualDrive::unlisten()
+{
+    if (opening) {
+        opening = false;
+        openChannel(secondary);
+    } else if (secondary == 15 && inputLength) {
+        executeCommand();
+    }
+    inputLength = 0;
+}
+
+bool
+VirtualDrive::peekByte(uint8_t *value, bool *last)
+{
+    // The error channel can always be read
+    if (secondary == 15) {
+        *value = (uint8_t)status[statusPos];
+        *last = status[statusPos + 1] == 0;
+        return true;
+    }
+
+    VirtualDriveChannel *c = &channel[secondary];
+    if (!c->open || c->write || c->pos >= c->size)
+        return false;
+
+    *value = c->buffer[c->pos];
+    *last = c->pos + 1 == c->size;
+    return true;
+}
+
+void
+VirtualDrive::consumeByte()
+{
+    if (secondary == 15) {
+        if (status[++statusPos] == 0)
+            setStatus(0, " OK");
+        return;
+    }
+
+    channel[secondary].pos++;
+}
+
+
+//
+// Managing channels
+//
+
+void
+VirtualDrive::setStatus(unsigned code, const char *text, unsigned track, unsigned sector)
+{
+    snprintf(status, sizeof(status), "%02u,%s,%02u,%02u\r", code, text, track, sector);
+    statusPos = 0;
+}
+
+bool
+VirtualDrive::appendToChannel(VirtualDriveChannel *c, uint8_t value)
+{
+    if (c->size == c->capacity) {
+
+        size_t capacity = MAX(2 * c->capacity, (size_t)1024);
+        uint8_t *buffer = (uint8_t *)realloc(c->buffer, capacity);
+        if (buffer == NULL) {
+            warn("Out of memory\n");
+            return false;
+        }
+        c->buffer = buffer;
+        c->capacity = capacity;
+    }
+
+    c->buffer[c->size++] = value;
+    return true;
+}
+
+void
+VirtualDrive::openChannel(uint8_t nr)
+{
+    VirtualDriveChannel *c = &channel[nr];
+    uint8_t name[sizeof(input) + 1];
+    unsigned i, length = inputLength;
+    bool replace = false, write = (nr == 1);
+    char type = 'P';
+
+    // The command channel executes the file name
+    if (nr == 15) {
+        executeCommand();
+        return;
+    }
+
+    closeChannel(nr);
+
+    if (!hasMedium()) {
+        setStatus(74, "DRIVE NOT READY");
+        return;
+    }
+
+    // Directory listing
+    memcpy(name, input, length);
+    name[length] = 0;
+    if (name[0] == '$' && !write) {
+        uint8_t *colon = (uint8_t *)strchr((char *)name, ':');
+        readDirectory(c, colon ? (const char *)colon + 1 : "*");
+        c->open = true;
+        setStatus(0, " OK");
+        return;
+    }
+
+    // Strip off "@", "0:" and parse the ",type,mode" suffix
+    uint8_t *start = name;
+    if (*start == '@') { replace = true; start++; }
+    uint8_t *colon = (uint8_t *)strchr((char *)start, ':');
+    uint8_t *comma = (uint8_t *)strchr((char *)start, ',');
+    if (colon && (!comma || colon < comma)) start = colon + 1;
+    if (comma) {
+        *comma = 0;
+        for (uint8_t *opt = comma + 1; *opt; opt++) {
+            if (opt[-1] != ',' && opt[-1] != 0) continue;
+            if (*opt == 'S' || *opt == 'P' || *opt == 'U') type = *opt;
+            if (*opt == 'W' || *opt == 'A') write = true;
+            if (*opt == 'R' && opt - comma > 2) write = false;
+        }
+    }
+    for (i = 0; start[i] && i < 16; i++);
+    start[i] = 0;
+
+    if (!write) {
+        if (!readFile(c, (const char *)start)) {
+            setStatus(62, "FILE NOT FOUND");
+            return;
+        }
+        c->open = true;
+        setStatus(0, " OK");
+        return;
+    }
+
+    // Files can only be written into host directories
+    if (disk) {
+        setStatus(26, "WRITE PROTECT ON");
+        return;
+    }
+    if (strchr((char *)start, '*') || strchr((char *)start, '?') || *start == 0) {
+        setStatus(33, "SYNTAX ERROR");
+        return;
+    }
+    char *path = hostPath((const char *)start, type);
+    struct stat st;
+    if (!replace && stat(path, &st) == 0) {
+        free(path);
+        setStatus(63, "FILE EXISTS");
+        return;
+    }
+    c->open = true;
+    c->write = true;
+    c->path = path;
+    setStatus(0, " OK");
+}
+
+void
+VirtualDrive::closeChannel(uint8_t nr)
+{
+    // Closing the command channel closes all other channels, too
+    if (nr == 15) {
+        for (uint8_t i = 0; i < 15; i++)
+            closeChannel(i);
+        return;
+    }
+
+    VirtualDriveChannel *c = &channel[nr];
+
+    if (c->open && c->write && c->path) {
+
+        FILE *file = fopen(c->path, "w");
+        if (!file || fwrite(c->buffer, 1, c->size, file) != c->size) {
+            warn("Cannot write %s\n", c->path);
+            setStatus(25, "WRITE ERROR");
+        }
+        if (file)
+            fclose(file);
+    }
+
+    free(c->buffer);
+    free(c->path);
+    memset(c, 0, sizeof(VirtualDriveChannel));
+}
+
+void
+VirtualDrive::executeCommand()
+{
+    uint8_t command[sizeof(input) + 1];
+    unsigned length = inputLength;
+
+    // Strip off the trailing carriage return
+    while (length && input[length - 1] == 0x0D)
+        length--;
+    memcpy(command, input, length);
+    command[length] = 0;
+    inputLength = 0;
+
+    debug(2, "Drive command '%s'\n", command);
+
+    switch (command[0]) {
+
+        case 0:
+            return;
+
+        case 'I': // INITIALIZE
+            setStatus(0, " OK");
+            return;
+
+        case 'U': // RESET
+            if (command[1] == 'I' || command[1] == 'J' || command[1] == ':') {
+                setStatus(73, "CBM DOS V2.6 1541");
+                return;
+            }
+            break;
+
+        case 'S': // SCRATCH
+        {
+            uint8_t *colon = (uint8_t *)strchr((char *)command, ':');
+            if (!colon) break;
+            if (disk) { setStatus(26, "WRITE PROTECT ON"); return; }
+            if (!directory) { setStatus(74, "DRIVE NOT READY"); return; }
+
+            VirtualDriveFile *files = new VirtualDriveFile[144];
+            unsigned count = scanFiles(NULL, directory, files, 144), scratched = 0;
+            for (unsigned i = 0; i < count; i++) {
+                if (matches(colon + 1, files[i].name) && unlink(files[i].path) == 0)
+                    scratched++;
+            }
+            freeFiles(files, count);
+            delete [] files;
+            setStatus(1, " FILES SCRATCHED", scratched);
+            return;
+        }
+    }
+
+    setStatus(31, "SYNTAX ERROR");
+}
+
+char *
+VirtualDrive::hostPath(const char *name, char type)
+{
+    assert(directory != NULL);
+
+    size_t length = strlen(directory) + strlen(name) + 6;
+    char *path = (char *)malloc(length);
+    char *p = path + snprintf(path, length, "%s/", directory);
+
+    for (; *name; name++)
+        *p++ = asciiFromPetscii((uint8_t)*name);
+    strcpy(p, type == 'S' ? ".seq" : type == 'U' ? ".usr" : ".prg");
+
+    return path;
+}
+
+void
+VirtualDrive::readDirectory(VirtualDriveChannel *c, const char *pattern)
+{
+    VirtualDriveFile *files = new VirtualDriveFile[144];
+    unsigned count = scanFiles(disk, directory, files, 144);
+    uint8_t header[32], diskName[16], id[5] = { '0', '0', ' ', '2', 'A' };
+    unsigned used = 0, freeBlocks = 0;
+
+    // Disk name and ID
+    memset(diskName, ' ', sizeof(diskName));
+    if (disk) {
+        uint8_t *bam = disk->findSector(18, 0);
+        for (unsigned i = 0; i < 16; i++)
+            diskName[i] = bam[0x90 + i] == 0xA0 ? ' ' : bam[0x90 + i];
+        for (unsigned i = 0; i < 5; i++)
+            id[i] = bam[0xA2 + i] == 0xA0 ? ' ' : bam[0xA2 + i];
+        for (unsigned t = 1; t <= 35; t++)
+            if (t != 18) freeBlocks += bam[4 * t];
+    } else {
+        const char *last = strrchr(directory, '/');
+        last = last ? last + 1 : directory;
+        for (unsigned i = 0; i < 16 && last[i]; i++)
+            diskName[i] = petsciiFromAscii(last[i]);
+    }
+
+    // Load address
+    appendToChannel(c, 0x01);
+    appendToChannel(c, 0x04);
+
+    // Header line (line number 0)
+    unsigned n = 0;
+    header[n++] = 0x12; // Reverse on
+    header[n++] = '"';
+    memcpy(header + n, diskName, 16); n += 16;
+    header[n++] = '"';
+    header[n++] = ' ';
+    memcpy(header + n, id, 5); n += 5;
+
+    uint8_t line[64];
+    for (unsigned l = 0; l <= count + 1; l++) {
+
+        unsigned nr = 0, length = 0;
+
+        if (l == 0) {
+
+            memcpy(line, header, n);
+            length = n;
+
+        } else if (l <= count) {
+
+            VirtualDriveFile *f = &files[l - 1];
+            used += f->blocks;
+            if (!matches((const uint8_t *)pattern, f->name))
+                continue;
+
+            // Align the file names independent of the block count
+            nr = f->blocks;
+            for (unsigned i = nr < 10 ? 3 : nr < 100 ? 2 : nr < 1000 ? 1 : 0; i; i--)
+                line[length++] = ' ';
+            line[length++] = '"';
+            unsigned nameLength = (unsigned)strlen((const char *)f->name);
+            memcpy(line + length, f->name, nameLength); length += nameLength;
+            line[length++] = '"';
+            for (unsigned i = nameLength; i < 16; i++)
+                line[length++] = ' ';
+            if (f->type[0] != '*')
+                line[length++] = ' ';
+            for (unsigned i = 0; f->type[i]; i++)
+                line[length++] = f->type[i];
+
+        } else {
+
+            nr = disk ? freeBlocks : (used < 664 ? 664 - used : 0);
+            memcpy(line, "BLOCKS FREE.", 12);
+            length = 12;
+        }
+
+        // Link pointer (fixed up by BASIC after loading), line number, text
+        appendToChannel(c, 0x01);
+        appendToChannel(c, 0x01);
+        appendToChannel(c, LO_BYTE(nr));
+        appendToChannel(c, HI_BYTE(nr));
+        for (unsigned i = 0; i < length; i++)
+            appendToChannel(c, line[i]);
+        appendToChannel(c, 0x00);
+    }
+
+    // End of program
+    appendToChannel(c, 0x00);
+    appendToChannel(c, 0x00);
+
+    freeFiles(files, count);
+    delete [] files;
+}
+
+bool
+VirtualDrive::readFile(VirtualDriveChannel *c, const char *pattern)
+{
+    VirtualDriveFile *files = new VirtualDriveFile[144];
+    unsigned count = scanFiles(disk, directory, files, 144);
+    bool found = false;
+
+    // An empty name matches the first file
+    if (*pattern == 0)
+        pattern = "*";
+
+    for (unsigned i = 0; i < count && !found; i++) {
+
+        VirtualDriveFile *f = &files[i];
+        if (!matches((const uint8_t *)pattern, f->name) || strstr(f->type, "DEL"))
+            continue;
+
+        found = true;
+
+        if (f->path) {
+
+            FILE *file = fopen(f->path, "r");
+            int value;
+            while (file && (value = fgetc(file)) != EOF)
+                appendToChannel(c, (uint8_t)value);
+            if (file)
+                fclose(file);
+
+        } else {
+
+            // Every file starts with the two bytes skipped by selectItem()
+            uint16_t addr = disk->getDestinationAddrOfItem(f->item);
+            int value;
+            appendToChannel(c, LO_BYTE(addr));
+            appendToChannel(c, HI_BYTE(addr));
+            disk->selectItem(f->item);
+            while ((value = disk->getByte()) >= 0)
+                appendToChannel(c, (uint8_t)value);
+        }
+    }
+
+    freeFiles(files, count);
+    delete [] files;
+    return found;
+}
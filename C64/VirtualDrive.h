@@ -0,0 +1,280 @@
+/*!
+ * @header      VirtualDrive.h
+ * @author      Dirk W. Hoffmann, www.dirkwhoffmann.de
+ * @copyright   2018 Dirk W. Hoffmann
+ */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _VIRTUALDRIVE_INC
+#define _VIRTUALDRIVE_INC
+
+#include "VirtualComponent.h"
+
+// Forward declarations
+class Archive;
+class D64Archive;
+
+//! @brief    States of the IEC protocol engine
+typedef enum {
+
+    VD_IDLE,                //! Not addressed
+
+    VD_RX_WAIT_CLK_LOW,     //! Listener: Waiting for the talker to hold the clock line
+    VD_RX_WAIT_READY,       //! Listener: Waiting for the talker to be ready to send
+    VD_RX_WAIT_START,       //! Listener: Ready for data
+    VD_RX_EOI_ACK,          //! Listener: Acknowledging an EOI
+    VD_RX_BITS,             //! Listener: Receiving bits
+
+    VD_TX_TURNAROUND,       //! Talker: Waiting for the listener to release the clock line
+    VD_TX_READY,            //! Talker: Preparing the next byte
+    VD_TX_WAIT_LISTENER,    //! Talker: Ready to send
+    VD_TX_EOI_WAIT_LOW,     //! Talker: Waiting for the EOI acknowledge
+    VD_TX_EOI_WAIT_HIGH,    //! Talker: Waiting for the end of the EOI acknowledge
+    VD_TX_START,            //! Talker: About to send the first bit
+    VD_TX_BIT_HIGH,         //! Talker: Data line is being set up
+    VD_TX_BIT_LOW,          //! Talker: Data line is valid
+    VD_TX_WAIT_ACK,         //! Talker: Waiting for the frame handshake
+    VD_TX_DEAD              //! Talker: Nothing to send
+
+} VirtualDriveState;
+
+//! @brief    A logical channel of the virtual drive
+typedef struct {
+
+    //! @brief    Indicates if the channel has been opened successfully
+    bool open;
+
+    //! @brief    Indicates if the channel has been opened for writing
+    bool write;
+
+    //! @brief    File contents
+    uint8_t *buffer;
+    size_t size;
+    size_t capacity;
+
+    //! @brief    Read position
+    size_t pos;
+
+    //! @brief    Host file the buffer is written to when the channel is closed
+    char *path;
+
+} VirtualDriveChannel;
+
+/*! @class    VirtualDrive
+ *  @brief    High-level emulation of an IEC device
+ *  @details  The virtual drive replaces the VC1541 on the IEC bus. Instead of emulating the drive
+ *            CPU, the VIAs, and the disk surface, it speaks the serial protocol at the byte level
+ *            directly on the ATN, CLOCK, and DATA lines. Because the protocol engine runs in
+ *            response to bus changes caused by the C64 and to a single timer, the Kernal's serial
+ *            routines work unmodified at a tiny fraction of the cost of true drive emulation.
+ *            Files are served from a D64 archive or from a directory of the host file system.
+ *            Custom fast loaders talking to the drive CPU directly are not supported.
+ *  @note     The state of the virtual drive is not part of snapshots. Restoring a snapshot
+ *            closes all channels.
+ */
+class VirtualDrive : public VirtualComponent {
+
+public:
+
+    /*! @brief    Cycle in which the protocol engine needs to be executed next
+     *  @details  Checked by the C64 in each cycle. UINT64_MAX if no timer is pending.
+     */
+    uint64_t wakeUpCycle;
+
+private:
+
+    //! @brief    Indicates if the virtual drive replaces the VC1541 on the IEC bus
+    bool active;
+
+    //! @brief    Device number
+    uint8_t deviceNr;
+
+    //! @brief    Disk the files are served from (owned by the virtual drive)
+    D64Archive *disk;
+
+    //! @brief    Host directory the files are served from
+    char *directory;
+
+    //! @brief    Indicates if the device pulls down the clock line
+    bool clockOut;
+
+    //! @brief    Indicates if the device pulls down the data line
+    bool dataOut;
+
+    //! @brief    Current state of the protocol engine
+    VirtualDriveState state;
+
+    //! @brief    Value of the clock line when the protocol engine looked last
+    bool lastClock;
+
+    //! @brief    Byte that is currently received or transmitted
+    uint8_t byte;
+
+    //! @brief    Number of processed bits of the current byte
+    unsigned bitCount;
+
+    //! @brief    Indicates if the current byte is the last one
+    bool eoi;
+
+    //! @brief    Indicates if the C64 holds the ATN line
+    bool atnMode;
+
+    //! @brief    Indicates if the device has been addressed as listener or talker
+    bool listening;
+    bool talking;
+
+    //! @brief    Current secondary address
+    uint8_t secondary;
+
+    //! @brief    Indicates if a file name is received (OPEN command)
+    bool opening;
+
+    //! @brief    Collected file name or drive command
+    uint8_t input[256];
+    unsigned inputLength;
+
+    //! @brief    Logical channels
+    VirtualDriveChannel channel[16];
+
+    //! @brief    Contents of the error channel
+    char status[64];
+
+    //! @brief    Read position in the error channel
+    unsigned statusPos;
+
+public:
+
+    //! @brief    Constructor
+    VirtualDrive();
+
+    //! @brief    Destructor
+    ~VirtualDrive();
+
+    //! @brief    Method from VirtualComponent
+    void reset();
+
+    //! @brief    Method from VirtualComponent
+    void loadFromBuffer(uint8_t **buffer);
+
+    //! @brief    Method from VirtualComponent
+    void dumpState();
+
+
+    //
+    //! @functiongroup Configuring the device
+    //
+
+    //! @brief    Returns true if the virtual drive replaces the VC1541 on the IEC bus
+    bool isActive() { return active; }
+
+    //! @brief    Puts the virtual drive on the IEC bus or removes it
+    void setActive(bool value);
+
+    /*! @brief    Serves the files of an archive
+     *  @details  The archive is copied and can be deleted by the caller.
+     */
+    bool mountArchive(Archive *archive);
+
+    //! @brief    Serves the files of a host directory
+    bool mountDirectory(const char *path);
+
+    //! @brief    Removes the disk or directory
+    void unmount();
+
+    //! @brief    Returns true if a disk or directory is mounted
+    bool hasMedium() { return disk != NULL || directory != NULL; }
+
+
+    //
+    //! @functiongroup Talking to the IEC bus
+    //
+
+    //! @brief    Returns true if the device pulls down the clock line
+    bool getClockOut() { return clockOut; }
+
+    //! @brief    Returns true if the device pulls down the data line
+    bool getDataOut() { return dataOut; }
+
+    //! @brief    Needs to be called whenever the C64 has changed the bus lines
+    void update() { while (step()); }
+
+    //! @brief    Is called by the C64 when wakeUpCycle has been reached
+    void execute();
+
+private:
+
+    //! @brief    Performs a single transition of the protocol engine
+    bool step();
+
+    //! @brief    Drives the clock and data line
+    void setLines(bool clock, bool data);
+
+    //! @brief    Schedules a wake up
+    void wakeUpIn(uint64_t cycles);
+
+    //! @brief    Processes a byte received under ATN
+    void processCommand(uint8_t command);
+
+    //! @brief    Processes a byte received as listener
+    void processData(uint8_t data);
+
+    //! @brief    Completes a listen sequence
+    void unlisten();
+
+    //! @brief    Switches to another state once ATN has been released
+    void releaseAtn();
+
+    /*! @brief    Provides the next byte to send
+     *  @return   false if the current channel has nothing to send
+     */
+    bool peekByte(uint8_t *value, bool *last);
+
+    //! @brief    Advances the read position of the current channel
+    void consumeByte();
+
+
+    //
+    //! @functiongroup Managing channels
+    //
+
+    //! @brief    Opens a channel (file name is in the input buffer)
+    void openChannel(uint8_t nr);
+
+    //! @brief    Closes a channel, writing back its contents if needed
+    void closeChannel(uint8_t nr);
+
+    //! @brief    Appends a byte to the buffer of a channel
+    bool appendToChannel(VirtualDriveChannel *c, uint8_t value);
+
+    //! @brief    Executes the drive command in the input buffer
+    void executeCommand();
+
+    //! @brief    Sets the contents of the error channel
+    void setStatus(unsigned code, const char *text, unsigned track = 0, unsigned sector = 0);
+
+    //! @brief    Creates a directory listing in BASIC program format
+    void readDirectory(VirtualDriveChannel *c, const char *pattern);
+
+    /*! @brief    Loads a file into a channel buffer
+     *  @return   false if no file matches
+     */
+    bool readFile(VirtualDriveChannel *c, const char *pattern);
+
+    //! @brief    Returns the host path of a file in the mounted directory
+    char *hostPath(const char *name, char type);
+};
+
+#endif
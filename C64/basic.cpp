@@ -17,6 +17,7 @@
  */
 
 #include "basic.h"
+#include "CompressedFile.h"
 
 struct timeval t;
 long tv_base = ((void)gettimeofday(&t,NULL), t.tv_sec);
@@ -180,6 +181,12 @@ checkFileSuffix(const char *filename, const char *suffix)
 	assert(filename != NULL);
 	assert(suffix != NULL);
 	
+    // Compressed files are checked by the name of the stored file
+    if (CompressedFile::isCompressedPath(filename)) {
+        CompressedFile file;
+        return file.open(filename) && checkFileSuffix(file.getName(), suffix);
+    }
+    
 	if (strlen(suffix) > strlen(filename))
 		return false;
 	
@@ -198,6 +205,12 @@ getSizeOfFile(const char *filename)
     if (filename == NULL)
         return -1;
     
+    // Compressed files report the size of the stored file
+    if (CompressedFile::isCompressedPath(filename)) {
+        CompressedFile file;
+        return file.open(filename) ? (long)file.getSize() : -1;
+    }
+    
     if (stat(filename, &fileProperties) != 0)
         return -1;
     
@@ -231,6 +244,16 @@ checkFileHeader(const char *filename, const uint8_t *header)
 	assert(filename != NULL);
 	assert(header != NULL);
 	
+    // Compressed files are only inflated as far as needed
+    if (CompressedFile::isCompressedPath(filename)) {
+        CompressedFile compressed;
+        uint8_t buffer[256];
+        size_t length = strlen((const char *)header);
+        assert(length <= sizeof(buffer));
+        return compressed.open(filename) &&
+        compressed.read(buffer, length) == length && memcmp(buffer, header, length) == 0;
+    }
+    
 	if ((file = fopen(filename, "r")) == NULL)
 		return false; 
 
@@ -29,6 +29,7 @@
 @class ArchiveProxy;
 @class TAPProxy;
 @class CRTProxy;
+@class RamSearchProxy;
 
 // Forward declarations of wrappers for C++ classes.
 // We wrap classes into normal C structs to avoid any reference to C++ here.
@@ -47,6 +48,7 @@ struct Via6522Wrapper;
 struct Disk525Wrapper;
 struct Vc1541Wrapper;
 struct DatasetteWrapper;
+struct RamSearchWrapper;
 struct ContainerWrapper;
 
 // --------------------------------------------------------------------------
@@ -120,6 +122,40 @@ struct ContainerWrapper;
 - (void) pokeTo:(uint16_t)addr value:(uint8_t)val memtype:(MemorySource)source;
 - (MemorySource) peekSource:(uint16_t)addr;
 
+- (RamSearchProxy *) makeRamSearch:(NSInteger)width;
+
+- (void) enableHeatmap:(uint16_t)banks;
+- (void) disableHeatmap;
+- (bool) heatmapEnabled;
+- (void) clearHeatmap;
+- (NSInteger) heatmapReads:(uint16_t)addr;
+- (NSInteger) heatmapWrites:(uint16_t)addr;
+- (NSInteger) heatmapExecutions:(uint16_t)addr;
+- (NSData *) heatmapData;
+- (void) heatmapImage:(uint32_t *)pixels;
+
+@end
+
+// --------------------------------------------------------------------------
+//                                RAM search
+// --------------------------------------------------------------------------
+
+@interface RamSearchProxy : NSObject {
+    
+    struct RamSearchWrapper *wrapper;
+}
+
+- (NSInteger) width;
+- (void) restart;
+- (BOOL) update;
+- (NSInteger) filter:(RamSearchCondition)condition value:(uint16_t)value;
+- (NSInteger) numCandidates;
+- (BOOL) isCandidate:(uint16_t)addr;
+- (NSInteger) candidates:(uint16_t *)buffer max:(NSInteger)max;
+- (uint16_t) value:(uint16_t)addr;
+- (uint16_t) previousValue:(uint16_t)addr;
+- (uint64_t) frame;
+
 @end
 
 // --------------------------------------------------------------------------
@@ -134,6 +170,8 @@ struct ContainerWrapper;
 - (void) dump;
 
 - (void *) screenBuffer;
+- (uint64_t *) screenBufferDirtyLines;
+- (uint64_t) screenBufferFrame;
 
 - (NSColor *) color:(NSInteger)nr;
 - (NSInteger) colorScheme;
@@ -402,6 +440,13 @@ struct ContainerWrapper;
 - (bool) exportToD64:(NSString *)path;
 - (void) playSound:(NSString *)name volume:(float)v;
 
+- (void) enableHeatmap:(uint16_t)banks;
+- (void) disableHeatmap;
+- (bool) heatmapEnabled;
+- (void) clearHeatmap;
+- (NSData *) heatmapData;
+- (void) heatmapImage:(uint32_t *)pixels;
+
 @end
 
 // --------------------------------------------------------------------------
@@ -429,6 +474,8 @@ struct ContainerWrapper;
 - (void) setHeadInCycles:(long)value;
 - (BOOL) motor;
 - (BOOL) playKey;
+- (BOOL) fastLoad;
+- (void) setFastLoad:(BOOL)value;
 
 @end
 
@@ -518,6 +565,8 @@ struct ContainerWrapper;
 - (void) ping;
 - (void) halt;
 - (void) step;
+- (bool) stepBack;
+- (bool) continueBack;
 - (bool) isRunnable;
 - (void) run;
 - (void) suspend;
@@ -546,6 +595,7 @@ struct ContainerWrapper;
 - (bool) loadRom:(NSURL *)url;
 
 - (bool) attachCartridgeAndReset:(CRTProxy *)c;
+- (bool) attachReu:(NSInteger)kb;
 - (void) detachCartridgeAndReset;
 - (bool) isCartridgeAttached;
 
@@ -554,6 +604,12 @@ struct ContainerWrapper;
 
 - (bool) insertTape:(TAPProxy *)a;
 
+// Virtual drive
+- (bool) virtualDrive;
+- (void) setVirtualDrive:(bool)b;
+- (bool) mountVirtualDisk:(ArchiveProxy *)a;
+- (bool) mountVirtualDirectory:(NSString *)path;
+
 - (NSInteger) mouseModel;
 - (void) setMouseModel:(NSInteger)model;
 - (void) connectMouse:(NSInteger)toPort;
@@ -568,9 +624,37 @@ struct ContainerWrapper;
 - (void) setAlwaysWarp:(bool)b;
 - (bool) warpLoad;
 - (void) setWarpLoad:(bool)b;
+- (bool) instantBoot;
+- (void) setInstantBoot:(bool)b;
 - (UInt64) cycles;
 - (UInt64) frames;
 
+// Reverse debugging
+- (bool) reverseDebugging;
+- (void) setReverseDebugging:(bool)b;
+- (NSInteger) reverseDebuggingOverhead;
+- (NSInteger) checkpointInterval;
+- (NSInteger) numCheckpoints;
+
+// Screen text
+- (NSString *) screenText;
+- (bool) screenContains:(NSString *)text;
+- (void) watchScreenFor:(NSString *)text;
+- (bool) watchedTextFound;
+- (bool) runUntilText:(NSString *)text frames:(NSInteger)frames;
+
+// Raster time accounting
+- (bool) rasterTiming;
+- (void) setRasterTiming:(bool)b;
+- (FrameTiming) frameTiming;
+- (NSInteger) cpuLoad;
+- (void) dumpFrameTiming;
+
+// Turbo mode
+- (NSInteger) turboMultiplier;
+- (void) setTurboMultiplier:(NSInteger)value;
+- (double) effectiveMHz;
+
 // Snapshot storage
 - (void) setAutoSaveSnapshots:(bool)b;
 
@@ -583,6 +667,12 @@ struct ContainerWrapper;
 - (bool) restoreAutoSnapshot:(NSInteger)nr;
 - (bool) restoreLatestAutoSnapshot;
 
+- (bool) openRewindHistory:(NSURL *)url;
+- (void) closeRewindHistory;
+- (NSInteger) numRewindHistorySnapshots;
+- (NSInteger) rewindHistoryPosition;
+- (bool) restoreFromRewindHistory:(NSInteger)position;
+
 - (NSInteger) numUserSnapshots;
 - (NSData *) userSnapshotData:(NSInteger)nr;
 - (unsigned char *) userSnapshotImageData:(NSInteger)nr;
@@ -18,6 +18,7 @@
 
 #import "C64GUI.h"
 #import "C64.h"
+#import "RamSearch.h"
 #import "VirtualC64-Swift.h"
 
 struct C64Wrapper { C64 *c64; };
@@ -34,6 +35,7 @@ struct Via6522Wrapper { VIA6522 *via; };
 struct Disk525Wrapper { Disk525 *disk; };
 struct Vc1541Wrapper { VC1541 *vc1541; };
 struct DatasetteWrapper { Datasette *datasette; };
+struct RamSearchWrapper { RamSearch *search; };
 struct ContainerWrapper { Container *container; };
 
 // DEPRECATED
@@ -89,7 +91,7 @@ struct CRTContainerWrapper { CRTContainer *crtcontainer; };
 - (void) setVflag:(bool)b { wrapper->cpu->setV(b); }
 
 - (uint16_t) readPC {
-    return wrapper->cpu->mem->spy(wrapper->cpu->getPC_at_cycle_0()); }
+    return wrapper->cpu->spy(wrapper->cpu->getPC_at_cycle_0()); }
 - (uint16_t) addressOfNextInstruction {
      return wrapper->cpu->getAddressOfNextInstruction(); }
 - (DisassembledInstruction) disassemble:(uint16_t)addr hex:(BOOL)h; {
@@ -108,6 +110,45 @@ struct CRTContainerWrapper { CRTContainer *crtcontainer; };
 @end
 
 
+// --------------------------------------------------------------------------
+//                                RAM search
+// --------------------------------------------------------------------------
+
+@implementation RamSearchProxy
+
+- (instancetype) initWithSearch:(RamSearch *)search
+{
+    if (self = [super init]) {
+        wrapper = new RamSearchWrapper();
+        wrapper->search = search;
+    }
+    return self;
+}
+
+- (void) dealloc
+{
+    if (wrapper) {
+        delete wrapper->search;
+        delete wrapper;
+    }
+}
+
+- (NSInteger) width { return wrapper->search->getWidth(); }
+- (void) restart { wrapper->search->restart(); }
+- (BOOL) update { return wrapper->search->update(); }
+- (NSInteger) filter:(RamSearchCondition)condition value:(uint16_t)value {
+    return wrapper->search->filter(condition, value); }
+- (NSInteger) numCandidates { return wrapper->search->numCandidates(); }
+- (BOOL) isCandidate:(uint16_t)addr { return wrapper->search->isCandidate(addr); }
+- (NSInteger) candidates:(uint16_t *)buffer max:(NSInteger)max {
+    return wrapper->search->getCandidates(buffer, (unsigned)max); }
+- (uint16_t) value:(uint16_t)addr { return wrapper->search->getValue(addr); }
+- (uint16_t) previousValue:(uint16_t)addr { return wrapper->search->getPreviousValue(addr); }
+- (uint64_t) frame { return wrapper->search->getFrame(); }
+
+@end
+
+
 // --------------------------------------------------------------------------
 //                                   Memory
 // --------------------------------------------------------------------------
@@ -136,6 +177,32 @@ struct CRTContainerWrapper { CRTContainer *crtcontainer; };
 - (MemorySource) peekSource:(uint16_t)addr {
     return wrapper->mem->peekSource(addr);
 }
+- (RamSearchProxy *) makeRamSearch:(NSInteger)width {
+    return [[RamSearchProxy alloc] initWithSearch:new RamSearch(wrapper->mem, (unsigned)width)];
+}
+- (void) enableHeatmap:(uint16_t)banks {
+    wrapper->mem->enableHeatmap(banks); }
+- (void) disableHeatmap {
+    wrapper->mem->disableHeatmap(); }
+- (bool) heatmapEnabled {
+    return wrapper->mem->heatmap.isEnabled(); }
+- (void) clearHeatmap {
+    wrapper->mem->heatmap.clear(); }
+- (NSInteger) heatmapReads:(uint16_t)addr {
+    return wrapper->mem->heatmap.getReads(addr); }
+- (NSInteger) heatmapWrites:(uint16_t)addr {
+    return wrapper->mem->heatmap.getWrites(addr); }
+- (NSInteger) heatmapExecutions:(uint16_t)addr {
+    return wrapper->mem->heatmap.getExecutions(addr); }
+- (NSData *) heatmapData {
+    Heatmap *heatmap = &wrapper->mem->heatmap;
+    size_t size = heatmap->exportMap(NULL);
+    uint8_t *buffer = (uint8_t *)malloc(size);
+    heatmap->exportMap(buffer);
+    return [NSData dataWithBytesNoCopy:buffer length:size freeWhenDone:YES];
+}
+- (void) heatmapImage:(uint32_t *)pixels {
+    wrapper->mem->heatmap.exportImage(pixels); }
 
 @end
 
@@ -158,6 +225,8 @@ struct CRTContainerWrapper { CRTContainer *crtcontainer; };
 - (void) dump { wrapper->vic->dumpState(); }
 
 - (void *) screenBuffer { return wrapper->vic->screenBuffer(); }
+- (uint64_t *) screenBufferDirtyLines { return wrapper->vic->screenBufferDirtyLines(); }
+- (uint64_t) screenBufferFrame { return wrapper->vic->screenBufferFrame(); }
 
 - (NSColor *) color:(NSInteger)nr
 {
@@ -503,8 +572,8 @@ struct CRTContainerWrapper { CRTContainer *crtcontainer; };
 
 - (void) moveHeadUp { wrapper->vc1541->moveHeadUp(); }
 - (void) moveHeadDown { wrapper->vc1541->moveHeadDown(); }
-- (void) rotateDisk { wrapper->vc1541->rotateDisk(); }
-- (void) rotateBack { wrapper->vc1541->rotateBack(); }
+- (void) rotateDisk { wrapper->vc1541->rescheduleHead(); wrapper->vc1541->rotateDisk(); }
+- (void) rotateBack { wrapper->vc1541->rescheduleHead(); wrapper->vc1541->rotateBack(); }
 
 - (const char *)dataAbs:(NSInteger)start {
     return wrapper->vc1541->dataAbs((int)start); }
@@ -522,6 +591,23 @@ struct CRTContainerWrapper { CRTContainer *crtcontainer; };
     [s setVolume:v];
     [s play];
 }
+- (void) enableHeatmap:(uint16_t)banks {
+    wrapper->vc1541->mem.enableHeatmap(banks); }
+- (void) disableHeatmap {
+    wrapper->vc1541->mem.disableHeatmap(); }
+- (bool) heatmapEnabled {
+    return wrapper->vc1541->mem.heatmap.isEnabled(); }
+- (void) clearHeatmap {
+    wrapper->vc1541->mem.heatmap.clear(); }
+- (NSData *) heatmapData {
+    Heatmap *heatmap = &wrapper->vc1541->mem.heatmap;
+    size_t size = heatmap->exportMap(NULL);
+    uint8_t *buffer = (uint8_t *)malloc(size);
+    heatmap->exportMap(buffer);
+    return [NSData dataWithBytesNoCopy:buffer length:size freeWhenDone:YES];
+}
+- (void) heatmapImage:(uint32_t *)pixels {
+    wrapper->vc1541->mem.heatmap.exportImage(pixels); }
 
 @end
 
@@ -555,6 +641,8 @@ struct CRTContainerWrapper { CRTContainer *crtcontainer; };
 - (void) setHeadInCycles:(long)value { wrapper->datasette->setHeadInCycles(value); }
 - (BOOL) motor { return wrapper->datasette->getMotor(); }
 - (BOOL) playKey { return wrapper->datasette->getPlayKey(); }
+- (BOOL) fastLoad { return wrapper->datasette->getFastLoad(); }
+- (void) setFastLoad:(BOOL)value { wrapper->datasette->setFastLoad(value); }
 @end
 
 // --------------------------------------------------------------------------
@@ -679,6 +767,8 @@ struct CRTContainerWrapper { CRTContainer *crtcontainer; };
 - (void) ping { wrapper->c64->ping(); }
 - (void) halt { wrapper->c64->halt(); }
 - (void) step { wrapper->c64->step(); }
+- (bool) stepBack { return wrapper->c64->stepBack(); }
+- (bool) continueBack { return wrapper->c64->continueBack(); }
 - (void) run { wrapper->c64->run(); }
 - (void) suspend { wrapper->c64->suspend(); }
 - (void) resume { wrapper->c64->resume(); }
@@ -736,6 +826,8 @@ struct CRTContainerWrapper { CRTContainer *crtcontainer; };
 
 - (bool) attachCartridgeAndReset:(CRTProxy *)c {
     return wrapper->c64->attachCartridgeAndReset((CRTContainer *)([c wrapper]->container)); }
+- (bool) attachReu:(NSInteger)kb {
+    return wrapper->c64->attachReu((unsigned)kb); }
 - (void) detachCartridgeAndReset { wrapper->c64->detachCartridgeAndReset(); }
 - (bool) isCartridgeAttached { return wrapper->c64->isCartridgeAttached(); }
 - (bool) insertDisk:(ArchiveProxy *)a {
@@ -751,6 +843,17 @@ struct CRTContainerWrapper { CRTContainer *crtcontainer; };
     return wrapper->c64->insertTape(container);
 }
 
+// Virtual drive
+- (bool) virtualDrive { return wrapper->c64->virtualDrive.isActive(); }
+- (void) setVirtualDrive:(bool)b { wrapper->c64->virtualDrive.setActive(b); }
+- (bool) mountVirtualDisk:(ArchiveProxy *)a {
+    Archive *archive = (Archive *)([a wrapper]->container);
+    return wrapper->c64->virtualDrive.mountArchive(archive);
+}
+- (bool) mountVirtualDirectory:(NSString *)path {
+    return wrapper->c64->virtualDrive.mountDirectory([path fileSystemRepresentation]);
+}
+
 - (NSInteger) mouseModel { return (NSInteger)wrapper->c64->getMouseModel(); }
 - (void) setMouseModel:(NSInteger)model { wrapper->c64->setMouseModel((MouseModel)model); }
 - (void) connectMouse:(NSInteger)toPort { wrapper->c64->connectMouse((unsigned)toPort); }
@@ -767,10 +870,50 @@ struct CRTContainerWrapper { CRTContainer *crtcontainer; };
 - (void) setAlwaysWarp:(bool)b { wrapper->c64->setAlwaysWarp(b); }
 - (bool) warpLoad { return wrapper->c64->getWarpLoad(); }
 - (void) setWarpLoad:(bool)b { wrapper->c64->setWarpLoad(b); }
+- (bool) instantBoot { return wrapper->c64->getInstantBoot(); }
+- (void) setInstantBoot:(bool)b { wrapper->c64->setInstantBoot(b); }
 
 - (UInt64) cycles { return wrapper->c64->getCycles(); }
 - (UInt64) frames { return wrapper->c64->getFrame(); }
 
+// Reverse debugging
+- (bool) reverseDebugging { return wrapper->c64->reverseDebugger.isEnabled(); }
+- (void) setReverseDebugging:(bool)b { wrapper->c64->reverseDebugger.setEnabled(b); }
+- (NSInteger) reverseDebuggingOverhead { return wrapper->c64->reverseDebugger.getOverhead(); }
+- (NSInteger) checkpointInterval { return wrapper->c64->reverseDebugger.getInterval(); }
+- (NSInteger) numCheckpoints { return wrapper->c64->reverseDebugger.numCheckpoints(); }
+
+// Screen text
+- (NSString *) screenText
+{
+    char buffer[ScreenText::ROWS * (4 * ScreenText::COLUMNS + 1) + 1];
+    wrapper->c64->screenText.update();
+    wrapper->c64->screenText.getText(buffer, sizeof(buffer));
+    return [NSString stringWithUTF8String:buffer];
+}
+- (bool) screenContains:(NSString *)text
+{
+    wrapper->c64->screenText.update();
+    return wrapper->c64->screenText.find([text UTF8String]);
+}
+- (void) watchScreenFor:(NSString *)text {
+    wrapper->c64->screenText.watch(text ? [text UTF8String] : NULL); }
+- (bool) watchedTextFound { return wrapper->c64->screenText.textFound(); }
+- (bool) runUntilText:(NSString *)text frames:(NSInteger)frames {
+    return wrapper->c64->runUntilText([text UTF8String], (unsigned)frames); }
+
+// Raster time accounting
+- (bool) rasterTiming { return wrapper->c64->getRasterTiming(); }
+- (void) setRasterTiming:(bool)b { wrapper->c64->setRasterTiming(b); }
+- (FrameTiming) frameTiming { return wrapper->c64->getFrameTiming(); }
+- (NSInteger) cpuLoad { return wrapper->c64->getCpuLoad(); }
+- (void) dumpFrameTiming { wrapper->c64->dumpFrameTiming(true); }
+
+// Turbo mode
+- (NSInteger) turboMultiplier { return wrapper->c64->getTurboMultiplier(); }
+- (void) setTurboMultiplier:(NSInteger)value { wrapper->c64->setTurboMultiplier((unsigned)value); }
+- (double) effectiveMHz { return wrapper->c64->getEffectiveMHz(); }
+
 // Snapshot storage
 - (void) setAutoSaveSnapshots:(bool)b { wrapper->c64->autoSaveSnapshots = b; }
 - (NSInteger) numAutoSnapshots { return wrapper->c64->numAutoSnapshots(); }
@@ -790,6 +933,14 @@ struct CRTContainerWrapper { CRTContainer *crtcontainer; };
 - (bool)restoreAutoSnapshot:(NSInteger)nr { return wrapper->c64->restoreAutoSnapshot((unsigned)nr); }
 - (bool)restoreLatestAutoSnapshot { return wrapper->c64->restoreLatestAutoSnapshot(); }
 
+- (bool) openRewindHistory:(NSURL *)url {
+    return wrapper->c64->openRewindHistory([[url path] UTF8String]); }
+- (void) closeRewindHistory { wrapper->c64->closeRewindHistory(); }
+- (NSInteger) numRewindHistorySnapshots { return wrapper->c64->rewindHistory.numEntries(); }
+- (NSInteger) rewindHistoryPosition { return (NSInteger)wrapper->c64->rewindHistory.getPosition(); }
+- (bool) restoreFromRewindHistory:(NSInteger)position {
+    return wrapper->c64->restoreFromRewindHistory((uint64_t)position); }
+
 - (NSInteger) numUserSnapshots { return wrapper->c64->numUserSnapshots(); }
 - (NSData *)userSnapshotData:(NSInteger)nr {
     Snapshot *snapshot = wrapper->c64->userSnapshot((unsigned)nr);
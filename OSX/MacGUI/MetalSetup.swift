@@ -84,6 +84,7 @@ public extension MetalView {
         descriptor.usage = MTLTextureUsage.shaderRead
         emulatorTexture = device?.makeTexture(descriptor: descriptor)
         precondition(emulatorTexture != nil, "Failed to create emulator texture")
+        textureFrame = 0
         
         // Upscaled C64 texture
         descriptor = MTLTextureDescriptor.texture2DDescriptor(
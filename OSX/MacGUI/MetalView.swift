@@ -77,6 +77,10 @@ public class MetalView: MTKView {
     /*! Texture is updated in updateTexture which is called periodically in drawRect */
     var emulatorTexture: MTLTexture! = nil
     
+    //! Frame stamp of the screen buffer that has been copied into emulatorTexture
+    /*! A value of 0 forces the next call to updateTexture to copy the whole buffer */
+    var textureFrame: UInt64 = 0
+    
     //! Upscaled emulator texture
     /*! In the first post-processing stage, the emulator texture is doubled in size.
      *  The user can choose between simply doubling pixels are applying a smoothing
@@ -238,7 +242,12 @@ public class MetalView: MTKView {
         }
         */
         
-        let buf = controller.c64.vic.screenBuffer()
+        // The emulator thread swaps the screen buffers without synchronisation. Read the frame
+        // stamp first and once more after copying. If the stamps differ, the buffer may have
+        // been swapped while we were copying it and the next call does a full upload.
+        let vic = controller.c64.vic!
+        let frame = vic.screenBufferFrame()
+        let buf = vic.screenBuffer()
         precondition(buf != nil)
         
         let pixelSize = 4
@@ -246,14 +255,50 @@ public class MetalView: MTKView {
         let height = Int(PAL_RASTERLINES)
         let rowBytes = width * pixelSize
         let imageBytes = rowBytes * height
-        let region = MTLRegionMake2D(0,0,width,height)
-            
-        emulatorTexture.replace(region: region,
-                                mipmapLevel: 0,
-                                slice: 0,
-                                withBytes: buf!,
-                                bytesPerRow: rowBytes,
-                                bytesPerImage: imageBytes)
+        
+        // Nothing to do if the texture already holds this frame
+        if frame != 0 && frame == textureFrame {
+            return
+        }
+        
+        // Copy the whole buffer if we've missed a frame
+        if frame == 0 || textureFrame == 0 || frame != textureFrame + 1 {
+            let region = MTLRegionMake2D(0,0,width,height)
+            emulatorTexture.replace(region: region,
+                                    mipmapLevel: 0,
+                                    slice: 0,
+                                    withBytes: buf!,
+                                    bytesPerRow: rowBytes,
+                                    bytesPerImage: imageBytes)
+            textureFrame = vic.screenBufferFrame() == frame ? frame : 0
+            return
+        }
+        
+        // Copy changed rasterlines only, coalescing adjacent lines into a single region
+        let dirty = vic.screenBufferDirtyLines()!
+        func isDirty(_ line: Int) -> Bool {
+            return (dirty[line / 64] >> UInt64(line % 64)) & 1 != 0
+        }
+        var line = 0
+        while line < height {
+            if !isDirty(line) {
+                line += 1
+                continue
+            }
+            var last = line + 1
+            while last < height && isDirty(last) {
+                last += 1
+            }
+            let region = MTLRegionMake2D(0,line,width,last - line)
+            emulatorTexture.replace(region: region,
+                                    mipmapLevel: 0,
+                                    slice: 0,
+                                    withBytes: buf! + line * rowBytes,
+                                    bytesPerRow: rowBytes,
+                                    bytesPerImage: rowBytes * (last - line))
+            line = last
+        }
+        textureFrame = vic.screenBufferFrame() == frame ? frame : 0
     }
     
     //! Returns the compute kernel of the currently selected upscaler